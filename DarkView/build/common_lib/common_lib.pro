@@ -32,15 +32,37 @@ win32:DEFINES += _CRT_SECURE_NO_WARNINGS
 
 INCLUDEPATH += ../../include
 
+# shards and column statistics are processed in parallel
+unix:!mac: QMAKE_CXXFLAGS += -fopenmp
+
 SOURCES += \ 
           ../../src/GL/oglCommon.cpp \ 
           ../../src/GL/oglFont.cpp \ 
+          ../../src/GL/oglPolylineBuffer.cpp \ 
           ../../src/QT/QExtendedMainWindow.cpp \ 
           ../../src/SCI/Mat4.cpp \ 
           ../../src/SCI/Graphics/RenderElements.cpp \ 
           ../../src/Data/PhysicsData.cpp \ 
           ../../src/Data/MultiDimensionalData.cpp \ 
           ../../src/Data/DenseMultiDimensionalData.cpp \ 
+          ../../src/Data/SharedMemory.cpp \ 
+          ../../src/Data/ColumnStatistics.cpp \ 
+          ../../src/Data/FederatedData.cpp \ 
+          ../../src/Data/ColumnHistogram.cpp \ 
+          ../../src/Data/BinnedColumns.cpp \ 
+          ../../src/Data/DependencyMatrix.cpp \ 
+          ../../src/Data/Scagnostics.cpp \ 
+          ../../src/Data/KNearest2D.cpp \ 
+          ../../src/Data/LocalPCA2D.cpp \ 
+          ../../src/Data/ContourMesh.cpp \ 
+          ../../src/Data/Cluster1D.cpp \ 
+          ../../src/Data/ArtifactGraph.cpp \ 
+          ../../src/Data/AxisOrdering.cpp \ 
+          ../../src/Data/DensityRaster.cpp \ 
+          ../../src/Data/PairHistograms.cpp \ 
+          ../../src/Data/ClusterTree.cpp \ 
+          ../../src/Data/EdgeBundling.cpp \ 
+          ../../src/Data/FrameArena.cpp \ 
           ../../src/GL/oglTexture2D.cpp \ 
           ../../src/GL/oglTexture.cpp
 
@@ -54,11 +76,30 @@ HEADERS += \
           ../../include/SCI/Graphics/RenderElements.h \ 
           ../../include/GL/oglCommon.h \ 
           ../../include/GL/oglFont.h \ 
+          ../../include/GL/oglPolylineBuffer.h \ 
           ../../include/QT/QExtendedMainWindow.h \ 
           ../../include/Data/PhysicsData.h \ 
           ../../include/SCI/VexN.h \ 
           ../../include/Data/MultiDimensionalData.h \ 
           ../../include/Data/DenseMultiDimensionalData.h \ 
+          ../../include/Data/SharedMemory.h \ 
+          ../../include/Data/ColumnStatistics.h \ 
+          ../../include/Data/FederatedData.h \ 
+          ../../include/Data/ColumnHistogram.h \ 
+          ../../include/Data/BinnedColumns.h \ 
+          ../../include/Data/DependencyMatrix.h \ 
+          ../../include/Data/Scagnostics.h \ 
+          ../../include/Data/KNearest2D.h \ 
+          ../../include/Data/LocalPCA2D.h \ 
+          ../../include/Data/ContourMesh.h \ 
+          ../../include/Data/Cluster1D.h \ 
+          ../../include/Data/ArtifactGraph.h \ 
+          ../../include/Data/AxisOrdering.h \ 
+          ../../include/Data/DensityRaster.h \ 
+          ../../include/Data/PairHistograms.h \ 
+          ../../include/Data/ClusterTree.h \ 
+          ../../include/Data/EdgeBundling.h \ 
+          ../../include/Data/FrameArena.h \ 
           ../../include/GL/oglTexture2D.h \ 
           ../../include/GL/oglTexture.h \ 
           ../../include/GL/glext.h \ 
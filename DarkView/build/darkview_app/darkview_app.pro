@@ -29,6 +29,13 @@ LIBS += -lshogun
 mac: LIBS += -framework GLUT
 else:unix|win32: LIBS += -lGLUT
 
+# OpenMP is used by the common library
+unix:!mac: QMAKE_CXXFLAGS += -fopenmp
+unix:!mac: LIBS += -fopenmp
+
+# shm_open for shared datasets
+unix:!mac: LIBS += -lrt
+
 # glew for windows
 win32:LIBS += -lglew32
 
@@ -51,6 +58,9 @@ SOURCES += \
           ../../src/DarkView/Main.cpp \ 
           ../../src/DarkView/MainWidget.cpp \ 
           ../../src/DarkView/ParallelCoordinates.cpp \ 
+          ../../src/DarkView/TrendModel.cpp \ 
+          ../../src/DarkView/AxisOrderingThread.cpp \ 
+          ../../src/DarkView/ProgressiveScheduler.cpp \ 
           ../../src/DarkView/ScatterPlot.cpp \ 
           ../../src/DarkView/SmallMultiples.cpp \ 
           ../../src/DarkView/DataIndirector.cpp \ 
@@ -66,6 +76,9 @@ HEADERS += \
           ../../include/DarkView/MainWindow.h \ 
           ../../include/DarkView/MainWidget.h \ 
           ../../include/DarkView/ParallelCoordinates.h \ 
+          ../../include/DarkView/TrendModel.h \ 
+          ../../include/DarkView/AxisOrderingThread.h \ 
+          ../../include/DarkView/ProgressiveScheduler.h \ 
           ../../include/DarkView/ScatterPlot.h \ 
           ../../include/DarkView/SmallMultiples.h \ 
           ../../include/DarkView/DataIndirector.h \ 
@@ -0,0 +1,68 @@
+/*
+**  Data Scalable Approach for Parallel Coordinates
+**  Copyright (C) 2016 - Hoa Nguyen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AXISORDERINGTHREAD_H
+#define AXISORDERINGTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <vector>
+
+#include <Data/PhysicsData.h>
+
+// Scores the axis pairs and optimizes the axis order off the user
+// interface thread. Every sweep that finds a better order signals
+// Improved; the receiver, in its own thread, picks the order up with
+// GetOrder. The data must not change until the search is stopped.
+class AxisOrderingThread : public QThread {
+
+    Q_OBJECT
+
+public:
+
+    AxisOrderingThread( QObject * parent = 0 );
+    ~AxisOrderingThread();
+
+    // Order the real dimensions dims of data for a pair score, see
+    // DataIndirector::OrderingMeasure. A search still running is stopped
+    // first.
+    void Order( Data::PhysicsData * data, const std::vector<int> & dims, int measure );
+    void Stop( );
+
+    // The best order so far as real dimensions, false when nothing newer
+    // was found since the last call
+    bool GetOrder( std::vector<int> & order );
+
+signals:
+    void Improved( );
+
+protected:
+
+    virtual void run( );
+    void Publish( const std::vector<int> & order );
+
+    QMutex mutex;
+    Data::PhysicsData * data;
+    std::vector<int>   dims;
+    int                measure;
+    std::vector<int>   best;
+    bool fresh;
+    volatile bool stopping;
+};
+
+#endif // AXISORDERINGTHREAD_H
@@ -24,6 +24,9 @@
 class DataIndirector
 {
 public:
+    // Measure used to order and color dimension pairs
+    enum DependencyMeasure { PEARSON, INFORMATION };
+
     DataIndirector( Data::PhysicsData * data );
 
     void IgnoreDimension( int dim );
@@ -39,13 +42,43 @@ public:
 
     void GetElement( int elem_id, float * space );
     float GetElement( int elem_id, int dim );
+    std::vector<float> ExtractDimension( int dim );
 
     float GetMinimumValue( int dim );
     float GetMaximumValue( int dim );
 
     float GetCorrelation( int dim_x, int dim_y );
+    float GetMutualInformation( int dim_x, int dim_y );
+    float GetInformationCoefficient( int dim_x, int dim_y );
+
+    // Pearson correlation in [-1,1], or the information coefficient in [0,1]
+    float GetDependency( int dim_x, int dim_y );
+    void SetDependencyMeasure( int measure );
+    int GetDependencyMeasure( );
+
+    // Scagnostic measure of a pair, see Data::Scagnostics::Measure
+    float GetScagnostic( int dim_x, int dim_y, int measure );
+    // The K pairs (i,j), j < i, scoring highest under measure, best first
+    void GetTopPairs( int measure, int K, std::vector< std::pair<int,int> > & pairs );
+
+    // Histograms are indexed by real dimension
+    const Data::ColumnHistogram & GetHistogram( );
+
+    // Pair scores an axis order can be optimized for
+    enum OrderingMeasure { ORDER_CORRELATION, ORDER_INFORMATION, ORDER_TREND };
+    // GetDim() by GetDim() scores of the visible dimensions, higher for
+    // dimensions that should be neighbours: |correlation|, the information
+    // coefficient or the monotonic scagnostic
+    void GetOrderingScores( int measure, std::vector<float> & score );
+    // The same for the real dimensions real of data, safe to call off the
+    // user interface thread
+    static void GetOrderingScores( Data::PhysicsData & data, const std::vector<int> & real, int measure, std::vector<float> & score );
+    // Show the same dimensions in a new order, given as real dimensions.
+    // False, leaving the order alone, if they are not the visible ones.
+    bool SetOrder( const std::vector<int> & real );
 
     void Recompute();
+    // Order the dimensions so neighbours depend on each other most
     void SortData();
     void SwapDims(int dim_x, int dim_y);
 
@@ -53,6 +86,7 @@ public:
 // protected:
     Data::PhysicsData * data;
     std::vector<int>  indr;
+    int measure;
 };
 
 #endif // DATAINDIRECTOR_H
@@ -21,10 +21,16 @@
 
 #include <QGLWidget>
 
+#include <deque>
+
 #include <Data/PhysicsData.h>
 #include <DarkView/DataIndirector.h>
 #include <DarkView/MainWidget.h>
 #include <GL/oglFont.h>
+#include <GL/oglPolylineBuffer.h>
+#include <GL/oglTexture2D.h>
+#include <Data/DensityRaster.h>
+#include <DarkView/ProgressiveScheduler.h>
 
 class Kmean : public QGLWidget {
     Q_OBJECT
@@ -33,6 +39,8 @@ public:
     Kmean(MainWidget * mw, oglWidgets::oglFont & font, QWidget *parent);
 
     void SetData( DataIndirector * _data );
+    // rows past the first sample are drawn in chunks sized by scheduler
+    void SetScheduler( ProgressiveScheduler * scheduler );
     virtual QSize minimumSizeHint() const { return QSize(  50,  50); }
     virtual QSize sizeHint()        const { return QSize(1280, 820); }
 
@@ -64,6 +72,23 @@ protected:
     float d_scale;
     oglWidgets::oglFont * font;
     void DrawElement( float * elem );
+    // element lines, one static buffer per chunk, kept while the layout holds
+    std::deque<oglWidgets::oglPolylineBuffer> elementChunks;
+    std::vector<int> elementEnd;
+    SCI::UINT64 elementKey;
+    unsigned int elementData;
+    SCI::UINT64 ElementKey() const;
+    void ElementSegments( float * elem, float * seg );
+
+    // past densityRows rows the lines overplot, and the gaps are drawn as
+    // density images rasterized on the CPU instead, lines then fill
+    void DrawDensity();
+    int densityRows;
+    Data::DensityRaster density[2];
+    oglWidgets::oglTexture2D densityTex[2];
+    SCI::UINT64 densityKey;
+    ProgressiveScheduler * scheduler;
+    int schedulerView;
     bool started;
     float rangeV;
     float CubicComp(float t, float p0,  float p1, float p2, float p3);
@@ -27,6 +27,7 @@
 
 #include <Data/PhysicsData.h>
 #include <DarkView/SmallMultiples.h>
+#include <DarkView/ProgressiveScheduler.h>
 
 #include <GL/oglFont.h>
 #include <GL/oglTexture2D.h>
@@ -66,14 +67,22 @@ protected:
 
     bool started;
 
+    ProgressiveScheduler * scheduler;
+    int scheduler_view;
+
 public:
     oglWidgets::oglFont        font;
 
 public:
 
     void SetData( DataIndirector * _output );
+    // the small multiples get a few rows a frame, as scheduler allows
+    void SetScheduler( ProgressiveScheduler * _scheduler );
     void ProgressiveReset();
 
+    // Scagnostic measure choosing the small multiples, -1 shows all pairs
+    void SetRanking( int measure );
+
 public:
     virtual void mouseDoubleClickEvent ( QMouseEvent * event );
     virtual void mouseMoveEvent ( QMouseEvent * event );
@@ -22,14 +22,19 @@
 #include <QMainWindow>
 #include <QApplication>
 #include <QSplitter>
+#include <QActionGroup>
 
 #include <QT/QExtendedMainWindow.h>
 
+#include <Data/FederatedData.h>
+
 #include <DarkView/MainWidget.h>
 #include <DarkView/ParallelCoordinates.h>
 #include <DarkView/QDimensionWidget.h>
 #include <DarkView/Kmean.h>
 #include <DarkView/Scatter.h>
+#include <DarkView/AxisOrderingThread.h>
+#include <DarkView/ProgressiveScheduler.h>
 
 class MainWindow : public QT::QExtendedMainWindow {
 
@@ -42,6 +47,10 @@ public:
 
 public slots:
     void openFile( );
+    void openDirectory( );
+    void refreshShards( );
+    void filterShards( );
+    void clearShardFilter( );
     void UpdateItem( int idx, QString str, bool checked );
     void copySettings( );
     void help();
@@ -49,6 +58,12 @@ public slots:
     void met1();
     void met2();
     void met3();
+    void colorByInformation( bool checked );
+    void lineMode( QAction * act );
+    void trendSample( QAction * act );
+    void rankPairs( QAction * act );
+    void orderAxes( QAction * act );
+    void axesOrdered( );
 
 protected:
     virtual void open_recent( QString fname );
@@ -59,7 +74,7 @@ public:
 
 protected:
 
-    Data::PhysicsData datafile;
+    Data::FederatedData datafile;
 
     DataIndirector indir_datafile;
 
@@ -74,6 +89,10 @@ protected:
 
     QMenu      * file_menu;
     QAction    * open;
+    QAction    * open_dir;
+    QAction    * refresh;
+    QAction    * filter_shards;
+    QAction    * clear_filter;
     QAction    * copy;
     QMenu      * recent_menu;
     QAction    * exit;
@@ -85,7 +104,30 @@ protected:
     QAction    * m1;
     QAction    * m2;
     QAction    * m3;
-
+    QAction    * mi_color;
+    QMenu      * gap_menu;
+    QActionGroup * gap_group;
+    QMenu      * sample_menu;
+    QActionGroup * sample_group;
+    QMenu      * rank_menu;
+    QActionGroup * rank_group;
+    QMenu      * order_menu;
+    QActionGroup * order_group;
+
+    // Frame time shared by the views drawing progressively
+    ProgressiveScheduler scheduler;
+
+    // Improves the axis order in the background, see orderAxes
+    AxisOrderingThread * ordering;
+
+    // Scagnostic measure picking the scatter plots shown, -1 for all pairs
+    int rank_measure;
+
+    // How the parallel coordinates draw their gaps, see lineMode
+    int line_mode;
+
+    // Rows sampled per axis pair for the trends, 0 for every row
+    int trend_sample;
 
     int meth;
     int dts;
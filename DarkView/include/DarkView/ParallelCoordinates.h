@@ -28,6 +28,15 @@
 #include <DarkView/MainWidget.h>
 #include <GL/oglFont.h>
 #include <DarkView/DimensionalityReduction.h>
+#include <DarkView/TrendModel.h>
+#include <Data/ContourMesh.h>
+#include <Data/ArtifactGraph.h>
+#include <Data/PairHistograms.h>
+#include <Data/ClusterTree.h>
+#include <Data/EdgeBundling.h>
+#include <QElapsedTimer>
+#include <map>
+#include <set>
 #include <math.h>
 
 class ParallelCoordinates : public QGLWidget {
@@ -38,6 +47,14 @@ public:
     ParallelCoordinates(MainWidget * mw, oglWidgets::oglFont & font, QWidget *parent);
 
     void SetData( DataIndirector * _data );
+
+    // how the gaps between axes are drawn: by the trends of their rows,
+    // from a 2D histogram of their axes, by a cut through a cluster tree,
+    // or as the lines of the histogram bundled by kernel density
+    enum LineMode { LINES_TRENDS, LINES_BINNED, LINES_CLUSTERS, LINES_BUNDLED };
+    void SetLineMode( int mode );
+    // rows sampled per axis pair to fit the trends, 0 for every row
+    void SetTrendSample( int rows );
     virtual QSize minimumSizeHint() const { return QSize(  50,  50); }
     virtual QSize sizeHint()        const { return QSize(1280, 820); }
 
@@ -58,6 +75,7 @@ protected:
     virtual void mousePressEvent ( QMouseEvent * event ) ;
     virtual void mouseReleaseEvent ( QMouseEvent * event );
     virtual void mouseMoveEvent ( QMouseEvent * event );
+    virtual void wheelEvent ( QWheelEvent * event );
 
 protected:
     DimensionalityReduction drPCA;
@@ -66,6 +84,18 @@ protected:
     MainWidget * mw;
     int curDraw;
     std::vector< std::pair<float,int> > dimLoc;
+
+    // With more than maxAxes dimensions the axes form a strip scrolled by
+    // the wheel, ctrl+wheel zooming. Axes out of view sit beyond [-1,1];
+    // only the gaps in view are computed and drawn, those near the view
+    // are prefetched on idle frames and those far from it dropped.
+    int maxAxes;
+    int axisFirst;
+    int axisSpan;
+    float AxisX(int i);
+    void ScrollAxes(int first, int span);
+    // gaps j, axes j and j+1, at least partly in view
+    void VisibleGaps(int & first, int & last);
     std::vector<float> dim_min;
     std::vector<float> dim_max;
     int dim;
@@ -79,12 +109,110 @@ protected:
     float xInts, yInts;
     bool intsComp(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
 
-    // for knnPCA function and draw_boundary function.
+    // for the trend models and draw_boundary function.
     int knum;
     int frame;
 
-    std::vector< std::pair<float,float> > disKnn;
-    std::vector< std::pair<float,float> > indKnn;
+    // rows sampled per axis pair for the trends, 0 uses every row
+    int trendSample;
+    // trends of axis pairs, kept until a column of the pair changes or a
+    // full redraw goes by without them
+    std::map< TrendModel::Key, TrendModel > trendModels;
+    std::set< TrendModel::Key > trendUsed;
+    const Data::ColumnHistogram * trendSource;
+    unsigned int trendVersion;
+    std::vector<unsigned int> trendColumns;
+    // the model of the axis pair being drawn
+    const TrendModel * trend;
+    TrendModel::Key TrendKey(int j, int k);
+    void TrendClusters(int j, int & negClusters, int & posClusters);
+    // compute the models the gaps first..last are missing for ks, one pair per thread
+    void UpdateTrends(const std::vector<int> & ks, int first, int last);
+    // compute the missing model of the gap nearest the view, if any,
+    // false once every gap near the view has its model
+    bool PrefetchTrends();
+
+    // what the cached results were derived from: "column/r" for real
+    // dimension r, touched when the data changes, "pair/r0/r1" for the
+    // trends of two real dimensions and "gap/j" for what is drawn between
+    // axes j and j+1. Swapping axes only makes the gaps next to them stale.
+    Data::ArtifactGraph artifacts;
+    std::vector<std::string> PairInputs(int d0, int d1);
+    // drop the models of pairs whose columns changed, and what was built from them
+    void InvalidateTrends();
+    // drop the models of pairs not adjacent in the gaps first..last
+    void DropTrends(int first, int last);
+    // drop the models not used since the last call, except those the
+    // prefetch keeps for the gaps next to the view
+    void SweepTrends();
+    void ForgetTrends(const std::set<const TrendModel*> & gone);
+    struct Gap
+    {
+        TrendModel::Key key;
+        const TrendModel * model;
+    };
+    std::vector<Gap> gaps;
+    // the model drawn in gap j, looked up again only when the gap is stale
+    const TrendModel * GapTrend(int j, int k);
+    // move axis a to b and b to a without setting up the data again
+    void SwapAxes(int a, int b);
+    // copy the group extents of trend for clusterPos1/2/3 and the group selection
+    void LoadTrend();
+
+    // Gap layers: a trend or binned gap is drawn once into a display list,
+    // with its axes at x = 0 and x = width, and placed by a translation
+    // after, so dragging or scrolling an axis only draws the gaps whose
+    // neighbours or widths changed. The trend drawing hands extents on from
+    // one gap to the next, so that state is part of the key and a layer
+    // puts back the state its gap left. Layers not used in a frame go.
+    struct LayerKey
+    {
+        int style;
+        int j;
+        int d0, d1;
+        float width;
+        const void * source;
+        unsigned int version;
+        unsigned int epoch;
+        std::vector<float> state;
+        bool operator<( const LayerKey & other ) const;
+    };
+    struct Layer
+    {
+        GLuint list;
+        std::vector<float> state;
+        unsigned int used;
+    };
+    std::map< LayerKey, Layer > layers;
+    std::vector<GLuint> layerTrash;
+    unsigned int layerFrame;
+    unsigned int layerEpoch;
+    std::vector<unsigned int> layerColumns;
+    LayerKey layerKey;
+    float layerX0, layerX1;
+    LayerKey GapLayerKey(int j, int style, const void * source, unsigned int version);
+    void TrendState(std::vector<float> & state);
+    void SetTrendState(const std::vector<float> & state);
+    // draws the layer of gap j and returns true, or starts recording it
+    // and returns false, to be closed by EndLayer once the gap is drawn
+    bool BeginLayer(int j, const LayerKey & key);
+    void EndLayer(int j);
+    // delete the lists of the layers not used since the last call
+    void SweepLayers();
+
+    // upper and lower boundary of a trend band at the nseg+1 columns of an
+    // axis gap, kept per model and band until the models are rebuilt
+    struct BoundaryKey
+    {
+        const TrendModel * model;
+        float box[4];
+        int segments;
+        bool operator<( const BoundaryKey & other ) const;
+    };
+    typedef std::pair< std::vector<float>, std::vector<float> > BoundaryStrip;
+    std::map< BoundaryKey, BoundaryStrip > boundaries;
+    const BoundaryStrip & Boundary(float startx, float engrx, float starty, float engry);
+
     std::vector< float > meanPCAx;
     std::vector< float > meanPCAy;
     std::vector< float > primPCAx;
@@ -93,23 +221,8 @@ protected:
     int steV;
     std::vector< std::pair<float,float> > intsPoints;
     std::vector< std::pair<float,float> > elemPoints;    
-    std::vector< std::pair<float, float> > posPoints;
-    std::vector< std::pair<float, float> > negPoints;
-
-    // positive intersection points
-    std::vector< std::pair<float,float> > posints;
-    std::vector< std::pair<float,float> > posints1;
-    std::vector< std::pair<float,float> > posints2;
-
-    // negative intersection points
-    std::vector< std::pair<float,float> > negints;
-    std::vector< std::pair<float,float> > negints1;
-    std::vector< std::pair<float,float> > negints2;
-    std::vector< std::pair<float,float> > negints3;
-    void knnPCA(int jd, int md);
     void DrawBoundary(int d0, int d1, float x0, float x1, float startx, float engrx, float starty, float engry, int numgr, float colgr);
     void DrawPosBoundary(int d0, int d1, float x0, float x1, float maxX, float minX, float maxY, float minY, float colgr, int grnum);
-    float AngleCompute(float xs, float ys);
 
     // draw contours for different k values
     // void Kcontour(int kn, int kcolor);
@@ -122,7 +235,36 @@ protected:
     // threshold for marching algorithm
     float thresholdTri;
     bool point_in_tri(float sx, float sy, float ax, float ay, float bx, float by, float cx, float cy);
-    void marchingTriangles(float ax, float ay, float avalue, float bx, float by, float bvalue, float cx, float cy, float cvalue, float colgr, int posneg);
+
+    // contour meshes of the trend bands, per model, band and group, with
+    // the part above each threshold extracted the first time it is drawn.
+    // Like the layers, meshes and levels not used in a frame go.
+    struct ContourKey
+    {
+        BoundaryKey band;
+        int group;
+        float width;
+        int rows;
+        bool operator<( const ContourKey & other ) const;
+    };
+    struct ContourLevel
+    {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        unsigned int used;
+    };
+    struct Contour
+    {
+        Data::ContourMesh mesh;
+        std::vector<unsigned int> cells;
+        std::map< float, ContourLevel > levels;
+        unsigned int used;
+    };
+    std::map< ContourKey, Contour > contours;
+    Contour & GetContour(const TrendModel::Group & group, int groupId, const float box[4], const std::vector<float> & top, const std::vector<float> & bottom, float width);
+    void SweepContours();
+    void DrawContour(Contour & contour, float x0, float colgr, int posneg);
+    void ContourColor(float colgr, int posneg);
 
     // for testing
     float th1, th2, th3, th4;
@@ -222,14 +364,6 @@ protected:
     std::vector< float > pcorx;
     std::vector< float > pcory;
 
-    std::vector<float> eigenNeg;
-    std::vector<float> eigenNeg1;
-    std::vector<float> eigenNeg2;
-    std::vector<float> eigenNeg3;
-    std::vector<float> eigenPos;
-    std::vector<float> eigenPos1;
-    std::vector<float> eigenPos2;
-
     // texture rendering
     int xSize , ySize; //size of texture
     //our OpenGL texture handle
@@ -247,14 +381,54 @@ protected:
 
     // histogram curve for lines density
     void histCurve();
+    void UpdateDensityCurves( const Data::ColumnHistogram & hist );
+    void DrawDensityCurve( int d, float x0, float x1, bool right );
     int numbin;
     float binrange;
-    int bin0[100];
-    int bin1[100];
-    float bin0x[100];
-    float bin0y[100];
-    float bin1x[100];
-    float bin1y[100];
+    // kernel density of each real dimension at numbin points over [densityLo,densityHi],
+    // scaled to [0,1], and the column version it was estimated from
+    std::vector< std::vector<float> > densityCurve;
+    std::vector<float> densityLo;
+    std::vector<float> densityHi;
+    std::vector<unsigned int> densityColumns;
+    const Data::ColumnHistogram * densitySource;
+    unsigned int densityVersion;
+
+    // binned mode: a gap is pairBins x pairBins bands, one per non-empty
+    // cell of the histogram of its two axes, shaded by the rows in it
+    int lineMode;
+    int pairBins;
+    Data::PairHistograms pairHists;
+    // histograms of the gaps first..last, computing the missing ones
+    void UpdatePairHistograms(int first, int last);
+    void DrawBinnedGap(int j);
+
+    // bundled mode: a gap is one line per non-empty cell of its pair
+    // histogram, bundled by kernel density, kept per pair of real
+    // dimensions until rows are added or the pair leaves the view
+    struct Bundle
+    {
+        int rows;
+        Data::EdgeBundling edges;
+    };
+    std::map< std::pair<int,int>, Bundle > bundles;
+    const Bundle * GapBundle(int j);
+    void DrawBundledGap(int j, const Bundle & bundle);
+
+    // cluster mode: the gaps show the nodes of one cut through a cluster
+    // tree of the rows, each a band over its extent on both axes and a line
+    // through its centroid. The cut holds clusterBudget nodes, fitted to the
+    // time the last frame took, more of them when zoomed in on fewer axes,
+    // and the nodes under the pointer are split first
+    Data::ClusterTree clusterTree;
+    SCI::UINT64 clusterStamp;
+    int clusterBudget;
+    bool clusterRefine;
+    float hoverX, hoverY;
+    // builds the tree, or loads it from next to the data file
+    void UpdateClusterTree();
+    void ClusterBoost(std::vector<float> & boost);
+    void DrawClusterGaps(int first, int last);
 };
 
 #endif // PARALLELCOORDINATES_H
@@ -0,0 +1,78 @@
+/*
+**  Data Scalable Approach for Parallel Coordinates
+**  Copyright (C) 2016 - Hoa Nguyen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROGRESSIVESCHEDULER_H
+#define PROGRESSIVESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <vector>
+
+// Shares a frame time among the views that draw progressively. Each view
+// gets an equal part of the frame budget. A view starts its frame with
+// BeginFrame, and before each piece of work asks Grant how many units of
+// it fit in what is left. Done then reports the units actually drawn, and
+// the measured cost per unit of that task is updated. Work is only ever
+// granted in chunks the view can finish on time, so a frame rate is kept
+// at the price of more frames to finish. At least one unit is granted per
+// frame, so every view keeps making progress.
+class ProgressiveScheduler
+{
+public:
+
+    ProgressiveScheduler( float frame_ms = 16.0f );
+
+    // A new view, given its share of the frame
+    int  AddView( );
+    void SetFrameBudget( float ms );
+
+    void BeginFrame( int view );
+
+    // Units of task that fit in the rest of the frame of view, at most
+    // remaining
+    int  Grant( int view, int task, int remaining );
+    void Done( int view, int task, int units );
+
+    // ms left of the frame of view
+    float Remaining( int view ) const ;
+
+    // Drop what was learned about the costs of view, as after a resize
+    void Cancel( int view );
+
+protected:
+
+    struct Task
+    {
+        float ms_per_unit;  // < 0 until measured
+        int   granted;
+    };
+    struct View
+    {
+        QElapsedTimer frame;
+        QElapsedTimer grant;
+        bool progressed;
+        std::vector<Task> tasks;
+    };
+
+    float frame_ms;
+    std::vector<View> views;
+
+    float Budget( ) const ;
+    Task & GetTask( int view, int task );
+};
+
+#endif // PROGRESSIVESCHEDULER_H
@@ -21,10 +21,16 @@
 
 #include <QGLWidget>
 
+#include <deque>
+
 #include <Data/PhysicsData.h>
 #include <DarkView/DataIndirector.h>
 #include <DarkView/MainWidget.h>
 #include <GL/oglFont.h>
+#include <GL/oglPolylineBuffer.h>
+#include <GL/oglTexture2D.h>
+#include <Data/DensityRaster.h>
+#include <DarkView/ProgressiveScheduler.h>
 #include <DarkView/DimensionalityReduction.h>
 
 class Scatter : public QGLWidget {
@@ -35,6 +41,8 @@ public:
     Scatter(MainWidget * mw, oglWidgets::oglFont & font, QWidget *parent);
 
     void SetData( DataIndirector * _data );
+    // rows past the first sample are drawn in chunks sized by scheduler
+    void SetScheduler( ProgressiveScheduler * scheduler );
     virtual QSize minimumSizeHint() const { return QSize(  50,  50); }
     virtual QSize sizeHint()        const { return QSize(1280, 820); }
 
@@ -68,6 +76,23 @@ protected:
     float d_scale;
     oglWidgets::oglFont * font;
     void DrawElement( float * elem );
+    // element lines, one static buffer per chunk, kept while the layout holds
+    std::deque<oglWidgets::oglPolylineBuffer> elementChunks;
+    std::vector<int> elementEnd;
+    SCI::UINT64 elementKey;
+    unsigned int elementData;
+    SCI::UINT64 ElementKey() const;
+    int ElementPoints( float * elem, float * x, float * y );
+
+    // past densityRows rows the points overplot, and the cells are drawn
+    // as a density image rasterized on the CPU instead
+    void DrawDensity();
+    int densityRows;
+    Data::DensityRaster density;
+    oglWidgets::oglTexture2D densityTex;
+    SCI::UINT64 densityKey;
+    ProgressiveScheduler * scheduler;
+    int schedulerView;
     bool started;
     float rangeV;
     float eleRange;
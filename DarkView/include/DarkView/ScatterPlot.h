@@ -20,6 +20,9 @@
 #define SCATTERPLOT_H
 
 #include <GL/oglFont.h>
+#include <GL/oglPolylineBuffer.h>
+#include <GL/oglTexture2D.h>
+#include <Data/DensityRaster.h>
 #include <Data/PhysicsData.h>
 #include <DarkView/DataIndirector.h>
 #include <SCI/Graphics/RenderElements.h>
@@ -37,7 +40,10 @@ public:
     void SetBorderWidth( float w );
     void SetBorderColor( float r, float g, float b, float a = 1.0f );
 
-    bool ProgressiveDraw();
+    // draws up to rows more rows over the ones drawn before, and returns
+    // how many; a pair drawn as a density image goes at once
+    int  ProgressiveDraw( int rows );
+    int  GetRemaining( ) const ;
     void ProgressiveReset( );
     void ProgressiveBorder( );
 
@@ -48,7 +54,26 @@ protected:
 
 
     void UpdateLayout( );
-    void DrawPoints( SCI::Vex4 col, int start, int stop, int step );
+    SCI::Vex4 DependencyColor( );
+    void DrawPoints( SCI::Vex4 col, int start, int stop );
+
+    // every point of the current pair, uploaded once and rebuilt when
+    // points_version moves on. The rows are laid out every points_step-th
+    // first, so any prefix is an even sample of the pair.
+    void UpdatePoints( );
+    oglWidgets::oglPolylineBuffer points;
+    unsigned int points_version;
+    int points_step;
+
+    // past density_rows rows the points overplot, and the pair is drawn
+    // as a density image rasterized on the CPU instead
+    void DrawDensity( SCI::Vex4 col );
+    void DrawSamples( SCI::Vex4 col, int step );
+
+    int density_rows;
+    Data::DensityRaster density;
+    oglWidgets::oglTexture2D density_tex;
+    unsigned int density_version;
 
     oglWidgets::oglFont * font;
 
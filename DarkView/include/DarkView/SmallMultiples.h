@@ -22,6 +22,7 @@
 #include <Data/PhysicsData.h>
 #include <DarkView/ScatterPlot.h>
 #include <DarkView/DataIndirector.h>
+#include <DarkView/ProgressiveScheduler.h>
 #include <GL/oglFont.h>
 
 class SmallMultiples
@@ -35,6 +36,15 @@ protected:
     float mouse_x, mouse_y;
     int selX, selY;
     int mouse_selX, mouse_selY;
+    int mouse_plot;
+
+    // Scagnostic measure used to pick the plots, -1 shows every pair
+    int rank_measure;
+    int rank_count;
+    std::vector< std::pair<int,int> > ranked;
+
+    // Positions the plots for the current mode and returns how many there are
+    int  Layout( DataIndirector & data, float sel_width );
 
 
 public:
@@ -45,8 +55,14 @@ public:
     void Select( );
     void SetMouse( float mx, float my );
 
+    // Show only the K pairs scoring highest under a Data::Scagnostics measure
+    void SetRanking( int measure, int K = 16 );
+    int  GetRankingMeasure( );
+
     void ProgressiveReset( );
-    bool ProgressiveDraw( DataIndirector & data );
+    // the plot under the mouse first, then the others, for as many rows
+    // as scheduler fits in the frame of view, or every row without one
+    bool ProgressiveDraw( DataIndirector & data, ProgressiveScheduler * scheduler, int view );
     void ProgressiveBorder(DataIndirector & data );
     void ProgressiveLabels(float aspect, DataIndirector & data );
     //void Draw( float aspect, DataIndirector & data );
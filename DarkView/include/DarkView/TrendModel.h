@@ -0,0 +1,96 @@
+/*
+**  Data Scalable Approach for Parallel Coordinates
+**  Copyright (C) 2016 - Hoa Nguyen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRENDMODEL_H
+#define TRENDMODEL_H
+
+#include <vector>
+#include <Data/LocalPCA2D.h>
+
+// Positive and negative trends of one pair of adjacent axes. A model is
+// computed once, off the drawing code, and only read afterwards.
+//
+// Points are the sampled rows in the scatter plot of the pair: x on the
+// right axis and y on the left one, both in [-range,range]. Intersections
+// keep y in the same units but store x as the fraction of the way from the
+// left axis to the right one, so moving or resizing the axes does not
+// change the model.
+class TrendModel
+{
+public:
+    // What a model depends on, besides the data itself
+    struct Key
+    {
+        int d0, d1;         // real dimensions of the left and right axis
+        int k;              // neighbourhood size, the point itself included
+        int negClusters;
+        int posClusters;
+        int sample;         // rows sampled per pair, 0 for all
+
+        bool operator<( const Key & other ) const;
+    };
+
+    // Intersections of one cluster and the extent of its points
+    struct Group
+    {
+        std::vector< std::pair<float,float> > ints;
+        std::vector<float> radius;
+        float minX, maxX;
+        float minY, maxY;
+    };
+
+    TrendModel();
+
+    // Trends of the points (x[i], y[i]). Point i's neighbourhood is itself
+    // and the first groupSize entries of row i of neighbors, rows being
+    // stride long, and pca holds the components of those neighbourhoods.
+    void Compute( const std::vector<float> & x, const std::vector<float> & y, const std::vector<int> & neighbors, int stride, int groupSize,
+                  const Data::LocalPCA2D & pca, float cor, int negClusters, int posClusters, float range );
+
+    // Upper and lower envelope of the lines from y[i] on the left axis to
+    // x[i] on the right one, for the points with minX <= x <= maxX and
+    // minY <= y <= maxY, at the fractions i/segments of the way across,
+    // i = 0..segments. Columns without any line are -1 upper and 1 lower.
+    void Envelope( float minX, float maxX, float maxY, float minY, int segments, std::vector<float> & upper, std::vector<float> & lower ) const;
+
+    float range;
+    float correlation;
+
+    // sampled points and their neighbours, groupSize per point
+    std::vector<float> x, y;
+    std::vector<int>   neighbors;
+    int                groupSize;
+
+    // local PCA of every neighbourhood
+    std::vector<float> meanX, meanY;
+    std::vector<float> majorX, majorY;
+
+    // +1 for points on a positive trend, -1 on a negative one
+    std::vector<int>   trend;
+
+    // 0 without a negative trend, otherwise the number of negative clusters
+    int   hasNeg;
+    int   hasPos;
+
+    // neg[0..2] are the negative clusters
+    Group neg[3];
+    // pos[0] holds every positive intersection, pos[1..2] the clusters
+    Group pos[3];
+};
+
+#endif // TRENDMODEL_H
@@ -0,0 +1,67 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_ARTIFACTGRAPH_H
+#define DATA_ARTIFACTGRAPH_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Data {
+
+    // Versions of derived results and of what they were derived from. A
+    // node is named by a key and records the keys and versions of its
+    // inputs when it is built; it is stale once it has never been built,
+    // is asked for with other inputs, or one of its inputs has a newer
+    // version or is stale itself. The graph holds no results, only tells
+    // the caches that do which of their entries to rebuild.
+    class ArtifactGraph {
+    public:
+        ArtifactGraph( );
+
+        void Clear( );
+
+        // A source changed, everything built from it is stale
+        void Touch( const std::string & key );
+
+        // key was rebuilt from inputs at their current versions
+        void Built( const std::string & key, const std::vector<std::string> & inputs );
+
+        bool IsStale( const std::string & key, const std::vector<std::string> & inputs ) const ;
+        bool IsStale( const std::string & key ) const ;
+
+        // 0 for a key never touched or built
+        unsigned int GetVersion( const std::string & key ) const ;
+
+        // key made of a name and up to two numbers, as "pair/3/7"
+        static std::string Key( const char * name, int a = -1, int b = -1 );
+
+    protected:
+        struct Node {
+            unsigned int version;
+            std::vector< std::pair<std::string,unsigned int> > inputs;
+        };
+
+        std::map<std::string,Node> nodes;
+        unsigned int               clock;
+    };
+
+}
+
+#endif // DATA_ARTIFACTGRAPH_H
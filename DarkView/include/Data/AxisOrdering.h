@@ -0,0 +1,62 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_AXISORDERING_H
+#define DATA_AXISORDERING_H
+
+#include <vector>
+
+namespace Data {
+
+    // Order of n axes maximizing the summed score of neighbouring axes, a
+    // maximum Hamiltonian path over the score matrix. Start builds a path
+    // by nearest neighbour from both ends of the best pair; every Improve
+    // is then one sweep of 2-opt (reversing a run of axes) and one of
+    // Or-opt (moving a run of up to three axes elsewhere), so the order
+    // only gets better and can be shown between sweeps. Each sweep is
+    // O(n^2), which keeps thousands of axes practical.
+    class AxisOrdering {
+    public:
+        AxisOrdering( );
+
+        // score is n by n and symmetric, higher for axes that belong together
+        void Start( const std::vector<float> & score, int n );
+        void Clear( );
+
+        // false once neither move finds anything better
+        bool Improve( );
+
+        // axis at each position
+        const std::vector<int> & GetOrder( ) const ;
+        double GetScore( ) const ;
+
+    protected:
+        int                n;
+        std::vector<float> score;
+        std::vector<int>   order;
+        double             total;
+
+        float  Score( int a, int b ) const ;
+        bool   TwoOpt( );
+        bool   OrOpt( );
+        void   Total( );
+    };
+
+}
+
+#endif // DATA_AXISORDERING_H
@@ -0,0 +1,78 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_BINNEDCOLUMNS_H
+#define DATA_BINNEDCOLUMNS_H
+
+#include <vector>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    class PhysicsData;
+
+    // Every value of every column replaced by a one byte bin code, so
+    // that 2D histograms of any pair of columns are a single pass over
+    // two byte arrays.
+    class BinnedColumns {
+    public:
+        enum Binning {
+            UNIFORM,     // equal width bins over the range of the column
+            QUANTILE     // bins holding roughly equal numbers of rows
+        };
+
+        BinnedColumns( );
+
+        // The bin edges come from the column histograms, so no sorting is needed
+        void Build( PhysicsData & data, int bins = 32, Binning binning = QUANTILE );
+        void Clear( );
+
+        // Code one more row, with the bin edges the columns were built with.
+        // Values outside the range fall in the end bins.
+        void Append( const float * elem );
+
+        int GetBins( ) const ;
+        int GetDimension( ) const ;
+        int GetElementCount( ) const ;
+
+        // Range the bins of dim were laid over
+        float GetMinimumValue( int dim ) const ;
+        float GetMaximumValue( int dim ) const ;
+
+        const SCI::UINT8 * GetCodes( int dim ) const ;
+
+        // bins x bins counts of a pair of columns, indexed [code_x*bins + code_y]
+        void GetJoint( int dim_x, int dim_y, std::vector<SCI::UINT32> & counts ) const ;
+
+    protected:
+        int                                     bins;
+        int                                     dimN;
+        int                                     elemN;
+        int                                     baseN;
+        std::vector<float>                      lo;
+        std::vector<float>                      hi;
+        std::vector< std::vector<SCI::UINT8> >  tables;
+        std::vector< std::vector<SCI::UINT8> >  codes;
+
+        int BaseBin( int dim, float val ) const ;
+    };
+
+}
+
+#endif // DATA_BINNEDCOLUMNS_H
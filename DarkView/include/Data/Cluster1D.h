@@ -0,0 +1,66 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_CLUSTER1D_H
+#define DATA_CLUSTER1D_H
+
+#include <vector>
+
+namespace Data {
+
+    // k-means of scalar values, solved exactly. In 1D every optimal cluster
+    // is a run of the sorted values, so after one sort a dynamic program
+    // over prefix sums finds the split with the smallest within-cluster sum
+    // of squares (as Ckmeans.1d.dp does), in O(k n log n) with the optimal
+    // split points found by divide and conquer. There is no random start
+    // and no iteration, so the same values always give the same clusters.
+    class Cluster1D {
+    public:
+        Cluster1D( );
+
+        // Cluster values into at most k clusters, fewer when there are fewer
+        // distinct values. With bins > 0 and more distinct values than that,
+        // values are first merged into bins equal width bins and the
+        // program runs on the bins, which is approximate but O(n + k b log b).
+        void Compute( const std::vector<float> & values, int k, int bins = 0 );
+        void Clear( );
+
+        int GetClusterCount( ) const ;
+
+        // Cluster of every value, in the order they were given. Clusters
+        // are numbered by increasing value.
+        const std::vector<int> & GetLabels( ) const ;
+
+        float  GetCenter( int cluster ) const ;
+        float  GetMin( int cluster ) const ;
+        float  GetMax( int cluster ) const ;
+        int    GetSize( int cluster ) const ;
+
+        // Sum over all values of the squared distance to their center
+        double GetWithinSS( ) const ;
+
+    protected:
+        std::vector<int>   labels;
+        std::vector<float> center, minV, maxV;
+        std::vector<int>   size;
+        double             withinss;
+    };
+
+}
+
+#endif // DATA_CLUSTER1D_H
@@ -0,0 +1,88 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_CLUSTERTREE_H
+#define DATA_CLUSTERTREE_H
+
+#include <vector>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    class PhysicsData;
+
+    // Hierarchy of clusters of the rows, a k-means tree: the root holds
+    // every row and each node is split by k-means into up to branch
+    // children, level after level. Every node keeps the number of rows
+    // in it, their centroid and their extent in each column, so a cut
+    // through the tree summarizes any number of rows in as many bands as
+    // it has nodes. Rows are clustered on one byte per value, so centroids
+    // and extents are accurate to a 256th of the column range.
+    class ClusterTree {
+    public:
+        ClusterTree( );
+
+        // All nodes of a level are split at once in parallel, or the rows
+        // of a node in parallel while a level has few nodes
+        void Build( PhysicsData & data, int branch = 4, int levels = 6, int leaf = 64 );
+        void Clear( );
+
+        // The tree is kept next to the data, tagged with the stamp of the
+        // data file, and only loaded back for the same stamp and shape
+        bool Save( const char * fname, SCI::UINT64 stamp ) const ;
+        bool Load( const char * fname, SCI::UINT64 stamp, int dim, int count );
+
+        int GetDimension( ) const ;
+        int GetNodeCount( ) const ;
+
+        // Node 0 is the root; the children of a node are numbered in a row
+        int        GetParent( int node ) const ;
+        int        GetChildCount( int node ) const ;
+        int        GetChild( int node, int i ) const ;
+        int        GetDepth( int node ) const ;
+        SCI::INT64 GetCount( int node ) const ;
+
+        // dim values each, indexed by real dimension
+        const float * GetCentroid( int node ) const ;
+        const float * GetMinimum( int node ) const ;
+        const float * GetMaximum( int node ) const ;
+
+        // At most budget nodes covering every row, splitting first the
+        // nodes with the largest count times boost, boost empty for 1
+        void GetCut( int budget, const std::vector<float> & boost, std::vector<int> & nodes ) const ;
+
+    protected:
+        struct Node {
+            int        parent;
+            int        first;
+            int        children;
+            int        depth;
+            SCI::INT64 count;
+        };
+
+        int                dimN;
+        std::vector<Node>  nodes;
+        std::vector<float> centroid;
+        std::vector<float> minV;
+        std::vector<float> maxV;
+    };
+
+}
+
+#endif // DATA_CLUSTERTREE_H
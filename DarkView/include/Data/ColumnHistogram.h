@@ -0,0 +1,91 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_COLUMNHISTOGRAM_H
+#define DATA_COLUMNHISTOGRAM_H
+
+#include <vector>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    class PhysicsData;
+
+    // Histograms of every column over its range. Each column keeps a
+    // pyramid of 2^0 .. 2^levels bins, stored like a binary heap, so any
+    // coarser bin count is a merge of finer bins.
+    class ColumnHistogram {
+    public:
+        ColumnHistogram( );
+
+        // Bin every column of data, the columns are processed in parallel
+        void Build( PhysicsData & data, int levels = 10 );
+        void Clear( );
+
+        // Incremental update for rows column-major, rows values per column,
+        // the columns in parallel. Values outside the range the histogram
+        // was built with fall in the end bins.
+        void AddColumns( const float * values, SCI::INT64 rows, SCI::INT64 weight = 1 );
+        void RemoveColumns( const float * values, SCI::INT64 rows );
+
+        int        GetDimension( ) const ;
+        int        GetBaseBins( ) const ;
+        SCI::INT64 GetCount( ) const ;
+
+        float GetMinimumValue( int dim ) const ;
+        float GetMaximumValue( int dim ) const ;
+
+        // Changes whenever the counts change, for caching derived values
+        unsigned int GetVersion( ) const ;
+        // Changes with the range or the counts of one column. A column that
+        // comes out the same from a new Build keeps its version.
+        unsigned int GetVersion( int dim ) const ;
+
+        // Finest level: the bin a value falls in, and the counts of dim
+        int                GetBaseBin( int dim, float val ) const ;
+        const SCI::INT64 * GetBaseCounts( int dim ) const ;
+
+        // Counts in bins equal bins spanning the range of dim
+        void GetHistogram( int dim, int bins, std::vector<float> & out ) const ;
+
+        // Gaussian kernel density sampled at the centres of bins equal bins,
+        // computed from the counts in those bins by FFT convolution in
+        // O(bins log bins).
+        // A bandwidth <= 0 selects one with Silverman's rule.
+        void GetDensity( int dim, int bins, std::vector<float> & out, float bandwidth = 0 ) const ;
+
+    protected:
+        int                                     dimN;
+        int                                     levels;
+        SCI::INT64                              count;
+        unsigned int                            version;
+        std::vector<float>                      min_dval;
+        std::vector<float>                      max_dval;
+        std::vector< std::vector<SCI::INT64> >  pyramid;
+        std::vector<unsigned int>               dim_version;
+        std::vector<SCI::UINT64>                dim_print;      // 0 when not known
+
+        void Propagate( std::vector<SCI::INT64> & tree );
+        SCI::UINT64 Fingerprint( int dim ) const ;
+        void Restamp( const std::vector<SCI::UINT64> & prints );
+    };
+
+}
+
+#endif // DATA_COLUMNHISTOGRAM_H
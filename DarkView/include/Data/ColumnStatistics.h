@@ -0,0 +1,71 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_COLUMNSTATISTICS_H
+#define DATA_COLUMNSTATISTICS_H
+
+#include <vector>
+#include <stdio.h>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    // Count, mean, range and co-moments of a set of columns. Statistics of
+    // separate blocks of rows can be merged without revisiting the rows.
+    class ColumnStatistics {
+    public:
+        ColumnStatistics( int _dimN = 0 );
+
+        void Reset( int _dimN );
+
+        // Add a column-major block of rows
+        void AddColumns( const float * values, SCI::INT64 rows );
+
+        // Combine with the statistics of another block of rows
+        void Merge( const ColumnStatistics & other );
+
+        SCI::INT64 GetCount( ) const ;
+        int        GetDimension( ) const ;
+
+        double GetMean( int dim ) const ;
+        double GetVariance( int dim ) const ;
+        float  GetMinimumValue( int dim ) const ;
+        float  GetMaximumValue( int dim ) const ;
+
+        // Pearson correlation, 0 when either column is constant
+        double GetCorrelation( int dim_x, int dim_y ) const ;
+
+        // True if some row could have dim within [lo,hi]
+        bool   Overlaps( int dim, float lo, float hi ) const ;
+
+        bool   Write( FILE * outfile ) const ;
+        bool   Read( FILE * infile );
+
+    protected:
+        SCI::INT64          count;
+        int                 dimN;
+        std::vector<double> mean;
+        std::vector<double> comoment;
+        std::vector<float>  min_dval;
+        std::vector<float>  max_dval;
+    };
+
+}
+
+#endif // DATA_COLUMNSTATISTICS_H
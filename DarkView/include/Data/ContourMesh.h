@@ -0,0 +1,68 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_CONTOURMESH_H
+#define DATA_CONTOURMESH_H
+
+#include <vector>
+
+namespace Data {
+
+    // Iso-regions of a scalar field sampled on a structured grid of
+    // columns by rows vertices. Vertex (i,j) is number i*rows+j, every
+    // cell is split into two triangles along the same diagonal, and
+    // marching triangles cuts each triangle at an iso level. The field is
+    // sampled once; any number of levels can then be extracted from it.
+    class ContourMesh {
+    public:
+        ContourMesh( );
+
+        // Positions of the grid vertices, the field starts at zero
+        void SetGrid( const std::vector<float> & x, const std::vector<float> & y, int columns, int rows );
+        void Clear( );
+
+        // Add 1/d for every source closer than its radius, d the distance
+        // from the vertex to the source. Bands of vertices are evaluated in
+        // parallel, four vertices at a time where SSE is available.
+        void AddInverseDistance( const std::vector< std::pair<float,float> > & source, const std::vector<float> & radius );
+
+        int GetColumns( ) const ;
+        int GetRows( ) const ;
+
+        // Grid vertices as x,y pairs, and the field at each of them
+        const std::vector<float> & GetVertices( ) const ;
+        const std::vector<float> & GetField( ) const ;
+
+        // Every triangle of the grid, as indices into GetVertices
+        void GetTriangles( std::vector<unsigned int> & indices ) const ;
+
+        // The part of the grid where the field is above iso, as x,y pairs
+        // and triangle indices. Vertices are shared between triangles.
+        void Extract( float iso, std::vector<float> & vertices, std::vector<unsigned int> & indices ) const ;
+
+    protected:
+        int                columns;
+        int                rows;
+        std::vector<float> gx, gy;
+        std::vector<float> vertices;
+        std::vector<float> field;
+    };
+
+}
+
+#endif // DATA_CONTOURMESH_H
@@ -51,6 +51,11 @@ namespace Data {
     protected:
         std::vector<float> data;
 
+        // When set, values are read from this column-major block instead of data (read-only)
+        const float * external;
+
+        inline const float * Values() const { return external ? external : ( data.empty() ? 0 : &data[0] ); }
+
         void RecalculateMinumumAndMaximum();
 
     };
@@ -0,0 +1,83 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_DENSITYRASTER_H
+#define DATA_DENSITYRASTER_H
+
+#include <vector>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    // Density image of many points or line segments, rasterized on the
+    // CPU. Coordinates are in [0,1] over the image, y up. Lines are drawn
+    // anti-aliased by Wu's method and points are splatted over their four
+    // nearest pixels. Every thread draws its share of the rows into a
+    // private image, so no two threads share a pixel. The images are kept
+    // over any number of Add calls, which cost only their rows, and are
+    // summed and freed once when the density is next read: a pass over
+    // threads x width x height per image, not per call.
+    class DensityRaster {
+    public:
+        enum ToneMapping {
+            LINEAR,      // density over the largest density
+            LOG,         // log(1+density) over log(1+largest)
+            EQUALIZE     // rank of the density among the covered pixels
+        };
+
+        DensityRaster( );
+
+        // Also clears the image
+        void Resize( int width, int height );
+        void Clear( );
+
+        int GetWidth( ) const ;
+        int GetHeight( ) const ;
+
+        // Scatter plot of n rows, x and y mapped from their ranges
+        void AddPoints( const float * x, float x_min, float x_max, const float * y, float y_min, float y_max, int n, float weight = 1.0f );
+
+        // n segments packed as x0,y0,x1,y1 in image coordinates
+        void AddSegments( const float * segments, int n, float weight = 1.0f );
+
+        // Reading sums what the threads drew since the last read
+        const std::vector<float> & GetDensity( );
+        float GetMaximum( );
+
+        // Density of every pixel mapped to [0,1]
+        void ToneMap( ToneMapping mapping, std::vector<float> & intensity );
+
+        // intensity through a transfer function of entries RGBA colours,
+        // linearly interpolated, to RGBA bytes ready for a texture
+        static void Colorize( const std::vector<float> & intensity, const float * transfer, int entries, std::vector<SCI::UINT8> & rgba );
+
+    protected:
+        int                               width;
+        int                               height;
+        std::vector<float>                density;
+        std::vector< std::vector<float> > parts;
+        bool                              pending;
+
+        float * Part( int thread );
+        void    Merge( );
+    };
+
+}
+
+#endif // DATA_DENSITYRASTER_H
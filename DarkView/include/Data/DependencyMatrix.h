@@ -0,0 +1,58 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_DEPENDENCYMATRIX_H
+#define DATA_DEPENDENCYMATRIX_H
+
+#include <vector>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    class PhysicsData;
+
+    // Pairwise mutual information of all columns from quantile binned 2D
+    // histograms. Unlike Pearson correlation this also picks up nonlinear
+    // and banded relationships.
+    class DependencyMatrix {
+    public:
+        DependencyMatrix( );
+
+        // bins is rounded up to a power of two, at most 128
+        void Build( PhysicsData & data, int bins = 32 );
+        void Clear( );
+
+        int   GetDimension( ) const ;
+
+        // Mutual information in bits
+        float GetMutualInformation( int dim_x, int dim_y ) const ;
+
+        // Approximation of the maximal information coefficient in [0,1],
+        // the best normalized mutual information over equipartition grids
+        float GetInformationCoefficient( int dim_x, int dim_y ) const ;
+
+    protected:
+        int                 dimN;
+        std::vector<float>  mi;
+        std::vector<float>  mic;
+    };
+
+}
+
+#endif // DATA_DEPENDENCYMATRIX_H
@@ -0,0 +1,70 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_EDGEBUNDLING_H
+#define DATA_EDGEBUNDLING_H
+
+#include <vector>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    // Kernel density estimation edge bundling of the lines of one gap of a
+    // parallel coordinates plot, in the unit square from x = 0 to x = 1.
+    // Every line is a polyline sampled at fixed x stations; each pass
+    // splats the weighted samples into a density grid, blurs it with a
+    // separable Gaussian, moves the samples up the density gradient and
+    // smooths every line. The kernel shrinks from pass to pass, so the
+    // lines gather on the ridges of the density. The grid passes run one
+    // column or row per thread. Lines given as a 2D histogram cost one
+    // weighted line per cell, however many rows fell in it.
+    class EdgeBundling {
+    public:
+        EdgeBundling( );
+
+        // n lines from a[i] on the left edge to b[i] on the right, in [0,1]
+        void SetLines( const float * a, const float * b, const float * weight, int n );
+
+        // one line per non-empty cell of a bins x bins histogram indexed
+        // [bin_a*bins + bin_b], through the centres of the cells
+        void SetJoint( const std::vector<SCI::UINT32> & joint, int bins );
+
+        // bandwidth is the kernel size of the first pass over the height
+        void Bundle( int iterations = 5, float bandwidth = 0.08f, int samples = 17, int height = 256 );
+
+        int   GetLineCount( ) const ;
+        int   GetSamples( ) const ;
+        float GetWeight( int line ) const ;
+        float GetMaximumWeight( ) const ;
+
+        // GetSamples() heights of a line, sample s at x = s / (samples-1)
+        const float * GetLine( int line ) const ;
+
+    protected:
+        int                samples;
+        std::vector<float> ends;      // a, b per line
+        std::vector<float> weight;
+        std::vector<float> points;    // samples per line
+
+        void Straighten( int samples );
+    };
+
+}
+
+#endif // DATA_EDGEBUNDLING_H
@@ -0,0 +1,130 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_FEDERATEDDATA_H
+#define DATA_FEDERATEDDATA_H
+
+#include <vector>
+#include <string>
+#include <map>
+
+#include <Data/PhysicsData.h>
+#include <Data/ColumnStatistics.h>
+
+namespace Data {
+
+    // One file of a federated dataset
+    struct DataShard {
+        std::string        filename;
+        SCI::INT64         first_row;   // global row id of the first row
+        SCI::INT64         rowN;
+        ColumnStatistics   stats;       // also serves as the zone map of the shard
+        std::vector<float> values;      // column-major, empty while not resident
+        bool               valid;
+    };
+
+    // A set of data files sharing the same columns, opened from a directory
+    // or a glob pattern and presented as one dataset without concatenating
+    // them. Every row has a 64-bit global id in file order. Statistics are
+    // computed per shard, cached next to the shard in a ".stats" file, and
+    // merged. Shards whose zone maps fall outside the active filter are not
+    // loaded; the filter only prunes whole shards, rows are not tested.
+    //
+    // Elements 0 .. GetElementCount()-1 are the rows of the active shards.
+    // With no shards open the class behaves like a plain PhysicsData.
+    class FederatedData : public PhysicsData {
+
+    public:
+        FederatedData( );
+        ~FederatedData( );
+
+        // Open every data file in a directory, or every file matching a glob pattern
+        bool Open( const char * pattern );
+        void Close( );
+
+        bool isFederated( ) const ;
+
+        // True if the name refers to a directory or contains glob characters
+        static bool isPattern( const char * name );
+
+        int                 GetShardCount( ) const ;
+        const DataShard   & GetShard( int shard ) const ;
+        bool                isShardActive( int shard ) const ;
+
+        // Only shards whose range on dim overlaps [lo,hi] stay active
+        void SetFilter( int dim, float lo, float hi );
+        void ClearFilter( int dim = -1 );
+        // Apply filter changes, loading and releasing shards as needed. The
+        // rows of shards leaving or joining are removed from or added to the
+        // column histograms in place.
+        bool Refresh( );
+        // Add files that appeared in the directory or started matching the
+        // pattern since it was opened, after the rows already open. Returns
+        // the number of new shards, Refresh loads them.
+        int Rescan( );
+
+        // Number of rows in all shards, including inactive ones
+        SCI::INT64 GetRowCount( ) const ;
+
+        // Merged statistics of the active shards
+        const ColumnStatistics & GetStatistics( ) const ;
+
+        // Get a rough estimate of the size of the data contained in the class
+        virtual int GetDataSize() const ;
+
+        // Various functions for setting values
+        virtual void SetElement( int elem_id, const std::vector<float> & val );
+        virtual void SetElement( int elem_id, int dim, float val );
+        virtual void SetElement( int elem_id, const float  * val );
+        virtual void SetElement( int elem_id, const double * val );
+
+        // Various functions for getting values
+        virtual SCI::VexN GetElement( int elem_id )                 const ;
+        virtual float     GetElement( int elem_id, int dim )        const ;
+        virtual void      GetElement( int elem_id, float  * space ) const ;
+        virtual void      GetElement( int elem_id, double * space ) const ;
+
+        virtual float     GetMaximumValue( int dim = -1 ) ;
+        virtual float     GetMinimumValue( int dim = -1 ) ;
+
+        virtual std::vector<float> ExtractDimension( int dim ) const ;
+
+    protected:
+        std::vector<DataShard>                  shards;
+        std::vector<int>                        active;         // resident shards, in file order
+        std::vector<int>                        active_first;   // first element of each active shard
+        std::map< int, std::pair<float,float> > filter;
+        ColumnStatistics                        stats;
+
+        // A glob is no file name, its metadata is kept next to the first shard
+        virtual std::string MetaFilename( ) const ;
+
+        bool ListFiles( const char * pattern, std::vector<std::string> & files );
+        bool LoadShard( DataShard & shard );
+        bool ReadStatistics( DataShard & shard );
+        void WriteStatistics( const DataShard & shard );
+        bool Passes( const DataShard & shard ) const ;
+        void Rebuild( );
+
+        // Shard holding an element, and the row of the element within it
+        const DataShard * Locate( int elem_id, SCI::INT64 & row ) const ;
+        DataShard       * Locate( int elem_id, SCI::INT64 & row );
+    };
+}
+
+#endif // DATA_FEDERATEDDATA_H
@@ -0,0 +1,105 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_FRAMEARENA_H
+#define DATA_FRAMEARENA_H
+
+#include <stddef.h>
+#include <vector>
+
+namespace Data {
+
+    // Scratch memory for the drawing code, one arena per thread. Buffers
+    // are bumped off a block and all given back at once when the scope
+    // that took them ends; the outermost scope ends a frame. A frame that
+    // outgrew the block leaves a single block big enough for it, so after
+    // the first few frames scratch buffers never touch the heap.
+    class FrameArena {
+    public:
+        // A typed scratch buffer; the values are not initialized, so only
+        // for plain types. Passes where a T * is expected.
+        template<class T>
+        class Span {
+        public:
+            Span( ) : ptr(0), n(0) { }
+            Span( T * _ptr, int _n ) : ptr(_ptr), n(_n) { }
+
+            T & operator[]( int i ) const { return ptr[i]; }
+            operator T * ( ) const { return ptr; }
+
+            T * data( ) const { return ptr; }
+            int size( ) const { return n; }
+
+        protected:
+            T * ptr;
+            int n;
+        };
+
+        // Everything allocated through a scope, or while it is open, is
+        // released when it closes
+        class Scope {
+        public:
+            Scope( );
+            ~Scope( );
+
+            template<class T>
+            Span<T> Alloc( int n ){
+                return Span<T>( (T*)arena.Allocate( sizeof(T) * (size_t)( n > 0 ? n : 0 ) ), n );
+            }
+
+        protected:
+            FrameArena & arena;
+            int          block;
+            size_t       top;
+
+        private:
+            Scope( const Scope & );
+            Scope & operator=( const Scope & );
+        };
+
+        // The arena of the calling thread
+        static FrameArena & Local( );
+
+        // Throws std::bad_alloc, as new does, when the heap runs out
+        void * Allocate( size_t bytes );
+
+    protected:
+        FrameArena( );
+        ~FrameArena( );
+
+        void Enter( );
+        void Leave( int block, size_t top );
+
+        struct Block {
+            char * mem;
+            size_t size;
+        };
+
+        std::vector<Block> blocks;
+        int    cur;
+        size_t top;
+        int    depth;
+
+    private:
+        FrameArena( const FrameArena & );
+        FrameArena & operator=( const FrameArena & );
+    };
+
+}
+
+#endif // DATA_FRAMEARENA_H
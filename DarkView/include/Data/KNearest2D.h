@@ -0,0 +1,64 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_KNEAREST2D_H
+#define DATA_KNEAREST2D_H
+
+#include <vector>
+
+namespace Data {
+
+    // k nearest neighbours of 2D points. The points are kept in an
+    // implicit k-d tree (median split, no node storage), so building is
+    // O(n log n) and a query is about O(log n + k). Neighbours come back
+    // ordered by distance, ties by point index, which is the order a
+    // brute force search with a stable sort produces.
+    class KNearest2D {
+    public:
+        KNearest2D( );
+
+        void Build( const std::vector<float> & x, const std::vector<float> & y );
+        void Clear( );
+
+        int GetCount( ) const ;
+
+        // Up to k nearest points of (qx,qy), returns how many were found
+        int Query( float qx, float qy, int k, int * index, float * dist ) const ;
+
+        // k nearest of every point, itself included, stored row by row
+        // in index and dist. Points are queried in parallel.
+        int QueryAll( int k, std::vector<int> & index, std::vector<float> & dist ) const ;
+
+    protected:
+        struct Candidate {
+            float d2;
+            int   id;
+            bool operator < ( const Candidate & o ) const { return d2 < o.d2 || ( d2 == o.d2 && id < o.id ); }
+        };
+
+        std::vector<float> px, py;   // points in tree order
+        std::vector<int>   pid;      // original index of each point in tree order
+
+        void BuildRange( int lo, int hi, int axis );
+        int  Query( float qx, float qy, int k, int * index, float * dist, std::vector<Candidate> & heap ) const ;
+        void Search( int lo, int hi, int axis, float qx, float qy, int k, float rd, float * off, std::vector<Candidate> & heap ) const ;
+    };
+
+}
+
+#endif // DATA_KNEAREST2D_H
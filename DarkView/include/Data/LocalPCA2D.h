@@ -0,0 +1,70 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_LOCALPCA2D_H
+#define DATA_LOCALPCA2D_H
+
+#include <vector>
+
+namespace Data {
+
+    // Principal components of many small groups of 2D points at once.
+    // Group g is point g and the groupSize points listed in row g of
+    // members, the layout KNearest2D::QueryAll produces. The 2x2
+    // covariance of each group is solved in closed form and every result
+    // is stored as its own array, one entry per group.
+    class LocalPCA2D {
+    public:
+        LocalPCA2D( );
+
+        // Groups are processed in parallel
+        void Compute( const std::vector<float> & x, const std::vector<float> & y, const std::vector<int> & members, int groupSize );
+        void Clear( );
+
+        // Multiple scales: neighbours nearest first make each smaller
+        // neighbourhood a prefix of a larger one, so a single pass along
+        // every member row takes the moments of point g and its first s
+        // members for each s in sizes. Only those are kept, 5 floats per
+        // group and size. Solve then gives the results for one of the sizes
+        // in O(1) per group; any other size uses the largest kept below it.
+        void Accumulate( const std::vector<float> & x, const std::vector<float> & y, const std::vector<int> & members, int groupSize, const std::vector<int> & sizes );
+        void Solve( int groupSize );
+        int  GetMaxGroupSize( ) const ;
+
+        int GetGroupCount( ) const ;
+
+        // Mean of the group
+        std::vector<float> meanX, meanY;
+        // Unit eigenvectors of the largest and the smallest eigenvalue.
+        // Their sign is arbitrary, as with any eigen solver.
+        std::vector<float> majorX, majorY;
+        std::vector<float> minorX, minorY;
+        // Eigenvalues of the sample covariance, majorValue >= minorValue
+        std::vector<float> majorValue, minorValue;
+
+    protected:
+        std::vector<int>   prefixSizes;  // ascending
+        std::vector<float> originX, originY;
+        std::vector<float> prefix[5];    // mx, my, xx, yy, xy per prefix size and group
+
+        void Finish( const float * x, const float * y, int groupSize );
+    };
+
+}
+
+#endif // DATA_LOCALPCA2D_H
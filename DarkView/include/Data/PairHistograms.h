@@ -0,0 +1,72 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_PAIRHISTOGRAMS_H
+#define DATA_PAIRHISTOGRAMS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Data/BinnedColumns.h>
+
+namespace Data {
+
+    class PhysicsData;
+
+    // 2D histograms of pairs of columns, for drawing a gap of a parallel
+    // coordinates plot in time independent of the number of rows. The
+    // columns are coded once in equal width bins; a pair then costs one
+    // pass over two byte arrays, and only the pairs asked for are kept.
+    // Rows appended to the same file are coded and added to every kept
+    // histogram without going over the old rows again.
+    class PairHistograms {
+    public:
+        PairHistograms( );
+
+        // Code the columns of data, or only the rows appended since the
+        // last call when data is the file coded before
+        void Update( PhysicsData & data, int bins = 32 );
+        void Clear( );
+
+        int GetBins( ) const ;
+        int GetElementCount( ) const ;
+
+        // Range the bins of a real dimension span
+        float GetMinimumValue( int dim ) const ;
+        float GetMaximumValue( int dim ) const ;
+
+        // Histograms of the pairs not kept yet, one pair per thread
+        void Compute( const std::vector< std::pair<int,int> > & pairs );
+
+        // bins x bins counts of a pair of real dimensions, indexed
+        // [bin_x*bins + bin_y], 0 until the pair is computed
+        const std::vector<SCI::UINT32> * GetJoint( int dim_x, int dim_y ) const ;
+
+        // Drop the histograms of every pair not listed
+        void Retain( const std::vector< std::pair<int,int> > & pairs );
+
+    protected:
+        BinnedColumns                                              columns;
+        std::string                                                source;
+        std::map< std::pair<int,int>, std::vector<SCI::UINT32> >   joints;
+    };
+
+}
+
+#endif // DATA_PAIRHISTOGRAMS_H
@@ -27,6 +27,11 @@
 
 #include <SCI/Utility.h>
 #include <Data/DenseMultiDimensionalData.h>
+#include <Data/SharedMemory.h>
+#include <Data/ColumnStatistics.h>
+#include <Data/ColumnHistogram.h>
+#include <Data/DependencyMatrix.h>
+#include <Data/Scagnostics.h>
 
 namespace Data {
     class PhysicsData : public DenseMultiDimensionalData {
@@ -41,6 +46,20 @@ namespace Data {
 
         std::string GetFilename();
 
+        // Share the loaded columns, statistics and correlation with other processes.
+        // After publishing, this instance reads from the shared segment as well.
+        bool PublishShared( const char * segname );
+        // Map a dataset published by another process, read-only and without parsing
+        bool AttachShared( const char * segname, const char * fname );
+        void ReleaseShared( );
+        bool isShared( ) const ;
+
+        // Default segment name for a data file
+        static std::string SharedName( const char * fname );
+
+        // Identifies the version of a data file from its modification time and size
+        static SCI::UINT64 FileStamp( const char * fname );
+
         void LoadMeta( );
         void SaveMeta( );
         void CopyMeta( const PhysicsData & from );
@@ -62,6 +81,18 @@ namespace Data {
 
         float GetCorrelation( int dim_x, int dim_y );
 
+        // Mutual information (bits) and its normalized [0,1] form, computed on
+        // first use; safe to call from threads other than the one that loaded
+        float GetMutualInformation( int dim_x, int dim_y );
+        float GetInformationCoefficient( int dim_x, int dim_y );
+
+        // Per column histograms, built on first use after loading
+        const ColumnHistogram & GetHistogram( );
+
+        // Shape measures of all column pairs, built on first use after loading,
+        // from any thread
+        const Scagnostics & GetScagnostics( );
+
         bool isEnabled( int dim ) const ;
         bool isDisabled( int dim ) const ;
 
@@ -73,10 +104,24 @@ namespace Data {
         std::string                           filename;
         std::vector<bool>                     dim_enabled;
         std::vector<std::string>              labels;
+        std::vector<std::string>              labels_parsed;
+        SharedSegment                         shared;
+        ColumnHistogram                       histogram;
+        DependencyMatrix                      dependency;
+        Scagnostics                           scagnostics;
+
+        // File the enabled dimensions and labels are kept in
+        virtual std::string MetaFilename( ) const ;
 
+        // LaTeX-style tags of a label replaced by the font's characters
+        static std::string ParseLabel( std::string lbl );
         void ConditionString( char * buf );
         void ParseString( char * str, std::vector<float> & vals );
+        bool ReadValues( const char * fname, std::vector<float> & vals, int & dim );
         void CalculateCorrelation( );
+        void SetCorrelation( const ColumnStatistics & stats );
+        // The histograms can be kept by callers that update them in place
+        void ClearDerived( bool keep_histogram = false );
     };
 }
 
@@ -0,0 +1,69 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_SCAGNOSTICS_H
+#define DATA_SCAGNOSTICS_H
+
+#include <vector>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    class PhysicsData;
+
+    // Shape measures of every pair of columns, in the spirit of Wilkinson's
+    // scagnostics. Instead of a minimum spanning tree over the points each
+    // pair is reduced to a bins x bins 2D histogram and the measures are
+    // taken over the occupied cells, so the cost per pair is one pass over
+    // two byte arrays no matter how the points are distributed.
+    class Scagnostics {
+    public:
+        enum Measure {
+            OUTLYING,    // share of occupied cells with no occupied neighbour
+            SKEWED,      // skew of the cell densities
+            CLUMPY,      // mass outside the largest connected group of cells
+            SPARSE,      // share of empty cells
+            STRIATED,    // share of cells on straight runs of cells
+            STRINGY,     // share of cells with at most two neighbours
+            SKINNY,      // elongation of the occupied cells
+            MONOTONIC,   // squared rank correlation
+            MEASURE_COUNT
+        };
+
+        Scagnostics( );
+
+        // All pairs are measured in parallel
+        void Build( PhysicsData & data, int bins = 32 );
+        void Clear( );
+
+        int   GetDimension( ) const ;
+        float GetMeasure( int dim_x, int dim_y, int measure ) const ;
+
+        static const char * GetMeasureName( int measure );
+
+    protected:
+        int                 dimN;
+        std::vector<float>  values;     // [measure][dim_x][dim_y]
+
+        void MeasurePair( const std::vector<SCI::UINT32> & joint, int bins, float * out ) const ;
+    };
+
+}
+
+#endif // DATA_SCAGNOSTICS_H
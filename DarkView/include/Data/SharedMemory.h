@@ -0,0 +1,99 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DATA_SHAREDMEMORY_H
+#define DATA_SHAREDMEMORY_H
+
+#include <string>
+#include <stddef.h>
+
+#include <SCI/Utility.h>
+
+namespace Data {
+
+    // Header placed at the start of every segment. The reference count is
+    // shared by every process that has the segment mapped, for reporting
+    // only: a process that crashed never gives its reference back. The
+    // owner is the pid of the creating process; ready is 1 once published
+    // and -1 once the segment was unlinked.
+    struct SharedHeader {
+        char             magic[8];
+        SCI::INT32       version;
+        volatile SCI::INT32 refcount;
+        volatile SCI::INT32 ready;
+        SCI::INT32       owner;
+        SCI::UINT64      payload;
+        SCI::UINT64      stamp;
+    };
+
+    // A named block of memory that can be mapped by several processes.
+    // Names of the form "/name" are POSIX shared memory objects, any other
+    // name is treated as a path and backed by a shared memory mapped file.
+    // Every process mapping a segment holds a shared advisory lock on it,
+    // which the system drops when the process exits however it ends; the
+    // process that can take the lock exclusively is the last one, and only
+    // it unlinks the segment.
+    class SharedSegment {
+    public:
+        SharedSegment( );
+        ~SharedSegment( );
+
+        // Create a new segment with room for payload bytes, mapped read/write.
+        // A stale segment of the same name is unlinked and replaced.
+        bool Create( const char * name, size_t payload, SCI::UINT64 stamp );
+
+        // Map an existing segment read-only, fails if it is not ready or the
+        // stamp differs. A segment no process has mapped any more is stale
+        // unless it is complete and holds the same stamp, it is unlinked so
+        // the next Create can replace it.
+        bool Attach( const char * name, SCI::UINT64 stamp );
+
+        // Mark a created segment as complete so other processes can attach
+        void Publish( );
+
+        // Drop this process' reference, unlinking the segment if it was the last one
+        void Release( );
+
+        bool isValid( ) const ;
+        bool isWritable( ) const ;
+
+        int  GetReferenceCount( ) const ;
+
+        const std::string & GetName( ) const ;
+
+        void       * GetWritablePayload( );
+        const void * GetPayload( ) const ;
+        size_t       GetPayloadSize( ) const ;
+
+        static bool isFileBacked( const char * name );
+
+    protected:
+        std::string    name;
+        int            fd;              // kept open for the lock
+        SharedHeader * header;
+        size_t         mapped_size;
+        bool           writable;
+
+    private:
+        SharedSegment( const SharedSegment & );
+        SharedSegment & operator = ( const SharedSegment & );
+    };
+
+}
+
+#endif // DATA_SHAREDMEMORY_H
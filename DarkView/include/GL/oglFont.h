@@ -19,6 +19,10 @@
 #ifndef OGLWIDGETS_OGLFONT_H
 #define OGLWIDGETS_OGLFONT_H
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace oglWidgets {
     class oglFont  {
 
@@ -32,15 +36,40 @@ namespace oglWidgets {
         float GetWidth( const char * chr );
         float GetWidthf(const char *fmt, ...);
 
+        // A string is laid out once, its glyphs side by side in one vertex
+        // array, and drawn by a single call from then on
         void Print( char chr );
         void Print( const char * chr );
         void Printf(const char *fmt, ...);
 
+        // Prints at (x,y), scaled and then turned clockwise by rotation
+        // degrees, in the given color; the same as translating, setting the
+        // color, scaling and rotating around Print
+        void Print( const char * chr, float x, float y, float scale_x, float scale_y, float rotation, const float * rgba );
+
+        // Strings placed by the call above between the two are gathered
+        // and drawn together by one call in EndBatch, under the modelview
+        // matrix current then; other prints draw at once
+        void BeginBatch( );
+        void EndBatch( );
+
     protected:
+        struct Layout {
+            std::vector<float> verts;
+            float              width;
+        };
+        const Layout & GetLayout( const char * chr );
+
         int     vertN[256];
         float   chrW[256];
         float * verts[256];
 
+        std::map<std::string,Layout> layouts;
+
+        bool               batching;
+        std::vector<float> batchVerts;
+        std::vector<float> batchColors;
+
     };
 }
 
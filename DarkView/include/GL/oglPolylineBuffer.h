@@ -0,0 +1,94 @@
+/*
+**  Common OpenGL Support Library
+**  Copyright (C) 2013  Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OGLWIDGETS_OGLPOLYLINEBUFFER_H
+#define OGLWIDGETS_OGLPOLYLINEBUFFER_H
+
+#include <GL/oglCommon.h>
+
+#include <vector>
+
+namespace oglWidgets {
+
+    // Many polylines packed into one vertex buffer object and drawn with a
+    // single glMultiDrawArrays, in place of a glBegin/glEnd per line. The
+    // lines are built on the CPU between Begin and End, the same way they
+    // would be with glVertex and glColor, and uploaded on the next Draw.
+    // A GL_STATIC_DRAW buffer drops its CPU arrays once uploaded. Without
+    // buffer objects the same arrays are drawn as client side vertex
+    // arrays.
+    //
+    // The buffers belong to the GL context current at the first Draw. A
+    // copy starts empty, so keep many of them in a std::deque, which does
+    // not copy on growth.
+    class oglPolylineBuffer
+    {
+    protected:
+        int components;
+        GLenum usage;
+        unsigned int version;
+        bool uploaded;
+        bool has_color;
+
+        std::vector<float> vertex;
+        std::vector<float> color;
+        float cur_color[4];
+
+        std::vector<GLint> first;
+        std::vector<GLsizei> count;
+
+        GLuint vbo[2];
+
+        void Upload();
+        void Bind() const ;
+        void Unbind() const ;
+        void MultiDraw(GLenum mode, const GLint * f, const GLsizei * c, int n) const ;
+
+    public:
+        oglPolylineBuffer(void);
+        oglPolylineBuffer(const oglPolylineBuffer & other);
+        oglPolylineBuffer & operator=(const oglPolylineBuffer & other);
+        virtual ~oglPolylineBuffer(void);
+
+        // components is 2 or 3, usage GL_STATIC_DRAW for data kept across
+        // frames and GL_STREAM_DRAW for batches rebuilt every frame
+        void Begin(int components = 3, GLenum usage = GL_STATIC_DRAW);
+        void Color(float r, float g, float b, float a = 1.0f);
+        void Vertex(float x, float y, float z = 0.0f);
+        void EndLine();
+        void End(unsigned int version = 0);
+
+        // true when the buffer was last built for this version
+        bool IsCurrent(unsigned int version) const ;
+        bool IsEmpty() const ;
+        int  GetLineCount() const ;
+
+        // with colour off, or without any Color call, the current glColor
+        // is used for every line
+        void Draw(GLenum mode, bool use_color = true);
+        // vertices first .. first+count-1, across lines, with glDrawArrays
+        // in the current glColor
+        void DrawRange(GLenum mode, int first, int count);
+
+        // drops the GL buffers and the lines, the context must be current
+        void Release();
+    };
+}
+
+#endif // OGLWIDGETS_OGLPOLYLINEBUFFER_H
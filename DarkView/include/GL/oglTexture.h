@@ -39,6 +39,10 @@ namespace oglWidgets {
         oglTexture(GLenum target);
         virtual ~oglTexture(void);
 
+        // A copy has no texture of its own until it is given an image
+        oglTexture(const oglTexture & other);
+        oglTexture & operator=(const oglTexture & other);
+
         virtual bool SetMinFilter(GLint v);
         virtual bool SetMagFilter(GLint v);
         virtual bool SetMinMagFilter(GLint v_min, GLint v_mag);
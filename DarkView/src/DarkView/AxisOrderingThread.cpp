@@ -0,0 +1,97 @@
+/*
+**  Data Scalable Approach for Parallel Coordinates
+**  Copyright (C) 2016 - Hoa Nguyen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <DarkView/AxisOrderingThread.h>
+#include <DarkView/DataIndirector.h>
+#include <Data/AxisOrdering.h>
+
+#include <QMutexLocker>
+
+AxisOrderingThread::AxisOrderingThread( QObject * parent ) : QThread( parent )
+{
+    data = 0;
+    measure = DataIndirector::ORDER_CORRELATION;
+    fresh = false;
+    stopping = false;
+}
+
+AxisOrderingThread::~AxisOrderingThread()
+{
+    Stop();
+}
+
+void AxisOrderingThread::Order( Data::PhysicsData * _data, const std::vector<int> & _dims, int _measure )
+{
+    Stop();
+
+    data    = _data;
+    dims    = _dims;
+    measure = _measure;
+    {
+        QMutexLocker lock( &mutex );
+        best.clear();
+        fresh = false;
+    }
+    stopping = false;
+    start( QThread::LowPriority );
+}
+
+void AxisOrderingThread::Stop( )
+{
+    stopping = true;
+    wait();
+}
+
+bool AxisOrderingThread::GetOrder( std::vector<int> & order )
+{
+    QMutexLocker lock( &mutex );
+    if( !fresh )
+        return false;
+    order = best;
+    fresh = false;
+    return true;
+}
+
+void AxisOrderingThread::Publish( const std::vector<int> & order )
+{
+    {
+        QMutexLocker lock( &mutex );
+        best.clear();
+        for(int i = 0; i < (int)order.size(); i++)
+            best.push_back( dims[ order[i] ] );
+        fresh = true;
+    }
+    emit Improved();
+}
+
+void AxisOrderingThread::run( )
+{
+    // O(D^2) pair scores, the information and scagnostic ones built on
+    // first use, so they are taken here rather than by the caller
+    std::vector<float> score;
+    DataIndirector::GetOrderingScores( *data, dims, measure, score );
+    if( stopping )
+        return;
+
+    Data::AxisOrdering ordering;
+    ordering.Start( score, (int)dims.size() );
+    Publish( ordering.GetOrder() );
+
+    while( !stopping && ordering.Improve() )
+        Publish( ordering.GetOrder() );
+}
@@ -17,8 +17,12 @@
 */
 
 #include <DarkView/DataIndirector.h>
+#include <Data/AxisOrdering.h>
 
-DataIndirector::DataIndirector(Data::PhysicsData * _data ) : data(_data) {
+#include <algorithm>
+#include <math.h>
+
+DataIndirector::DataIndirector(Data::PhysicsData * _data ) : data(_data), measure(PEARSON) {
     Recompute();
     SortData();
 }
@@ -39,33 +43,60 @@ void DataIndirector::Recompute() {
 }
 
 // This function is used to sort dimensions of visual data
-// indr is vector that contain list of visual dimension
+// indr is vector that contain list of visual dimension. The order is a
+// path through the dimensions with the most dependent neighbours, built
+// greedily and improved for a few sweeps; the axis ordering thread of the
+// main window keeps improving it without blocking.
 void DataIndirector::SortData() {
-    int dim = indr.size();
-    float tp = 0.0f;
-    float cor[100];
+    std::vector<float> score;
+    GetOrderingScores( ( measure == PEARSON ) ? ORDER_CORRELATION : ORDER_INFORMATION, score );
+
+    Data::AxisOrdering ordering;
+    ordering.Start( score, (int)indr.size() );
+    for(int pass = 0; pass < 4 && ordering.Improve(); pass++) { }
 
-    for(int e = 0; e < dim -1; e++) 
+    std::vector<int> sorted;
+    for(int i = 0; i < (int)ordering.GetOrder().size(); i++)
     {
-        cor[e] = data->GetCorrelation(e, e+1);
+        sorted.push_back( indr[ ordering.GetOrder()[i] ] );
     }
+    indr = sorted;
+}
+
+void DataIndirector::GetOrderingScores( int _measure, std::vector<float> & score ) {
+    GetOrderingScores( *data, indr, _measure, score );
+}
 
-    // sort dimensions from smallest to biggest
-    for (int m = 0;  m < dim - 2;  m++)
+void DataIndirector::GetOrderingScores( Data::PhysicsData & data, const std::vector<int> & real, int _measure, std::vector<float> & score ) {
+    int dim = (int)real.size();
+    score.assign( dim*dim, 0.0f );
+    for(int i = 0; i < dim; i++)
     {
-        for (int j = 0;  j < dim -2 - m;  j++)
+        for(int j = 0; j < i; j++)
         {
-            if (cor[j] > cor[j+1])
-            {
-                tp = cor[j];
-                cor[j] = cor[j+1];
-                cor[j+1]= tp;
-                std::swap(indr[j], indr[j+1]);
-            }
+            float s;
+            if( _measure == ORDER_INFORMATION )
+                s = data.GetInformationCoefficient( real[i], real[j] );
+            else if( _measure == ORDER_TREND )
+                s = data.GetScagnostics().GetMeasure( real[i], real[j], Data::Scagnostics::MONOTONIC );
+            else
+                s = fabsf( data.GetCorrelation( real[i], real[j] ) );
+            score[i*dim+j] = score[j*dim+i] = s;
         }
     }
 }
 
+bool DataIndirector::SetOrder( const std::vector<int> & real ) {
+    std::vector<int> a = real;
+    std::vector<int> b = indr;
+    std::sort( a.begin(), a.end() );
+    std::sort( b.begin(), b.end() );
+    if( a != b )
+        return false;
+    indr = real;
+    return true;
+}
+
 // hoa sua
 // This function is used to swap two dimension of data indirector.
 void DataIndirector::SwapDims(int dim_x, int dim_y)
@@ -97,6 +128,10 @@ float DataIndirector::GetElement( int elem_id, int dim ){
     return data->GetElement( elem_id, indr[dim] );
 }
 
+std::vector<float> DataIndirector::ExtractDimension( int dim ){
+    return data->ExtractDimension( indr[dim] );
+}
+
 std::string DataIndirector::GetLabel( int dim ){
     return data->GetLabel( indr[dim] );
 }
@@ -109,6 +144,59 @@ float DataIndirector::GetCorrelation( int dim_x, int dim_y ){
     return data->GetCorrelation( indr[dim_x], indr[dim_y] );
 }
 
+float DataIndirector::GetMutualInformation( int dim_x, int dim_y ){
+    return data->GetMutualInformation( indr[dim_x], indr[dim_y] );
+}
+
+float DataIndirector::GetInformationCoefficient( int dim_x, int dim_y ){
+    return data->GetInformationCoefficient( indr[dim_x], indr[dim_y] );
+}
+
+float DataIndirector::GetDependency( int dim_x, int dim_y ){
+    if( measure == PEARSON )
+        return GetCorrelation( dim_x, dim_y );
+    return GetInformationCoefficient( dim_x, dim_y );
+}
+
+void DataIndirector::SetDependencyMeasure( int _measure ){
+    measure = _measure;
+}
+
+int DataIndirector::GetDependencyMeasure( ){
+    return measure;
+}
+
+float DataIndirector::GetScagnostic( int dim_x, int dim_y, int _measure ){
+    return data->GetScagnostics().GetMeasure( indr[dim_x], indr[dim_y], _measure );
+}
+
+static bool ScoreGreater( const std::pair< float, std::pair<int,int> > & a, const std::pair< float, std::pair<int,int> > & b ){
+    return a.first > b.first;
+}
+
+void DataIndirector::GetTopPairs( int _measure, int K, std::vector< std::pair<int,int> > & pairs ){
+    const Data::Scagnostics & scag = data->GetScagnostics();
+
+    std::vector< std::pair< float, std::pair<int,int> > > scored;
+    for(int i = 0; i < (int)indr.size(); i++){
+        for(int j = 0; j < i; j++){
+            scored.push_back( std::make_pair( scag.GetMeasure( indr[i], indr[j], _measure ), std::make_pair(i,j) ) );
+        }
+    }
+
+    K = SCI::Max( 0, SCI::Min( K, (int)scored.size() ) );
+    std::partial_sort( scored.begin(), scored.begin()+K, scored.end(), ScoreGreater );
+
+    pairs.clear();
+    for(int k = 0; k < K; k++){
+        pairs.push_back( scored[k].second );
+    }
+}
+
+const Data::ColumnHistogram & DataIndirector::GetHistogram( ){
+    return data->GetHistogram();
+}
+
 float DataIndirector::GetMinimumValue( int dim ){
     if( dim == -1 )
         return data->GetMinimumValue( -1 );
@@ -17,6 +17,7 @@
 */
 
 #include <DarkView/Kmean.h>
+#include <Data/FrameArena.h>
 #include <GL/oglCommon.h>
 
 #include <QMouseEvent>
@@ -27,6 +28,8 @@
 
 Kmean::Kmean(MainWidget *_mw, oglWidgets::oglFont & _font, QWidget * parent ) : QGLWidget( QGLFormat(QGL::SingleBuffer | QGL::DepthBuffer | QGL::Rgba | QGL::AlphaChannel | QGL::DirectRendering | QGL::SampleBuffers), parent )
 {
+    scheduler = 0;
+    schedulerView = -1;
     curveDegree = 3;
     eleRange = 0.1f;
 
@@ -35,6 +38,10 @@ Kmean::Kmean(MainWidget *_mw, oglWidgets::oglFont & _font, QWidget * parent ) :
 
     data = 0;
     curDraw = 0;
+    elementKey = 0;
+    elementData = 0;
+    densityRows = 1000000;
+    densityKey = 0;
     selected = -1;
     d_scale = 0.1f;
     font = &_font;
@@ -72,6 +79,7 @@ Kmean::Kmean(MainWidget *_mw, oglWidgets::oglFont & _font, QWidget * parent ) :
 void Kmean::SetData( DataIndirector * _data )
 {
     data = _data;
+    elementData++;
 
     // clear dimLoc before setup or update data
     dimLoc.clear();
@@ -115,11 +123,13 @@ void Kmean::SetData( DataIndirector * _data )
             dimLoc.push_back( std::make_pair(loc,d) );
         }
     }
+    update();
 }
 
 void Kmean::Reset()
 {
     curDraw = 0;
+    update();
 }
 
 void Kmean::initializeGL()
@@ -130,6 +140,15 @@ void Kmean::initializeGL()
 void Kmean::resizeGL ( int, int )
 {
     curDraw = 0;
+    // the cost of a row changes with the size of the view
+    if( scheduler )
+        scheduler->Cancel( schedulerView );
+}
+
+void Kmean::SetScheduler( ProgressiveScheduler * _scheduler )
+{
+    scheduler = _scheduler;
+    schedulerView = scheduler->AddView();
 }
 
 void Kmean::mousePressEvent ( QMouseEvent * event )
@@ -196,6 +215,7 @@ void Kmean::mousePressEvent ( QMouseEvent * event )
         stopRange = false;
     }
 
+    update();
 }
 
 void Kmean::mouseReleaseEvent ( QMouseEvent * event )
@@ -246,6 +266,7 @@ void Kmean::mouseReleaseEvent ( QMouseEvent * event )
         stopRange = true;
     }
 
+    update();
 }
 
 void Kmean::mouseMoveEvent ( QMouseEvent * event )
@@ -358,15 +379,22 @@ void Kmean::mouseMoveEvent ( QMouseEvent * event )
     }
     emit UpdatedSelection( scatter_pair );
 
+    update();
 }
 
 void Kmean::Start()
 {
     started = true;
+    update();
 }
 
 void Kmean::paintGL()
 {
+    Data::FrameArena::Scope scratch;
+
+    if( scheduler )
+        scheduler->BeginFrame( schedulerView );
+
     glViewport( 0, 0, size().width(), size().height() );
     if( curDraw == 0 )
     {
@@ -376,13 +404,11 @@ void Kmean::paintGL()
 
     if( !started )
     {
-        update();
         return;
     }
 
     if(data == 0 )
     {
-        update();
         return;
     }
 
@@ -429,17 +455,14 @@ void Kmean::paintGL()
 
         // draw PCP labels
         float aspect = (float)size().width()/(float)size().height();
+        const float labelColor[4] = { 0.6f, 0.6f, 0.6f, 1.0f };
+        font->BeginBatch();
         for(int d = 0; d < dim; d++)
         {
-            glPushMatrix();
-                glTranslatef( dimLoc[d].first+0.0075, 0.95f, 0 );
-                glColor3f(0.6f,0.6f,0.6f);
-                glScalef(0.02f,0.02f*aspect,0.1f);
-                glRotatef(90,0,0,-1);
-                int _d = dimLoc[d].second;
-                font->Print( data->GetLabelParsed(_d).c_str() );
-            glPopMatrix();
+            int _d = dimLoc[d].second;
+            font->Print( data->GetLabelParsed(_d).c_str(), dimLoc[d].first+0.0075f, 0.95f, 0.02f, 0.02f*aspect, 90, labelColor );
         }        
+        font->EndBatch();
         // end of draw PCP labels
     }
 
@@ -449,7 +472,7 @@ void Kmean::paintGL()
 
     glDepthFunc( GL_LEQUAL );
 
-    float * space = new float[dim];
+    Data::FrameArena::Span<float> space = scratch.Alloc<float>( dim );
 
     // draw elements of PCP
     #if 0
@@ -460,42 +483,142 @@ void Kmean::paintGL()
         }
         curDraw = 0;
     #else
+    if( data->GetElementCount() > densityRows )
+    {
+        // all rows at once, there is nothing to add a chunk at a time
+        if( curDraw == 0 )
+            DrawDensity();
+        curDraw = data->GetElementCount();
+    }
+    else
+    {
         int step = SCI::Max( 1, data->GetElementCount() / 500 );
 
+        // the elements of a layout are built once, a chunk a frame, into
+        // buffers kept on the GPU; drawing the same layout again replays
+        // the chunks built so far and goes on after them
+        int first = -1;
         if( curDraw == 0 )
         {
-            for( ; curDraw < data->GetElementCount(); curDraw += step )
+            SCI::UINT64 key = ElementKey();
+            if( key != elementKey )
             {
-                 data->GetElement( curDraw, space );
-                 DrawElement(space);
+                elementChunks.clear();
+                elementEnd.clear();
+                elementKey = key;
             }
-            curDraw = 1;
+            if( elementChunks.empty() )
+            {
+                // every step-th row first
+                elementChunks.push_back( oglWidgets::oglPolylineBuffer() );
+                elementChunks.back().Begin( 3, GL_STATIC_DRAW );
+                for( ; curDraw < data->GetElementCount(); curDraw += step )
+                {
+                     data->GetElement( curDraw, space );
+                     DrawElement(space);
+                }
+                elementChunks.back().End( );
+                elementEnd.push_back( 1 );
+            }
+            for(int k = 0; k < (int)elementChunks.size(); k++)
+                elementChunks[k].Draw( GL_LINES );
+            curDraw = elementEnd.back();
          }
-         else
+         else if( curDraw < data->GetElementCount() )
          {
-             int fin = curDraw+500;
+             // as many rows as fit in what is left of the frame
+             first = curDraw;
+             elementChunks.push_back( oglWidgets::oglPolylineBuffer() );
+             elementChunks.back().Begin( 3, GL_STATIC_DRAW );
+             int fin = curDraw + ( scheduler ? scheduler->Grant( schedulerView, 0, data->GetElementCount()-curDraw ) : 500 );
              for( ; curDraw < fin && curDraw < data->GetElementCount(); curDraw++ )
              {
                  if( (curDraw%step) == 0 ) continue;
                  data->GetElement( curDraw, space );
                  DrawElement(space);
              }
+             elementChunks.back().End( );
+             elementEnd.push_back( curDraw );
+             elementChunks.back().Draw( GL_LINES );
          }
+         if( scheduler && first >= 0 )
+             scheduler->Done( schedulerView, 0, curDraw-first );
+    }
      #endif
 
-     delete [] space;
      glDisable( GL_BLEND );
-     update();
+     // frames are drawn while rows are left, otherwise only on a change
+     if( curDraw < data->GetElementCount() )
+         update();
      // end of drawing elements of PCP
  }
 
+// FNV-1a over raw bytes
+static void FoldKey( SCI::UINT64 & h, const void * p, size_t n )
+{
+    const unsigned char * b = (const unsigned char*)p;
+    for(size_t i = 0; i < n; i++)
+        h = ( h ^ b[i] ) * 1099511628211ULL;
+}
+
+template<class T>
+static void FoldKey( SCI::UINT64 & h, const std::vector<T> & v )
+{
+    if( !v.empty() )
+        FoldKey( h, &v[0], v.size() * sizeof(T) );
+}
+
+// everything the element lines are laid out from, so a change rebuilds them
+SCI::UINT64 Kmean::ElementKey() const
+{
+    SCI::UINT64 h = 14695981039346656037ULL;
+    int rows = ( data != 0 ) ? data->GetElementCount() : 0;
+    FoldKey( h, &elementData, sizeof(elementData) );
+    FoldKey( h, &rows, sizeof(rows) );
+    FoldKey( h, &curveDegree, sizeof(curveDegree) );
+    FoldKey( h, &rangeV, sizeof(rangeV) );
+    FoldKey( h, &eleRange, sizeof(eleRange) );
+    FoldKey( h, dimLoc );
+    FoldKey( h, dim_min );
+    FoldKey( h, dim_max );
+    FoldKey( h, maxPoint );
+    FoldKey( h, curvePos );
+    FoldKey( h, qua_a );
+    FoldKey( h, qua_b );
+    FoldKey( h, qua_c );
+    FoldKey( h, cub_a );
+    FoldKey( h, cub_b );
+    FoldKey( h, cub_c );
+    FoldKey( h, cub_d );
+    return h;
+}
+
 // draw elements of dimensions
 void Kmean::DrawElement( float * elem )
 {    
-    glBegin(GL_LINES);
-    glLineWidth(3.0f);
-    glColor4f( 0, 0, 0, 0.025f );
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> seg = scratch.Alloc<float>( (dim-1)*8 );
+    ElementSegments( elem, seg );
 
+    oglWidgets::oglPolylineBuffer & lines = elementChunks.back();
+    lines.Color( 0, 0, 0, 0.025f );
+    for(int j = 0; j < (dim-1); j++)
+    {
+        lines.Vertex( seg[j*8+0], seg[j*8+1], -0.5f );
+        lines.Vertex( seg[j*8+2], seg[j*8+3], -0.5f );
+
+        // draw grey horizontal lines to fill the gap between curve axis and vertical line axis
+        lines.Color( 0.6f, 0.6f, 0.6f, 0.025f );
+        lines.Vertex( seg[j*8+4], seg[j*8+5], -0.9f );
+        lines.Vertex( seg[j*8+6], seg[j*8+7], -0.9f );
+    }
+    lines.EndLine( );
+}
+
+// lines of a row, for each gap from the curve axis to the next axis and
+// the grey fill from the vertical axis to the curve, as x0,y0,x1,y1
+void Kmean::ElementSegments( float * elem, float * seg )
+{
     preCor = data->GetCorrelation(0,1);
     numCor = 0;
 
@@ -516,7 +639,6 @@ void Kmean::DrawElement( float * elem )
         float y1 = SCI::lerp(-rangeV, rangeV, (elem[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
         float correlation = data->GetCorrelation( d0, d1 );
         float xt, yt;
-        float err;
 
         if (preCor < 0 && correlation >= 0)
         {           
@@ -593,44 +715,90 @@ void Kmean::DrawElement( float * elem )
             xt = cub_a[j] + cub_b[j]*yt + cub_c[j]*yt*yt + cub_d[j]*yt*yt*yt + maxPoint[j];
 
 
-        if ( correlation < 0 )
-        {          
-            err = xt - xt0 - (yt0+yt1)*eleRange;
-            if(err < 0.000000000000000000000001f)
-            {
-                glVertex3f( xt, yt, -0.5f );
-                glVertex3f( xt1 , yt1, -0.5f );
-            }
-            else
-            {
-                glVertex3f( xt, yt, -0.5f );
-                glVertex3f( xt1, yt1, -0.5f );
-            }
-        }
-        if ( correlation >= 0 )
+        seg[j*8+0] = xt;
+        seg[j*8+1] = yt;
+        seg[j*8+2] = xt1;
+        seg[j*8+3] = yt1;
+        seg[j*8+4] = xt0;
+        seg[j*8+5] = yt;
+        seg[j*8+6] = xt;
+        seg[j*8+7] = yt;
+
+        preCor = correlation;
+        // end of draw grapping lines
+    }
+}
+
+// every row of the gaps through the rasters, rebuilt with the layout
+void Kmean::DrawDensity()
+{
+    // one texel per pixel of the view
+    int w = SCI::Max( 16, SCI::Min( 1024, size().width() ) );
+    int h = SCI::Max( 16, SCI::Min( 1024, size().height() ) );
+
+    SCI::UINT64 key = ElementKey();
+    if( key != densityKey || density[0].GetWidth() != w || density[0].GetHeight() != h )
+    {
+        Data::FrameArena::Scope scratch;
+        int gaps  = SCI::Max( 0, dim-1 );
+        int block = 4096;
+        Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
+        Data::FrameArena::Span<float> seg  = scratch.Alloc<float>( gaps*8 );
+        Data::FrameArena::Span<float> line = scratch.Alloc<float>( block*gaps*4 );
+        Data::FrameArena::Span<float> fill = scratch.Alloc<float>( block*gaps*4 );
+
+        density[0].Resize( w, h );
+        density[1].Resize( w, h );
+        for(int r = 0; r < data->GetElementCount(); )
         {
-            err = xt - xt0 - (yt0-yt1)*eleRange;
-            if(err < 0.000000000000000000000001f)
+            int n = 0;
+            for( ; n < block && r < data->GetElementCount(); n++, r++ )
             {
-                glVertex3f( xt, yt, -0.5f );
-                glVertex3f( xt1, yt1, -0.5f );
-            }
-            else
-            {
-                glVertex3f( xt, yt, -0.5f );
-                glVertex3f( xt1, yt1, -0.5f );
+                data->GetElement( r, elem );
+                ElementSegments( elem, seg );
+                // view coordinates [-1,1] to image coordinates [0,1]
+                for(int j = 0; j < gaps; j++)
+                {
+                    for(int c = 0; c < 4; c++)
+                    {
+                        line[(n*gaps+j)*4+c] = seg[j*8+c]*0.5f + 0.5f;
+                        fill[(n*gaps+j)*4+c] = seg[j*8+4+c]*0.5f + 0.5f;
+                    }
+                }
             }
+            density[0].AddSegments( line, n*gaps );
+            density[1].AddSegments( fill, n*gaps );
         }
 
-        // draw grey horizontal lines to fill the gap between curve axis and vertical line axis
-        glColor4f( 0.6f, 0.6f, 0.6f, 0.025f );
-        glVertex3f( xt0, yt, -0.9f );
-        glVertex3f( xt, yt, -0.9f );
+        // empty pixels stay clear, dense ones reach the colour of the lines
+        const float transfer[2][8] = { { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.8f },
+                                       { 0.6f, 0.6f, 0.6f, 0.0f, 0.6f, 0.6f, 0.6f, 0.8f } };
+        std::vector<float> intensity;
+        std::vector<SCI::UINT8> rgba;
+        for(int k = 0; k < 2; k++)
+        {
+            density[k].ToneMap( Data::DensityRaster::LOG, intensity );
+            Data::DensityRaster::Colorize( intensity, transfer[k], 2, rgba );
+            densityTex[k].TexImage2D( GL_RGBA, w, h, GL_RGBA, GL_UNSIGNED_BYTE, &rgba[0] );
+        }
+        densityKey = key;
+    }
 
-        preCor = correlation;
-        // end of draw grapping lines
+    // the fill behind the lines, at the depths of the line batches
+    const float depth[2] = { -0.5f, -0.9f };
+    glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
+    for(int k = 1; k >= 0; k--)
+    {
+        densityTex[k].Enable();
+        densityTex[k].Bind();
+        glBegin(GL_QUADS);
+            glTexCoord2f(0,0); glVertex3f( -1, -1, depth[k] );
+            glTexCoord2f(1,0); glVertex3f(  1, -1, depth[k] );
+            glTexCoord2f(1,1); glVertex3f(  1,  1, depth[k] );
+            glTexCoord2f(0,1); glVertex3f( -1,  1, depth[k] );
+        glEnd();
+        densityTex[k].Disable();
     }
-    glEnd();
 }
 
 // draw cubic curve axis PCP
@@ -646,7 +814,8 @@ void Kmean::cubicAxis()
     curvePos.clear();
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     for(int j = 0; j < (dim-1); j++)
     {
@@ -697,7 +866,8 @@ void Kmean::quadAxis()
     curvePos.clear();
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );    
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     for(int j = 0; j < (dim-1); j++)
     {
@@ -777,7 +947,8 @@ float Kmean::disPLine(float xp, float yp, float m, float n)
 // find the line that is closest with current point between selectedDim1 and selectedDim2
 void Kmean::selectedLine()
 {
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
 
     int j = selectedDim1;
@@ -875,7 +1046,8 @@ void Kmean::DrawSelectedLine()
     glLineWidth(3.0f);
     glColor3f(0,0,0);
 
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     preCor = data->GetCorrelation(0,1);
     numCor = 0;
@@ -1196,7 +1368,8 @@ void Kmean::minmaxItem(int j)
     float x0 = dimLoc[j].first;
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     xyElement(elem, 0, d0, d1, x0);
     float minx = xe;
@@ -1280,7 +1453,8 @@ void Kmean::kMeanCluster()
     bool isStillMoving = true;
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     int j = 0;
     int   d0 = dimLoc[j].second;
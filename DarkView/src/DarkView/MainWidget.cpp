@@ -17,6 +17,7 @@
 */
 
 #include <DarkView/MainWidget.h>
+#include <Data/FrameArena.h>
 
 #include <iostream>
 #include <algorithm>
@@ -34,6 +35,8 @@ MainWidget::MainWidget( QWidget *parent) : QGLWidget( QGLFormat(QGL::DoubleBuffe
     interp_points = 0;
 
     started = false;
+    scheduler = 0;
+    scheduler_view = -1;
     need_reset = false;
 
     setMouseTracking(true);
@@ -46,20 +49,29 @@ MainWidget::~MainWidget(){ }
 
 void MainWidget::Start(){
     started = true;
+    update();
 }
 
 void MainWidget::SetData( DataIndirector * _output ){
     output = _output;
     sm.Reset();
     sp.Reset();
+    update();
+}
+
+void MainWidget::SetScheduler( ProgressiveScheduler * _scheduler ){
+    scheduler = _scheduler;
+    scheduler_view = scheduler->AddView();
 }
 
 void MainWidget::resizeGL ( int , int ){
     ProgressiveReset( );
+    if( scheduler ) scheduler->Cancel( scheduler_view );
 }
 
 void MainWidget::ProgressiveReset(){
     need_reset = true;
+    update();
     /*
     sm.ProgressiveReset();
     unsigned int white = 0xffffffff;
@@ -67,6 +79,11 @@ void MainWidget::ProgressiveReset(){
     */
 }
 
+void MainWidget::SetRanking( int measure ){
+    sm.SetRanking( measure );
+    ProgressiveReset();
+}
+
 void MainWidget::initializeGL(){
     unsigned int white = 0xffffffff;
     progressive_tex.SetMinMagFilter( GL_LINEAR, GL_LINEAR );
@@ -77,6 +94,10 @@ void MainWidget::initializeGL(){
 
 void MainWidget::paintGL(){
 
+    Data::FrameArena::Scope scratch;
+
+    if( scheduler ) scheduler->BeginFrame( scheduler_view );
+
     if( need_reset )
     {
         sm.ProgressiveReset();
@@ -90,7 +111,6 @@ void MainWidget::paintGL(){
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
     if( !started ){
-        update();
         return;
     }
 
@@ -120,7 +140,8 @@ void MainWidget::paintGL(){
     glPointSize(1.0f);
 
     sm.SetMouse( (float)mouse_x/(float)width*2.0f-1.0f, 1.0f-2.0f*(float)mouse_y/(float)height );
-    if( sm.ProgressiveDraw( *output ) ){
+    bool progressing = sm.ProgressiveDraw( *output, scheduler, scheduler_view );
+    if( progressing ){
         progressive_tex.CopyTexImage2D( GL_RGBA, 0, 0, size().width(), size().height() );
     }
 
@@ -143,12 +164,18 @@ void MainWidget::paintGL(){
     sp.SetAspect( aspect );
     sp.Draw();
 
-    update();
+    // frames are drawn while rows are left, otherwise only on a change
+    if( progressing ){
+        update();
+    }
 
 }
 
 void MainWidget::UpdateSelection( std::pair<int,int> sel ){
-    cur_selection = sel;
+    if( sel != cur_selection ){
+        cur_selection = sel;
+        update();
+    }
 }
 
 void MainWidget::mouseDoubleClickEvent ( QMouseEvent * event ){
@@ -162,6 +189,7 @@ void MainWidget::mouseDoubleClickEvent ( QMouseEvent * event ){
     mouse_x = x;
     mouse_y = y;
 
+    update();
 }
 
 void MainWidget::mouseMoveEvent ( QMouseEvent * event ){
@@ -174,6 +202,7 @@ void MainWidget::mouseMoveEvent ( QMouseEvent * event ){
     mouse_x = x;
     mouse_y = y;
 
+    update();
 }
 
 void MainWidget::mousePressEvent ( QMouseEvent * event ){
@@ -187,6 +216,7 @@ void MainWidget::mousePressEvent ( QMouseEvent * event ){
     mouse_x = x;
     mouse_y = y;
 
+    update();
 }
 
 void MainWidget::mouseReleaseEvent ( QMouseEvent * event ){
@@ -200,6 +230,7 @@ void MainWidget::mouseReleaseEvent ( QMouseEvent * event ){
     mouse_x = x;
     mouse_y = y;
 
+    update();
 }
 
 void MainWidget::keyPressEvent ( QKeyEvent * ){ }
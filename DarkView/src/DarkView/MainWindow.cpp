@@ -24,9 +24,11 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QMessageBox>
+#include <QInputDialog>
 
 #include <iostream>
 #include <sstream>
+#include <float.h>
 
 
 MainWindow::MainWindow(QWidget *parent) : QT::QExtendedMainWindow(parent), indir_datafile(&datafile)
@@ -35,6 +37,12 @@ MainWindow::MainWindow(QWidget *parent) : QT::QExtendedMainWindow(parent), indir
     meth = 0;
     // data source: 1 - physic, 2 - car;
     dts = 1;
+    rank_measure = -1;
+    line_mode = ParallelCoordinates::LINES_TRENDS;
+    trend_sample = 500;
+
+    ordering = new AxisOrderingThread(this);
+    connect(ordering, SIGNAL(Improved()), this, SLOT(axesOrdered()));
 
     // Set window title
     setWindowTitle(tr("DarkView: Parameter Space Visualization Tool"));
@@ -43,6 +51,10 @@ MainWindow::MainWindow(QWidget *parent) : QT::QExtendedMainWindow(parent), indir
     file_menu = menuBar()->addMenu("&File");
     {
         file_menu->addAction( open = new QAction("&Open", this ) );
+        file_menu->addAction( open_dir = new QAction("Open &Directory", this ) );
+        file_menu->addAction( refresh = new QAction("&Refresh Shards", this ) );
+        file_menu->addAction( filter_shards = new QAction("&Filter Shards...", this ) );
+        file_menu->addAction( clear_filter = new QAction("C&lear Shard Filter", this ) );
         file_menu->addAction( copy = new QAction("&Copy Setting", this ) );
         file_menu->addSeparator();
         recent_menu = addRecentMenu( file_menu );
@@ -50,8 +62,13 @@ MainWindow::MainWindow(QWidget *parent) : QT::QExtendedMainWindow(parent), indir
         file_menu->addAction( exit = new QAction("E&xit", this ) );
 
         exit->setShortcut(tr("CTRL+X"));
+        refresh->setShortcut(tr("F5"));
 
         connect( open, SIGNAL(triggered()), this, SLOT(openFile()) );
+        connect( open_dir, SIGNAL(triggered()), this, SLOT(openDirectory()) );
+        connect( refresh, SIGNAL(triggered()), this, SLOT(refreshShards()) );
+        connect( filter_shards, SIGNAL(triggered()), this, SLOT(filterShards()) );
+        connect( clear_filter, SIGNAL(triggered()), this, SLOT(clearShardFilter()) );
         connect( copy, SIGNAL(triggered()), this, SLOT(copySettings()) );
         connect( exit, SIGNAL(triggered()), qApp, SLOT(quit())     );
     }
@@ -63,10 +80,76 @@ MainWindow::MainWindow(QWidget *parent) : QT::QExtendedMainWindow(parent), indir
         vis_meth->addAction(m1 = new QAction("&Trend Parallel Coordinates", this));
         vis_meth->addAction(m2 = new QAction("&Kmean", this));
         vis_meth->addAction(m3 = new QAction("&Scatter Plots", this));
+        vis_meth->addSeparator();
+        vis_meth->addAction(mi_color = new QAction("Color by &Mutual Information", this));
+        mi_color->setCheckable(true);
+
+        gap_menu  = vis_meth->addMenu("&Draw Gaps as");
+        gap_group = new QActionGroup(this);
+        {
+            const char * names[4] = { "&Trends", "&Binned Histograms", "&Cluster Tree", "B&undled Edges" };
+            int modes[4] = { ParallelCoordinates::LINES_TRENDS, ParallelCoordinates::LINES_BINNED, ParallelCoordinates::LINES_CLUSTERS, ParallelCoordinates::LINES_BUNDLED };
+            for(int m = 0; m < 4; m++)
+            {
+                QAction * act = new QAction( QString(names[m]), this );
+                act->setCheckable(true);
+                act->setChecked(modes[m] == line_mode);
+                act->setData(modes[m]);
+                gap_group->addAction(act);
+                gap_menu->addAction(act);
+            }
+        }
+
+        sample_menu  = vis_meth->addMenu("Fit &Trends to");
+        sample_group = new QActionGroup(this);
+        {
+            const char * names[4] = { "&500 Rows", "5&000 Rows", "50000 &Rows", "&All Rows" };
+            int rows[4] = { 500, 5000, 50000, 0 };
+            for(int m = 0; m < 4; m++)
+            {
+                QAction * act = new QAction( QString(names[m]), this );
+                act->setCheckable(true);
+                act->setChecked(rows[m] == trend_sample);
+                act->setData(rows[m]);
+                sample_group->addAction(act);
+                sample_menu->addAction(act);
+            }
+        }
+
+        rank_menu  = vis_meth->addMenu("&Rank Scatter Plots by");
+        rank_group = new QActionGroup(this);
+        for(int m = -1; m < Data::Scagnostics::MEASURE_COUNT; m++)
+        {
+            QAction * act = new QAction( ( m < 0 ) ? QString("&All Pairs") : QString( Data::Scagnostics::GetMeasureName(m) ), this );
+            act->setCheckable(true);
+            act->setChecked(m < 0);
+            act->setData(m);
+            rank_group->addAction(act);
+            rank_menu->addAction(act);
+        }
+
+        order_menu  = vis_meth->addMenu("&Order Axes by");
+        order_group = new QActionGroup(this);
+        {
+            const char * names[3] = { "&Correlation", "&Mutual Information", "Monotonic &Trend" };
+            int measures[3] = { DataIndirector::ORDER_CORRELATION, DataIndirector::ORDER_INFORMATION, DataIndirector::ORDER_TREND };
+            for(int m = 0; m < 3; m++)
+            {
+                QAction * act = new QAction( QString(names[m]), this );
+                act->setData(measures[m]);
+                order_group->addAction(act);
+                order_menu->addAction(act);
+            }
+        }
 
         connect(m1, SIGNAL(triggered()), this, SLOT(met1()));
         connect(m2, SIGNAL(triggered()), this, SLOT(met2()));
         connect(m3, SIGNAL(triggered()), this, SLOT(met3()));
+        connect(mi_color, SIGNAL(toggled(bool)), this, SLOT(colorByInformation(bool)));
+        connect(gap_group, SIGNAL(triggered(QAction*)), this, SLOT(lineMode(QAction*)));
+        connect(sample_group, SIGNAL(triggered(QAction*)), this, SLOT(trendSample(QAction*)));
+        connect(rank_group, SIGNAL(triggered(QAction*)), this, SLOT(rankPairs(QAction*)));
+        connect(order_group, SIGNAL(triggered(QAction*)), this, SLOT(orderAxes(QAction*)));
 
     }
 
@@ -101,7 +184,10 @@ MainWindow::MainWindow(QWidget *parent) : QT::QExtendedMainWindow(parent), indir
     // end Hoa -TMP
 }
 
-MainWindow::~MainWindow(){ }
+MainWindow::~MainWindow()
+{
+    ordering->Stop();
+}
 
 void MainWindow::met1()
 {
@@ -239,6 +325,107 @@ void MainWindow::openFile( )
     cursorRestore();
 }
 
+void MainWindow::openDirectory( )
+{
+    cursorOverride(Qt::WaitCursor);
+    QString dname = directoryDialog( tr("Open a directory of data files") );
+    if( dname.size() > 0 )
+    {
+        loadFile( dname );
+        updateRecentMenu( recent_menu, dname );
+    }
+    cursorRestore();
+}
+
+// Pick up shards added to an open directory or glob since it was opened;
+// their rows are added to the column histograms rather than rebinning all
+void MainWindow::refreshShards( )
+{
+    if( centralWidget() != hsplit || !datafile.isFederated() )
+        return;
+
+    ordering->Stop();
+
+    datafile.Rescan();
+    datafile.Refresh();
+    indir_datafile.Recompute();
+
+    if(meth == 1)
+    {
+        pc->SetData( &indir_datafile );
+        pc->Reset();
+    }
+    if(meth == 2)
+    {
+        km->SetData( &indir_datafile );
+        km->Reset();
+    }
+    if (meth == 3)
+    {
+        scap->SetData( &indir_datafile );
+        scap->Reset();
+    }
+
+    mw->ProgressiveReset( );
+}
+
+// Keep only the shards whose zone map on a column overlaps a range; the
+// others are released and never read while the filter stays
+void MainWindow::filterShards( )
+{
+    if( centralWidget() != hsplit || !datafile.isFederated() )
+        return;
+
+    QStringList names;
+    for(int i = 0; i < datafile.GetDim(); i++)
+        names << tr(datafile.GetLabel(i).c_str());
+
+    bool ok = false;
+    QString name = QInputDialog::getItem( this, tr("Filter Shards"), tr("Column:"), names, 0, false, &ok );
+    if( !ok )
+        return;
+    int dim = names.indexOf( name );
+    if( dim < 0 )
+        return;
+
+    // the range of the column over every shard, loaded or not
+    float lo =  FLT_MAX;
+    float hi = -FLT_MAX;
+    for(int s = 0; s < datafile.GetShardCount(); s++)
+    {
+        const Data::DataShard & shard = datafile.GetShard(s);
+        if( !shard.valid )
+            continue;
+        lo = SCI::Min( lo, shard.stats.GetMinimumValue(dim) );
+        hi = SCI::Max( hi, shard.stats.GetMaximumValue(dim) );
+    }
+    if( lo > hi )
+        return;
+
+    double from = QInputDialog::getDouble( this, tr("Filter Shards"), tr("From:"), lo, -FLT_MAX, FLT_MAX, 6, &ok );
+    if( !ok )
+        return;
+    double to = QInputDialog::getDouble( this, tr("Filter Shards"), tr("To:"), hi, -FLT_MAX, FLT_MAX, 6, &ok );
+    if( !ok )
+        return;
+
+    cursorOverride(Qt::WaitCursor);
+    datafile.SetFilter( dim, (float)from, (float)to );
+    refreshShards();
+    cursorRestore();
+}
+
+void MainWindow::clearShardFilter( )
+{
+    if( centralWidget() != hsplit || !datafile.isFederated() )
+        return;
+
+    cursorOverride(Qt::WaitCursor);
+    datafile.ClearFilter();
+    refreshShards();
+    cursorRestore();
+}
+
 void MainWindow::open_recent( QString fname )
 {
     if( fname.size() > 0 )
@@ -250,12 +437,16 @@ void MainWindow::open_recent( QString fname )
 
 void MainWindow::loadFile( QString fname ){
 
+    ordering->Stop();
+
     if( centralWidget() != hsplit )
     {
         vsplit = new QSplitter( Qt::Vertical, 0 );
         hsplit = new QSplitter( Qt::Horizontal, 0 );
 
         mw = new MainWidget( 0 );
+        mw->SetRanking( rank_measure );
+        mw->SetScheduler( &scheduler );
         //vsplit->addWidget(mw);
 
         dw = new QDimensionWidget( 0 );
@@ -266,18 +457,22 @@ void MainWindow::loadFile( QString fname ){
         if(meth == 1)
         {
             pc = new ParallelCoordinates(mw, mw->font,0);
+            pc->SetLineMode( line_mode );
+            pc->SetTrendSample( trend_sample );
             connect( pc, SIGNAL(UpdatedSelection(std::pair<int,int>)), mw, SLOT(UpdateSelection(std::pair<int,int>)) );
             vsplit->addWidget(pc);
         }
         if(meth == 2)
         {
             km = new Kmean(mw, mw->font,0);
+            km->SetScheduler( &scheduler );
             connect( km, SIGNAL(UpdatedSelection(std::pair<int,int>)), mw, SLOT(UpdateSelection(std::pair<int,int>)) );
             vsplit->addWidget(km);
         }
         if (meth == 3)
         {
             scap = new Scatter(mw, mw->font,0);
+            scap->SetScheduler( &scheduler );
             connect( scap, SIGNAL(UpdatedSelection(std::pair<int,int>)), mw, SLOT(UpdateSelection(std::pair<int,int>)) );
             vsplit->addWidget(scap);
         }
@@ -288,7 +483,24 @@ void MainWindow::loadFile( QString fname ){
     }
 
 
-    datafile.Load( fname.toLocal8Bit().data(), 0);
+    std::string path = std::string( fname.toLocal8Bit().data() );
+    if( Data::FederatedData::isPattern( path.c_str() ) )
+    {
+        // A directory or glob of shards sharing the same columns
+        datafile.Open( path.c_str() );
+    }
+    else
+    {
+        // Reuse the copy of another DarkView process if one has the file loaded,
+        // otherwise parse it and publish it for the next one
+        datafile.Close();
+        std::string segname = Data::PhysicsData::SharedName( path.c_str() );
+        if( !datafile.AttachShared( segname.c_str(), path.c_str() ) )
+        {
+            datafile.Load( path.c_str(), 0);
+            datafile.PublishShared( segname.c_str() );
+        }
+    }
     datafile.SaveMeta();
 
     indir_datafile.Recompute();
@@ -344,8 +556,92 @@ void MainWindow::loadFile( QString fname ){
     */
 }
 
+void MainWindow::colorByInformation( bool checked )
+{
+    indir_datafile.SetDependencyMeasure( checked ? DataIndirector::INFORMATION : DataIndirector::PEARSON );
+
+    // SPLOM borders and points are colored by the measure
+    if( centralWidget() == hsplit )
+        mw->ProgressiveReset( );
+}
+
+// For very many rows: every gap of the parallel coordinates is drawn from
+// a 2D histogram of its two axes, from a cut through a cluster tree of the
+// rows, or as the histogram cells bundled, at a cost independent of the
+// row count
+void MainWindow::lineMode( QAction * act )
+{
+    line_mode = act->data().toInt();
+
+    if( centralWidget() == hsplit && meth == 1 )
+        pc->SetLineMode( line_mode );
+}
+
+// Trends fit to a sample of each axis pair by default, which is quick but
+// can miss small structures; every row gives the exact fit
+void MainWindow::trendSample( QAction * act )
+{
+    trend_sample = act->data().toInt();
+
+    if( centralWidget() == hsplit && meth == 1 )
+        pc->SetTrendSample( trend_sample );
+}
+
+void MainWindow::rankPairs( QAction * act )
+{
+    rank_measure = act->data().toInt();
+
+    if( centralWidget() == hsplit )
+        mw->SetRanking( rank_measure );
+}
+
+// Start optimizing the order of the visible axes for a pair score. The
+// first order comes within a sweep and better ones follow while the
+// search runs, each shown as it arrives.
+void MainWindow::orderAxes( QAction * act )
+{
+    if( centralWidget() != hsplit )
+        return;
+
+    std::vector<int> dims;
+    for(int d = 0; d < indir_datafile.GetDim(); d++)
+    {
+        dims.push_back( indir_datafile.GetRealDimension(d) );
+    }
+
+    ordering->Order( &datafile, dims, act->data().toInt() );
+}
+
+void MainWindow::axesOrdered( )
+{
+    std::vector<int> order;
+    if( centralWidget() != hsplit || !ordering->GetOrder( order ) || !indir_datafile.SetOrder( order ) )
+        return;
+
+    if(meth == 1)
+    {
+        pc->SetData( &indir_datafile );
+        pc->Reset();
+    }
+    if(meth == 2)
+    {
+        km->SetData( &indir_datafile );
+        km->Reset();
+    }
+    if (meth == 3)
+    {
+        scap->SetData( &indir_datafile );
+        scap->Reset();
+    }
+
+    mw->ProgressiveReset( );
+}
+
 void MainWindow::UpdateItem( int idx, QString str, bool checked )
 {
+    // an order still being searched for is of the old dimensions
+    ordering->Stop();
+
     if( checked )
     {
         datafile.Enable( idx );
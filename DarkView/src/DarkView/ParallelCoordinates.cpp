@@ -17,6 +17,9 @@
 */
 
 #include <DarkView/ParallelCoordinates.h>
+#include <Data/KNearest2D.h>
+#include <Data/Cluster1D.h>
+#include <Data/FrameArena.h>
 #include <GL/oglCommon.h>
 #include <QMouseEvent>
 #include <iostream>
@@ -33,10 +36,25 @@ ParallelCoordinates::ParallelCoordinates(MainWidget *_mw, oglWidgets::oglFont &
     // number of bin
     numbin = 100;
     binrange = 0.05f;
+    densitySource = 0;
+    densityVersion = 0;
+    lineMode = LINES_TRENDS;
+    pairBins = 32;
+    clusterStamp = 0;
+    clusterBudget = 256;
+    clusterRefine = false;
+    hoverX = hoverY = 0.0f;
+    layerFrame = 0;
+    layerEpoch = 0;
+    layerX0 = layerX1 = 0.0f;
     hasNeg = 0;
     hasPos = 0;
     // k value in knn algorithm
     knum = 20;
+    trendSample = 500;
+    trendSource = 0;
+    trendVersion = 0;
+    trend = 0;
     // kcase: 1 - single K ; 2 - variation K
     kcase = 1;
     frame = 0;
@@ -158,6 +176,9 @@ ParallelCoordinates::ParallelCoordinates(MainWidget *_mw, oglWidgets::oglFont &
     data = 0;
     curDraw = 0;
     selected = -1;
+    maxAxes = 24;
+    axisFirst = 0;
+    axisSpan = 0;
     d_scale = 0.1f;
     font = &_font;
     started = false;
@@ -175,6 +196,19 @@ void ParallelCoordinates::SetData( DataIndirector * _data )
 
     if(data != 0)
     {
+        // layers are drawn again when a column's range or counts changed,
+        // not when a dimension is only shown, hidden or renamed
+        const Data::ColumnHistogram & hist = data->GetHistogram();
+        layerColumns.resize( hist.GetDimension(), 0 );
+        bool changed = false;
+        for(int r = 0; r < hist.GetDimension(); r++)
+        {
+            changed = changed || layerColumns[r] != hist.GetVersion(r);
+            layerColumns[r] = hist.GetVersion(r);
+        }
+        if( changed )
+            layerEpoch++;
+
         Reset();
         dim_min.clear();
         dim_max.clear();
@@ -196,16 +230,50 @@ void ParallelCoordinates::SetData( DataIndirector * _data )
             dim_min.push_back(minv);
             dim_max.push_back(maxv);
 
-            float loc = SCI::lerp( -1.0f, 1.0f, ((float)d+0.5f) / ((float)dim) );
-            dimLoc.push_back( std::make_pair(loc,d) );
+            dimLoc.push_back( std::make_pair(0.0f,d) );
+        }
+        ScrollAxes( axisFirst, ( axisSpan > 0 ) ? axisSpan : maxAxes );
+
+        if( lineMode == LINES_BINNED || lineMode == LINES_BUNDLED )
+        {
+            pairHists.Update( *data->data, pairBins );
+            int first, last;
+            VisibleGaps(first, last);
+            UpdatePairHistograms(first, last);
         }
+        if( lineMode == LINES_CLUSTERS )
+            UpdateClusterTree();
     }
+    update();
+}
 
+void ParallelCoordinates::SetLineMode( int mode )
+{
+    lineMode = mode;
+    if( lineMode != LINES_BINNED && lineMode != LINES_BUNDLED )
+        pairHists.Clear();
+    if( lineMode != LINES_BUNDLED )
+        bundles.clear();
+    if( data != 0 && lineMode != LINES_TRENDS )
+        SetData( data );
+    curDraw = 0;
+    update();
+}
+
+void ParallelCoordinates::SetTrendSample( int rows )
+{
+    rows = SCI::Max( 0, rows );
+    if( trendSample == rows )
+        return;
+    trendSample = rows;
+    curDraw = 0;
+    update();
 }
 
 void ParallelCoordinates::Reset()
 {
     curDraw = 0;
+    update();
 }
 
 void ParallelCoordinates::initializeGL()
@@ -321,6 +389,7 @@ void ParallelCoordinates::mousePressEvent ( QMouseEvent * event )
         stopRange = false;
         curDraw = 0;
     }
+    update();
 }
 
 void ParallelCoordinates::mouseReleaseEvent ( QMouseEvent * event )
@@ -336,7 +405,7 @@ void ParallelCoordinates::mouseReleaseEvent ( QMouseEvent * event )
         dimLoc[ selected ].first = selpx;
         std::sort( dimLoc.begin(), dimLoc.end() );
         for(int i = 0; i < dim; i++)
-            dimLoc[i].first = SCI::lerp( -1.0f, 1.0f, ((float)i+0.5f) / ((float)dim) );
+            dimLoc[i].first = AxisX(i);
         selected = -1;
         curDraw = 0;
         d_scale = 0.1f;
@@ -397,6 +466,7 @@ void ParallelCoordinates::mouseReleaseEvent ( QMouseEvent * event )
         itemEnd = selectedItem;
         stopRange = true;
     }
+    update();
 }
 
 void ParallelCoordinates::mouseMoveEvent ( QMouseEvent * event )
@@ -416,11 +486,9 @@ void ParallelCoordinates::mouseMoveEvent ( QMouseEvent * event )
             repeat = false;
             if( selected > 0 && dimLoc[ selected ].first < dimLoc[ selected-1 ].first )
             {
-                std::swap( dimLoc[ selected ], dimLoc[ selected-1 ]);
-
-                // swap two dimensions in visual data and update new data
-                data->SwapDims(selected, selected-1);
-                SetData(data);
+                // swap two dimensions in visual data, the trends of the
+                // other axis pairs stay as they are
+                SwapAxes(selected, selected-1);
                 // reset main widget for scatter matrix plot
                 mw->ProgressiveReset();
 
@@ -429,11 +497,9 @@ void ParallelCoordinates::mouseMoveEvent ( QMouseEvent * event )
             }
             if( selected < (dim-1) && dimLoc[ selected ].first > dimLoc[ selected+1 ].first )
             {
-                std::swap( dimLoc[ selected ], dimLoc[ selected+1 ]);
-
-                // swap two dimensions in visual data and update new data
-                data->SwapDims(selected, selected + 1);
-                SetData(data);
+                // swap two dimensions in visual data, the trends of the
+                // other axis pairs stay as they are
+                SwapAxes(selected, selected+1);
                 // reset main widget for scatter matrix plot
                 mw->ProgressiveReset();
 
@@ -444,7 +510,7 @@ void ParallelCoordinates::mouseMoveEvent ( QMouseEvent * event )
 
         for(int i = 0; i < dim; i++)
             if( i != selected )
-                dimLoc[i].first = SCI::lerp( -1.0f, 1.0f, ((float)i+0.5f) / ((float)dim) );
+                dimLoc[i].first = AxisX(i);
 
         curDraw = 0;
 
@@ -465,6 +531,12 @@ void ParallelCoordinates::mouseMoveEvent ( QMouseEvent * event )
                 closest_right = i;
         }
         scatter_pair = std::make_pair(dimLoc[closest_right].second, dimLoc[closest_left].second);
+
+        // the clusters under the pointer are refined
+        hoverX = selpx;
+        hoverY = -selpy;
+        if( lineMode == LINES_CLUSTERS )
+            curDraw = 0;
     }
 
     float closest_left, closest_right;
@@ -493,16 +565,65 @@ void ParallelCoordinates::mouseMoveEvent ( QMouseEvent * event )
     }
 
     emit UpdatedSelection( scatter_pair );
+    update();
+}
+
+void ParallelCoordinates::wheelEvent ( QWheelEvent * event )
+{
+    int steps = -event->delta() / 120;
+    if( steps == 0 )
+        steps = ( event->delta() > 0 ) ? -1 : 1;
+
+    // zoom about the middle of the view, or scroll
+    if( event->modifiers() & Qt::ControlModifier )
+        ScrollAxes( axisFirst - steps, axisSpan + 2*steps );
+    else
+        ScrollAxes( axisFirst + steps, axisSpan );
+}
+
+float ParallelCoordinates::AxisX(int i)
+{
+    return SCI::lerp( -1.0f, 1.0f, ((float)(i-axisFirst)+0.5f) / ((float)SCI::Max(axisSpan,1)) );
+}
+
+void ParallelCoordinates::ScrollAxes(int first, int span)
+{
+    axisSpan  = SCI::Min( SCI::Max( span, 2 ), dim );
+    axisFirst = SCI::Max( 0, SCI::Min( first, dim - axisSpan ) );
+    for(int i = 0; i < (int)dimLoc.size(); i++)
+        if( i != selected )
+            dimLoc[i].first = AxisX(i);
+
+    // keep the models a few views either way, drop the rest
+    if( dim > axisSpan )
+        DropTrends( axisFirst - 2*axisSpan, axisFirst + 3*axisSpan );
+    curDraw = 0;
+    update();
+}
+
+void ParallelCoordinates::VisibleGaps(int & first, int & last)
+{
+    first = SCI::Max( 0, axisFirst-1 );
+    last  = SCI::Min( dim-2, axisFirst+axisSpan-1 );
 }
 
 void ParallelCoordinates::Start()
 {
     started = true;
+    update();
 }
 
 void ParallelCoordinates::paintGL()
 {
+    // scratch buffers of the frame go back to the arena on return
+    Data::FrameArena::Scope scratch;
+
     glViewport( 0, 0, size().width(), size().height() );
+
+    // the last cut fit the frame time with room to spare, draw a finer one
+    if( lineMode == LINES_CLUSTERS && clusterRefine )
+        curDraw = 0;
+
     if( curDraw == 0 )
     {
         glClearColor( 1,1,1,1 );
@@ -512,16 +633,16 @@ void ParallelCoordinates::paintGL()
 
     if( !started )
     {
-        update();
         return;
     }
 
     if(data == 0 )
     {
-        update();
         return;
     }
 
+    bool prefetched = false;
+
     // draw PCP lines and labels
     glMatrixMode( GL_PROJECTION );
     glLoadIdentity();
@@ -590,64 +711,79 @@ void ParallelCoordinates::paintGL()
             colorgrPos2 = 0.8f;
         }
 
-        // knnPCA
-        if (kcase == 1)
+        // trends of the axis pairs in view, computed together before any is
+        // drawn, or in binned mode their 2D histograms
+        int gapFirst, gapLast;
+        VisibleGaps(gapFirst, gapLast);
+        if( lineMode == LINES_CLUSTERS )
         {
-            // start single K
-            for(int j = 0; j < (dim-1); j++)
+            DrawClusterGaps(gapFirst, gapLast);
+        }
+        else if( lineMode == LINES_BINNED )
+        {
+            // the pairs of a swap or a scroll are the only ones computed
+            UpdatePairHistograms(gapFirst, gapLast);
+            for(int j = gapFirst; j <= gapLast; j++)
             {
-                if(j == 0)
+                const void * joint = pairHists.GetJoint( data->GetRealDimension( dimLoc[j].second ), data->GetRealDimension( dimLoc[j+1].second ) );
+                if( !BeginLayer( j, GapLayerKey(j, LINES_BINNED, joint, pairHists.GetElementCount()) ) )
                 {
-                    numClusters = 1;
-                    numPosClusters = 2;
-                    colorgr1 = 0.2f;
-                    colorgr2 = 0.2f;
-                    colorgrPos1 = 0.2f;
-                    colorgrPos2 = 0.2f;
+                    DrawBinnedGap(j);
+                    EndLayer(j);
                 }
-                if(j == 1)
+            }
+        }
+        else if( lineMode == LINES_BUNDLED )
+        {
+            UpdatePairHistograms(gapFirst, gapLast);
+            for(int j = gapFirst; j <= gapLast; j++)
+            {
+                const Bundle * bundle = GapBundle(j);
+                if( bundle == 0 )
+                    continue;
+                if( !BeginLayer( j, GapLayerKey(j, LINES_BUNDLED, bundle, bundle->rows) ) )
                 {
-                    numClusters = 1;
-                    numPosClusters = 1;
-                    colorgr1 = 0.2f;
-                    colorgr2 = 0.2f;
-                    colorgrPos1 = 0.2f;
-                    colorgrPos2 = 0.2f;
+                    DrawBundledGap(j, *bundle);
+                    EndLayer(j);
                 }
-                if(j == 2)
+            }
+        }
+        else if (kcase == 1)
+        {
+            // start single K
+            UpdateTrends( std::vector<int>( 1, knum ), gapFirst, gapLast );
+            for(int j = gapFirst; j <= gapLast; j++)
+            {
+                TrendClusters(j, numClusters, numPosClusters);
+                colorgr1 = 0.2f;
+                colorgr2 = 0.2f;
+                colorgrPos1 = 0.2f;
+                colorgrPos2 = 0.2f;
+
+                trend = GapTrend(j, knum);
+                LoadTrend();
+                if( !BeginLayer( j, GapLayerKey(j, LINES_TRENDS, trend, knum) ) )
                 {
-                    numClusters = 2;
-                    numPosClusters = 2;
-                    colorgr1 = 0.2f;
-                    colorgr2 = 0.2f;
-                    colorgrPos1 = 0.2f;
-                    colorgrPos2 = 0.2f;
+                    clusterPos1(j, j+1, 0, 8);
+                    clusterPos2(j, j+1, 0, 9);
+                    clusterPos3(j, j+1, 0, 9);
+                    EndLayer(j);
                 }
-
-                knnPCA(j, j+1);
-                //clusterPos1(j, j+1, 0, 8);
-                clusterPos1(j, j+1, 0, 8);
-                clusterPos2(j, j+1, 0, 9);
-                clusterPos3(j, j+1, 0, 9);
-
             }
         }
         else if (kcase == 2)
         {
             // variation K
+            // each axis pair shares one neighbour search and its PCA moments
+            // over all k, every smaller neighbourhood is a prefix of the largest
+            std::vector<int> ks;
+            for (int l = 0; l < 8; l++)
+                ks.push_back( 4 << l );
+            UpdateTrends( ks, gapFirst, gapLast );
+
             for (int l = 0; l < 8; l++)
             {
-                // for negative
                 thresholdTri = ngVector[l];
-                knum = 2;
-                for(int m = 0; m <=l; m++) 
-                {
-                    knum = knum*2;
-                }
-                for(int j = 0; j < (dim-1); j++)
-                {
-                    knnPCA(j, j+1);
-                }
 
                 glBegin(GL_TRIANGLES);
 
@@ -684,11 +820,14 @@ void ParallelCoordinates::paintGL()
             }
             // end of variations K
         }
+        SweepTrends();
+        SweepContours();
+        SweepLayers();
 
         // draw grey PCP axis line from dim1 to dimN
         glLineWidth(3.0f);
         glBegin(GL_LINES);
-        for(int i = 0; i < dim; i++)
+        for(int i = gapFirst; i <= gapLast+1; i++)
         {
             glColor3f(0.6f,0.6f,0.6f);
             if(i == selected) glColor3f(1,0,0);
@@ -700,17 +839,15 @@ void ParallelCoordinates::paintGL()
 
         // draw PCP labels
         float aspect = (float)size().width()/(float)size().height();
-        for(int d = 0; d < dim; d++)
+        const float labelColor[4] = { 0.6f, 0.6f, 0.6f, 1.0f };
+        // all labels in one draw call
+        font->BeginBatch();
+        for(int d = gapFirst; d <= gapLast+1; d++)
         {
-            glPushMatrix();
-                glTranslatef( dimLoc[d].first+0.0075, 0.95f, 0 );
-                glColor3f(0.6f,0.6f,0.6f);
-                glScalef(0.02f,0.02f*aspect,0.1f);
-                glRotatef(90,0,0,-1);
-                int _d = dimLoc[d].second;
-                font->Print( data->GetLabelParsed(_d).c_str() );
-            glPopMatrix();
+            int _d = dimLoc[d].second;
+            font->Print( data->GetLabelParsed(_d).c_str(), dimLoc[d].first+0.0075f, 0.95f, 0.02f, 0.02f*aspect, 90, labelColor );
         }        
+        font->EndBatch();
         // end of draw PCP labels
 
         // save screen shoot for each value of knum
@@ -722,13 +859,21 @@ void ParallelCoordinates::paintGL()
         if(selLineRange == true)
             DrawSelectedHistogram();
     }
+    else if (kcase == 1 && lineMode == LINES_TRENDS)
+    {
+        // idle frame, the trends just out of view are filled in
+        prefetched = PrefetchTrends();
+    }
 
     if (in > frame)
         curDraw = 1;
 
 
     glDisable( GL_BLEND );
-    update();
+    // another frame only while there is more to draw or prefetch, a
+    // complete view stays on screen until something changes it
+    if( curDraw == 0 || prefetched || ( lineMode == LINES_CLUSTERS && clusterRefine ) )
+        update();
      // end of drawing elements of PCP
  }
 
@@ -763,782 +908,531 @@ void ParallelCoordinates::CreateTexture()
     delete[] colorBits;
 }
 
-// knn and PCA
-void ParallelCoordinates::knnPCA(int jd, int md)
+// cluster counts of the trends of the axis pair at j and j+1
+void ParallelCoordinates::TrendClusters(int j, int & negClusters, int & posClusters)
 {
-    // hoa test data
-    int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    //int step = 1;
-    // computer how many actual elements of each dimension
-    int nstep = SCI::Max( 1, data->GetElementCount())/step;
-    float * elem = new float[dim];
-    float * elem2 = new float[dim];
-    int d0, d1;
-    float x0, x1;
-    d0 = dimLoc[jd].second;
-    d1 = dimLoc[md].second;
-    x0 = dimLoc[jd].first;
-    x1 = dimLoc[md].first;
-
-    // knn
-    float ind = 0;
-    disKnn.clear();
-    indKnn.clear();
-    posPoints.clear();
-    negPoints.clear();
-
-    for(int i = 0; i < data->GetElementCount(); i += step )
-    {
-        data->GetElement( i, elem );
-        float y = SCI::lerp(-rangeV, rangeV, (elem[d0]-dim_min[d0])/(dim_max[d0]-dim_min[d0]));
-        float x = SCI::lerp(-rangeV, rangeV, (elem[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
-        for(int h = 0; h < data->GetElementCount(); h += step )
-        {
-            data->GetElement( h, elem2 );
-            float yf = SCI::lerp(-rangeV, rangeV, (elem2[d0]-dim_min[d0])/(dim_max[d0]-dim_min[d0]));
-            float xf = SCI::lerp(-rangeV, rangeV, (elem2[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
-            float di = sqrtf((y-yf)*(y-yf) + (x-xf)*(x-xf));
-            disKnn.push_back( std::make_pair(i, di) );
-            indKnn.push_back( std::make_pair(i, h) );
-            ind += 1;
-        }
-    }
-
-    float ns = nstep;
-    int st = 0;
-    int en = 0;
-    for(int i = 0; i < nstep; i++)
+    if(j == 0)
     {
-        en += ns;
-        for (int m = st;  m < en;  m++)
-            for (int j = m+1;  j < en;  j++)
-                if (disKnn[m].second > disKnn[j].second)
-                {
-                    std::swap(disKnn[m], disKnn[j]);
-                    std::swap(indKnn[m], indKnn[j]);
-                }
-        st = en;
-    }
-
-    // PCA
-    bool hasInts;
-    hasInts = false;
-    posints.clear();
-    posints1.clear();
-    posints2.clear();
-    negints.clear();
-    int segNum = 0;
-    eigenNeg.clear();
-    eigenNeg1.clear();
-    eigenNeg2.clear();
-    eigenNeg3.clear();
-    eigenPos.clear();
-    eigenPos1.clear();
-    eigenPos2.clear();
-
-    float cor = data->GetCorrelation(jd, md);
-    
-    // finding positive and negative groups (points and lines)
-    for(int i = 0; i < nstep; i++)
-    {
-        // process each knn group
-        data->GetElement( disKnn[i*nstep].first, elem );
-        float y = SCI::lerp(-rangeV, rangeV, (elem[d0]-dim_min[d0])/(dim_max[d0]-dim_min[d0]));
-        float x = SCI::lerp(-rangeV, rangeV, (elem[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
-        float input[knum*2];
-        input[0] = x;
-        input[1] = y;
-
-        for(int t = 0; t < (knum-1); t++)
-        {
-            data->GetElement( indKnn[i*nstep + t].second, elem );
-            float y = SCI::lerp(-rangeV, rangeV, (elem[d0]-dim_min[d0])/(dim_max[d0]-dim_min[d0]));
-            float x = SCI::lerp(-rangeV, rangeV, (elem[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
-            input[2*(t+1)] = x;
-            input[2*(t+1)+1] = y;
-        }
-        int dimN = 2;
-        int componentN = 2;
-        float mean[2];
-        float pc0[2];
-        float pc1[2];
-
-        // find PCA of each knn group
-        drPCA.Calculate( 0, input, dimN, knum, componentN );
-        drPCA.GetMeanPCA( mean );
-        drPCA.GetVectorPCA( 0, pc0 );
-        drPCA.GetVectorPCA( 1, pc1 );
-
-        // find Primary PCA vectors (xpc1, ypc1) and secondary PCA vector (xpc0, ypc0) and mean PCA vector (mean[0], mean[1])
-        float tval = 0.03f;
-        float b0, xpc0, ypc0;
-        if(pc0[0] == 0 && pc0[1] != 0)
-        {
-            xpc0 = mean[0];
-            ypc0 = mean[1] + tval;
-        }
-        if(pc0[1] == 0 && pc0[0] != 0)
-        {
-            xpc0 = mean[0] + tval;
-            ypc0 = mean[1];
-        }
-        if (pc0[0] != 0 && pc0[1] != 0)
-        {
-            b0 = pc0[0]*mean[1] - pc0[1]*mean[0];
-            xpc0 = mean[0] + tval;
-            ypc0 = (pc0[1]*xpc0 + b0)/pc0[0];
-        }
-        float b1, xpc1, ypc1;
-        if(pc1[0] == 0 && pc1[1] != 0)
-        {
-            xpc1 = mean[0];
-            ypc1 = mean[1]+tval;
-        }
-        if(pc1[1] == 0 && pc1[0] != 0)
-        {
-            xpc1 = mean[0]+tval;
-            ypc1 = mean[1];
-        }
-        if (pc1[0] != 0 && pc1[1] != 0)
-        {
-            b1 = pc1[0]*mean[1] - pc1[1]*mean[0];
-            xpc1 = mean[0]+tval;
-            ypc1 = (pc1[1]*xpc1 + b1)/pc1[0];
-        }
-
-        mean[0] = input[0];
-        mean[1] = input[1];
-
-        float eigenVal1 = dist(mean[0], mean[1], xpc1, ypc1);
-        float eigenVal0 = dist(mean[0], mean[1], xpc0, ypc0);
-        float eigenVal = 0.03f*eigenVal0/eigenVal1;
-        
-        // define groups by directions of PCA vectors
-        // find angle bewteen mean vector and primary PCA vector
-        float angl = AngleCompute(mean[0] - xpc0, mean[1] - ypc0);
-
-        if (angl <= 90 && angl >= 0)
-            segNum = 1;
-        if (angl <= 180 && angl > 90)
-            segNum = 2;
-        if (angl <= 270 && angl > 180)
-            segNum = 1;
-        if (angl <= 360 && angl > 270)
-            segNum = 2;
-
-        // find positive intersection points
-        if (segNum == 1)
-        {
-            hasPos = 1;
-            posPoints.push_back(std::make_pair(x,y));
-            // draw intersection points - primary PCA vectors
-            // contain positive intersection points
-            hasInts = false;
-            // hoa thay doi
-            //hasInts = intsComp(x0, mean[1], x1, mean[0], x0, ypc0, x1, xpc0);
-            hasInts = intsComp(x0, mean[1], x1, xpc0, x1, mean[0], x0, ypc0);
-            if (hasInts == true)
-            {
-                    posints.push_back( std::make_pair(xInts, yInts) );
-                    eigenPos.push_back(eigenVal);
-            }
-        }
-        // find negative intersection points
-        else if (segNum == 2)
-        {
-            hasNeg = 1;
-            negPoints.push_back(std::make_pair(x,y));
-            // draw intersection points - primary PCA vectors
-            // contain negative intersection points
-            hasInts = false;
-            hasInts = intsComp(x0, mean[1], x1, mean[0], x0, ypc0, x1, xpc0);
-            if (hasInts == true)
-                if (xInts < x1 && xInts > x0 && yInts < rangeV && yInts > -rangeV )
-                {
-                    negints.push_back( std::make_pair(xInts, yInts) );
-                    eigenNeg.push_back(eigenVal);
-                }
-        }
+        negClusters = 1;
+        posClusters = 2;
     }
-
-    if (cor > 0.94f)
+    else if(j == 1)
     {
-        hasNeg = 0;
-        hasPos = 1;
+        negClusters = 1;
+        posClusters = 1;
     }
-    if (cor < -0.94f)
+    else
     {
-        hasNeg = 1;
-        hasPos = 0;
+        negClusters = 2;
+        posClusters = 2;
     }
-    // start Negative Process - grouping by location
-    if(hasNeg > 0)
-    {
-        // sorting negative Points
-        for (int i=0; i < negPoints.size(); i++ )
-            for (int l=i+1; l < negPoints.size(); l++ )
-                if (negPoints[l].first < negPoints[i].first)
-                {
-                    std::swap(negPoints[l], negPoints[i]);
-                    std::swap(negints[l], negints[i]);
-                }
+}
 
-        float preX = negPoints[0].first;
-        float preY = negPoints[0].second;
-        int gr = 0;
-        stgrx = preX;
-        stgry = preY;
-        negints1.clear();
-        negints2.clear();
-        negints3.clear();
-
-        // clustering
-        // mininum value to beat (default value is bigger than data range)
-        float bnum = 10000000.0f;
-        float minum = bnum;
-        // the current mininum value
-        float distance = 0.0f;
-        int cluster = 0;
-        bool isStillMoving = true;
-
-        // start to find clustering for dim[j]
-        // initilize dataset and centroid
-        clusters.clear();
-        centroid.clear();
-
-        // find the minimum and maximum element of dimension dim[j]
-        // 1 cluster
-        if (numClusters == 0 || numClusters == 1)
-        {
-            centroid.push_back(std::make_pair(x1, (negPoints[(int)negPoints.size()-1].first + negPoints[0].first)/2));
-            hasNeg = 1;
-        }
+TrendModel::Key ParallelCoordinates::TrendKey(int j, int k)
+{
+    TrendModel::Key key;
+    key.d0 = data->GetRealDimension( dimLoc[j].second );
+    key.d1 = data->GetRealDimension( dimLoc[j+1].second );
+    key.k = k;
+    TrendClusters(j, key.negClusters, key.posClusters);
+    key.sample = trendSample;
+    return key;
+}
 
-        if(numClusters == 2)
-        {
-            centroid.push_back(std::make_pair(x1, negPoints[(int)negPoints.size()-1].first));
-            centroid.push_back(std::make_pair(x1, negPoints[0].first));
-            hasNeg = 2;
-        }
-        if(numClusters == 3)
+void ParallelCoordinates::UpdateTrends(const std::vector<int> & ks, int first, int last)
+{
+    // only the columns whose range or counts changed make their pairs stale
+    const Data::ColumnHistogram & hist = data->GetHistogram();
+    if( trendSource != &hist || trendVersion != hist.GetVersion() )
+    {
+        trendColumns.resize( hist.GetDimension(), 0 );
+        for(int r = 0; r < hist.GetDimension(); r++)
+        {
+            if( trendSource != &hist || trendColumns[r] != hist.GetVersion(r) )
+                artifacts.Touch( Data::ArtifactGraph::Key("column", r) );
+            trendColumns[r] = hist.GetVersion(r);
+        }
+        trendSource  = &hist;
+        trendVersion = hist.GetVersion();
+    }
+    InvalidateTrends();
+
+    // the pairs with missing models, and the models to fill in. The map is
+    // only changed here, the threads below each write their own models.
+    std::vector<int> pairs;
+    std::vector< std::vector<int> > pairK;
+    std::vector< std::vector<TrendModel*> > pairModels;
+    for(int j = SCI::Max(first, 0); j <= SCI::Min(last, dim-2); j++)
+    {
+        std::vector<int> kj;
+        std::vector<TrendModel*> mj;
+        for(int l = 0; l < (int)ks.size(); l++)
+        {
+            TrendModel::Key key = TrendKey(j, ks[l]);
+            trendUsed.insert( key );
+            if( trendModels.find(key) != trendModels.end() )
+                continue;
+            kj.push_back( ks[l] );
+            mj.push_back( &trendModels[key] );
+        }
+        if( kj.empty() )
+            continue;
+        pairs.push_back( j );
+        pairK.push_back( kj );
+        pairModels.push_back( mj );
+    }
+    if( pairs.empty() )
+        return;
+
+    // sample the rows of each pair
+    int step = ( trendSample > 0 ) ? SCI::Max( 1, data->GetElementCount() / trendSample ) : 1;
+    std::vector< std::vector<float> > sampleX( pairs.size() );
+    std::vector< std::vector<float> > sampleY( pairs.size() );
+    std::vector<float> cor( pairs.size() );
+    for(int p = 0; p < (int)pairs.size(); p++)
+    {
+        int d0 = dimLoc[ pairs[p] ].second;
+        int d1 = dimLoc[ pairs[p]+1 ].second;
+        for(int i = 0; i < data->GetElementCount(); i += step )
         {
-            centroid.push_back(std::make_pair(x1, negPoints[(int)negPoints.size()-1].first));
-            centroid.push_back(std::make_pair(x1, (negPoints[(int)negPoints.size()-1].first + negPoints[0].first)/2));
-            centroid.push_back(std::make_pair(x1, negPoints[0].first));
-            hasNeg = 3;
+            sampleY[p].push_back( SCI::lerp(-rangeV, rangeV, (data->GetElement(i, d0)-dim_min[d0])/(dim_max[d0]-dim_min[d0])) );
+            sampleX[p].push_back( SCI::lerp(-rangeV, rangeV, (data->GetElement(i, d1)-dim_min[d1])/(dim_max[d1]-dim_min[d1])) );
         }
+        cor[p] = data->GetCorrelation(d0, d1);
+    }
 
-        for(int i = 0; i < (int)negPoints.size(); i += 1 )
-        {
-            xe = x1;
-            ye = negPoints[i].first;
+    #pragma omp parallel for schedule(dynamic)
+    for(int p = 0; p < (int)pairs.size(); p++)
+    {
+        const std::vector<float> & x = sampleX[p];
+        const std::vector<float> & y = sampleY[p];
+        const std::vector<int> & kj = pairK[p];
+        int negClusters, posClusters;
+        TrendClusters( pairs[p], negClusters, posClusters );
 
-            minum = bnum;
+        // each group is a point and its nearest sampled points, for the largest k
+        int kmax = 2;
+        for(int l = 0; l < (int)kj.size(); l++)
+            kmax = SCI::Max( kmax, kj[l] );
 
-            for(int k = 0; k < numClusters; k++)
-            {
-                distance = dist(xe, ye, centroid[k].first, centroid[k].second);
-                //std::cout << " distance at k = " << k << " is " << distance << std::endl;
-                if(distance < minum)
-                {
-                    minum = distance;
-                    cluster = k;
-                }
-            }
-            clusters.push_back(cluster);
+        Data::KNearest2D   index;
+        std::vector<int>   neighbors;
+        std::vector<float> distance;
+        index.Build( x, y );
+        int kq = index.QueryAll( kmax-1, neighbors, distance );
 
-            // calculate new centroids
-            for(int k = 0; k < numClusters; k++)
-            {
-                float totalX = 0;
-                float totalY = 0;
-                int totalInCluster = 0;
-                for(int m = 0; m < (int)negPoints.size(); m += 1 )
-                {
-                    xe = x1;
-                    ye = negPoints[m].first;
-                    if(clusters[m] == k)
-                    {
-                        totalX += xe;
-                        totalY += ye;
-                        totalInCluster += 1;
-                    }
-                }
-                if(totalInCluster > 0)
-                {
-                    centroid[k].first = totalX/totalInCluster;
-                    centroid[k].second = totalY/totalInCluster;
-                }
-            }
-        }
+        // with several k, the moments are kept for those group sizes only
+        std::vector<int> sizes;
+        for(int l = 0; l < (int)kj.size(); l++)
+            sizes.push_back( SCI::Max( 1, SCI::Min( kj[l]-1, kq ) ) );
 
-        // keep shifting centroidss until equilibrium occurs
-        while(isStillMoving)
+        Data::LocalPCA2D pca;
+        if( kj.size() > 1 )
+            pca.Accumulate( x, y, neighbors, kq, sizes );
+        for(int l = 0; l < (int)kj.size(); l++)
         {
-            // calculate new centroids
-            for (int k = 0; k < numClusters; k++)
-            {
-                float totalX = 0;
-                float totalY = 0;
-                int totalInCluster = 0;
+            int groupSize = sizes[l];
+            if( kj.size() > 1 )
+                pca.Solve( groupSize );
+            else
+                pca.Compute( x, y, neighbors, kq );
+            pairModels[p][l]->Compute( x, y, neighbors, kq, groupSize, pca, cor[p], negClusters, posClusters, rangeV );
+        }
+    }
 
-                for(int i = 0; i < (int)negPoints.size(); i+=1)
-                {
-                    xe = x1;
-                    ye = negPoints[i].first;
-
-                    if(clusters[i] == k)
-                    {
-                        totalX += xe;
-                        totalY += ye;
-                        totalInCluster += 1;
-                    }
-                }
-                if(totalInCluster > 0)
-                {
-                    centroid[k].first = totalX/totalInCluster;
-                    centroid[k].second = totalY/totalInCluster;
-                }
-            }
+    for(int p = 0; p < (int)pairs.size(); p++)
+    {
+        int d0 = data->GetRealDimension( dimLoc[ pairs[p] ].second );
+        int d1 = data->GetRealDimension( dimLoc[ pairs[p]+1 ].second );
+        artifacts.Built( Data::ArtifactGraph::Key("pair", d0, d1), PairInputs(d0, d1) );
+    }
+}
 
-            // assign all data to the new centroids
-            isStillMoving = false;
+std::vector<std::string> ParallelCoordinates::PairInputs(int d0, int d1)
+{
+    std::vector<std::string> inputs;
+    inputs.push_back( Data::ArtifactGraph::Key("column", d0) );
+    inputs.push_back( Data::ArtifactGraph::Key("column", d1) );
+    return inputs;
+}
 
-            for(int i = 0; i < (int)negPoints.size(); i+=1)
-            {
-                xe = x1;
-                ye = negPoints[i].first;
-                minum = bnum;
-                for(int k = 0; k < numClusters; k++)
-                {
-                    distance = dist(xe, ye, centroid[k].first, centroid[k].second);
-                    if(distance < minum)
-                    {
-                        minum = distance;
-                        cluster = k;
-                    }
-                }
-                clusters[i] = cluster;
-                if(clusters[i] != cluster)
-                {
-                    clusters[i] = cluster;
-                    isStillMoving = true;
-                }
-            }
+void ParallelCoordinates::InvalidateTrends()
+{
+    std::set<const TrendModel*> gone;
+    std::map< TrendModel::Key, TrendModel >::iterator it = trendModels.begin();
+    while( it != trendModels.end() )
+    {
+        int d0 = it->first.d0;
+        int d1 = it->first.d1;
+        if( artifacts.IsStale( Data::ArtifactGraph::Key("pair", d0, d1), PairInputs(d0, d1) ) )
+        {
+            gone.insert( &it->second );
+            trendModels.erase( it++ );
         }
-        // end clustering
+        else
+            ++it;
+    }
+    ForgetTrends( gone );
+}
 
-        // init start and end points
-        stgrx2 = stgrx1 = stgrx = rangeV;
-        engrx2 = engrx1 = engrx = -rangeV;
-        stgry2 = stgry1 = stgry = -rangeV;
-        engry2 = engry1 = engry = rangeV;
+void ParallelCoordinates::DropTrends(int first, int last)
+{
+    std::set< std::pair<int,int> > keep;
+    for(int j = SCI::Max(first, 0); j <= SCI::Min(last, dim-2); j++)
+        keep.insert( std::make_pair( data->GetRealDimension( dimLoc[j].second ), data->GetRealDimension( dimLoc[j+1].second ) ) );
 
-        // find Boundary or Trend of groups
-        // find the start and end points of negative trends in PCP
-        for (int k = 0; k < numClusters; k++)
+    std::set<const TrendModel*> gone;
+    std::map< TrendModel::Key, TrendModel >::iterator it = trendModels.begin();
+    while( it != trendModels.end() )
+    {
+        if( !keep.count( std::make_pair( it->first.d0, it->first.d1 ) ) )
         {
-            // draw cluster points
-            for(int i = 0; i < (int)negPoints.size(); i+=1)
-            {
-                if (clusters[i] == 0)
-                {
-                    negints2.push_back(std::make_pair(negints[i].first, negints[i].second));
-                    eigenNeg2.push_back(eigenNeg[i]);
-
-                    if(stgrx1 > negPoints[i].first)
-                        stgrx1 = negPoints[i].first;
-                    if(engrx1 < negPoints[i].first)
-                        engrx1 = negPoints[i].first;
-
-                    if(stgry1 < negPoints[i].second)
-                        stgry1 = negPoints[i].second;
-                    if(engry1 > negPoints[i].second)
-                        engry1 = negPoints[i].second;
-                }
-                if (clusters[i] == 1)
-                {
-                    negints1.push_back(std::make_pair(negints[i].first, negints[i].second));
-                    eigenNeg1.push_back(eigenNeg[i]);
-
-                    if(stgrx > negPoints[i].first)
-                        stgrx = negPoints[i].first;
-                    if(engrx < negPoints[i].first)
-                        engrx = negPoints[i].first;
-
-                    if(stgry < negPoints[i].second)
-                        stgry = negPoints[i].second;
-                    if(engry > negPoints[i].second)
-                        engry = negPoints[i].second;
-                }
-                if (clusters[i] == 2)
-                {
-                    negints3.push_back(std::make_pair(negints[i].first, negints[i].second));
-                    eigenNeg3.push_back(eigenNeg[i]);
-
-                    if(stgrx2 > negPoints[i].first)
-                        stgrx2 = negPoints[i].first;
-                    if(engrx2 < negPoints[i].first)
-                        engrx2 = negPoints[i].first;
-
-                    if(stgry2 < negPoints[i].second)
-                        stgry2 = negPoints[i].second;
-                    if(engry2 > negPoints[i].second)
-                        engry2 = negPoints[i].second;
-                }
-            }
+            gone.insert( &it->second );
+            trendModels.erase( it++ );
         }
+        else
+            ++it;
+    }
+    ForgetTrends( gone );
+}
 
-        gr = numClusters-1;
-        // end of boundary for negative groups
+void ParallelCoordinates::SweepTrends()
+{
+    std::set<TrendModel::Key> keep;
+    keep.swap( trendUsed );
+    if( kcase == 1 && lineMode == LINES_TRENDS )
+    {
+        int first, last;
+        VisibleGaps(first, last);
+        for(int j = SCI::Max(first-axisSpan, 0); j <= SCI::Min(last+axisSpan, dim-2); j++)
+            keep.insert( TrendKey(j, knum) );
     }
-    // End Negative Process
 
-    // Start Positive Process
-    if (hasPos == 1)
+    std::set<const TrendModel*> gone;
+    std::map< TrendModel::Key, TrendModel >::iterator it = trendModels.begin();
+    while( it != trendModels.end() )
     {
-        // positive boundary and histogram contours
-        for (int k = 0; k < (int)posPoints.size(); k++)
+        if( !keep.count( it->first ) )
         {
-            float x = posPoints[k].first;
-            float y = posPoints[k].second;
-            if(minPPX > x)
-            {
-                minPPX = x;
-                minPPY = y;
-            }
-            if(maxPPY < y)
-            {
-                maxPPY = y;
-                maxPPX = x;
-            }
-        }
-        // end of process positive boundary
-
-        // draw histogram clustering
-        // clustering
-        // mininum value to beat (default value is bigger than data range)
-        float bnum = 10000000.0f;
-        float minum = bnum;
-        // the current mininum value
-        float distance = 0.0f;
-        int cluster = 0;
-        bool isStillMoving = true;
-
-        // start to find clustering for dim[j]
-        // initilize dataset and centroid
-        clusters.clear();
-        centroid.clear();
-
-        // find the minimum and maximum element of dimension dim[j]
-        // 1 cluster
-        if (numPosClusters == 0 || numPosClusters == 1)
-            centroid.push_back(std::make_pair(x1, (posPoints[(int)posPoints.size()-1].first + posPoints[0].first)/2));
-
-        if(numPosClusters == 2)
-        {
-            centroid.push_back(std::make_pair(x1, posPoints[(int)posPoints.size()-1].first));
-            centroid.push_back(std::make_pair(x1, posPoints[0].first));
-        }
-        if(numPosClusters == 3)
-        {
-            centroid.push_back(std::make_pair(x1, posPoints[(int)posPoints.size()-1].first));
-            centroid.push_back(std::make_pair(x1, (posPoints[(int)posPoints.size()-1].first + posPoints[0].first)/2));
-            centroid.push_back(std::make_pair(x1, posPoints[0].first));
+            gone.insert( &it->second );
+            trendModels.erase( it++ );
         }
+        else
+            ++it;
+    }
+    ForgetTrends( gone );
+}
 
-        for(int i = 0; i < (int)posPoints.size(); i += 1 )
-        {
-            xe = x1;
-            ye = posPoints[i].first;
+void ParallelCoordinates::ForgetTrends(const std::set<const TrendModel*> & gone)
+{
+    if( gone.empty() )
+        return;
 
-            minum = bnum;
+    // bands and contours are keyed by the model they came from
+    std::map< BoundaryKey, BoundaryStrip >::iterator b = boundaries.begin();
+    while( b != boundaries.end() )
+    {
+        if( gone.count( b->first.model ) )
+            boundaries.erase( b++ );
+        else
+            ++b;
+    }
+    std::map< ContourKey, Contour >::iterator c = contours.begin();
+    while( c != contours.end() )
+    {
+        if( gone.count( c->first.band.model ) )
+            contours.erase( c++ );
+        else
+            ++c;
+    }
+    std::map< LayerKey, Layer >::iterator l = layers.begin();
+    while( l != layers.end() )
+    {
+        if( gone.count( (const TrendModel*)l->first.source ) )
+        {
+            layerTrash.push_back( l->second.list );
+            layers.erase( l++ );
+        }
+        else
+            ++l;
+    }
+    if( gone.count( trend ) )
+        trend = 0;
+    for(int j = 0; j < (int)gaps.size(); j++)
+        if( gone.count( gaps[j].model ) )
+            gaps[j].model = 0;
+}
 
-            for(int k = 0; k < numPosClusters; k++)
-            {
-                distance = dist(xe, ye, centroid[k].first, centroid[k].second);
-                if(distance < minum)
-                {
-                    minum = distance;
-                    cluster = k;
-                }
-            }
-            clusters.push_back(cluster);
+bool ParallelCoordinates::PrefetchTrends()
+{
+    if( data == 0 || dim <= axisSpan )
+        return false;
 
-            // calculate new centroids
-            for(int k = 0; k < numPosClusters; k++)
+    // one gap per idle frame, nearest the view first
+    int first, last;
+    VisibleGaps(first, last);
+    for(int step = 1; step <= axisSpan; step++)
+    {
+        int side[2] = { last+step, first-step };
+        for(int s = 0; s < 2; s++)
+        {
+            int j = side[s];
+            if( j < 0 || j > dim-2 )
+                continue;
+            if( trendModels.find( TrendKey(j, knum) ) == trendModels.end() )
             {
-                float totalX = 0;
-                float totalY = 0;
-                int totalInCluster = 0;
-                for(int m = 0; m < (int)posPoints.size(); m += 1 )
-                {
-                    xe = x1;
-                    ye = posPoints[m].first;
-                    if(clusters[m] == k)
-                    {
-                        totalX += xe;
-                        totalY += ye;
-                        totalInCluster += 1;
-                    }
-                }
-                if(totalInCluster > 0)
-                {
-                    centroid[k].first = totalX/totalInCluster;
-                    centroid[k].second = totalY/totalInCluster;
-                }
+                UpdateTrends( std::vector<int>( 1, knum ), j, j );
+                return true;
             }
         }
+    }
+    return false;
+}
 
-        // keep shifting centroidss until equilibrium occurs
-        while(isStillMoving)
-        {
-            // calculate new centroids
-            for (int k = 0; k < numPosClusters; k++)
-            {
-                float totalX = 0;
-                float totalY = 0;
-                int totalInCluster = 0;
-
-                for(int i = 0; i < (int)posPoints.size(); i+=1)
-                {
-                    xe = x1;
-                    ye = posPoints[i].first;
-
-                    if(clusters[i] == k)
-                    {
-                        totalX += xe;
-                        totalY += ye;
-                        totalInCluster += 1;
-                    }
-                }
-                if(totalInCluster > 0)
-                {
-                    centroid[k].first = totalX/totalInCluster;
-                    centroid[k].second = totalY/totalInCluster;
-                }
-            }
+const TrendModel * ParallelCoordinates::GapTrend(int j, int k)
+{
+    TrendModel::Key key = TrendKey(j, k);
+    std::string node = Data::ArtifactGraph::Key("gap", j);
+    std::vector<std::string> inputs( 1, Data::ArtifactGraph::Key("pair", key.d0, key.d1) );
 
-            // assign all data to the new centroids
-            isStillMoving = false;
+    if( (int)gaps.size() < dim-1 )
+    {
+        Gap none;
+        none.key   = key;
+        none.model = 0;
+        gaps.resize( dim-1, none );
+    }
+    trendUsed.insert( key );
+    Gap & gap = gaps[j];
+    if( gap.model == 0 || artifacts.IsStale(node, inputs) || key < gap.key || gap.key < key )
+    {
+        gap.key   = key;
+        gap.model = &trendModels[key];
+        artifacts.Built(node, inputs);
+    }
+    return gap.model;
+}
 
-            for(int i = 0; i < (int)posPoints.size(); i+=1)
-            {
-                xe = x1;
-                ye = posPoints[i].first;
-                minum = bnum;
-                for(int k = 0; k < numPosClusters; k++)
-                {
-                    distance = dist(xe, ye, centroid[k].first, centroid[k].second);
-                    if(distance < minum)
-                    {
-                        minum = distance;
-                        cluster = k;
-                    }
-                }
-                clusters[i] = cluster;
-                if(clusters[i] != cluster)
-                {
-                    clusters[i] = cluster;
-                    isStillMoving = true;
-                }
-            }
-        }
-        // end clustering
+void ParallelCoordinates::SwapAxes(int a, int b)
+{
+    data->SwapDims(a, b);
+    std::swap( dim_min[a], dim_min[b] );
+    std::swap( dim_max[a], dim_max[b] );
+    std::swap( dimLoc[a].first, dimLoc[b].first );
+}
 
-        // init start and end points
-        minPPX2 = minPPX1 = rangeV;
-        maxPPX2 = maxPPX1 = -rangeV;
-        maxPPY2 = maxPPY1 = -rangeV;
-        minPPY2 = minPPY1 = rangeV;
+void ParallelCoordinates::LoadTrend()
+{
+    hasNeg = trend->hasNeg;
+    hasPos = trend->hasPos;
 
-        // find Boundary or Trend of groups
-        // find the start and end points of negative trends in PCP
-        for (int k = 0; k < numPosClusters; k++)
-        {
-            // draw cluster points
-            for(int i = 0; i < (int)posPoints.size(); i+=1)
-            {
-                if (clusters[i] == 0)
-                {
-                    posints1.push_back(std::make_pair(posints[i].first, posints[i].second));
-                    eigenPos1.push_back(eigenPos[i]);
-
-                    if(minPPX1 > posPoints[i].first)
-                        minPPX1 = posPoints[i].first;
-                    if(maxPPX1 < posPoints[i].first)
-                        maxPPX1 = posPoints[i].first;
-
-                    if(maxPPY1 < posPoints[i].second)
-                        maxPPY1 = posPoints[i].second;
-                    if(minPPY1 > posPoints[i].second)
-                        minPPY1 = posPoints[i].second;
-                }
-                if (clusters[i] == 1)
-                {
-                    posints2.push_back(std::make_pair(posints[i].first, posints[i].second));
-                    eigenPos2.push_back(eigenPos[i]);
+    // pairs without a trend keep the extents of the pair before
+    if(hasNeg > 0)
+    {
+        stgrx  = trend->neg[0].minX;
+        engrx  = trend->neg[0].maxX;
+        stgry  = trend->neg[0].maxY;
+        engry  = trend->neg[0].minY;
+        stgrx1 = trend->neg[1].minX;
+        engrx1 = trend->neg[1].maxX;
+        stgry1 = trend->neg[1].maxY;
+        engry1 = trend->neg[1].minY;
+        stgrx2 = trend->neg[2].minX;
+        engrx2 = trend->neg[2].maxX;
+        stgry2 = trend->neg[2].maxY;
+        engry2 = trend->neg[2].minY;
+    }
+    if(hasPos > 0)
+    {
+        minPPX1 = trend->pos[1].minX;
+        maxPPX1 = trend->pos[1].maxX;
+        maxPPY1 = trend->pos[1].maxY;
+        minPPY1 = trend->pos[1].minY;
+        minPPX2 = trend->pos[2].minX;
+        maxPPX2 = trend->pos[2].maxX;
+        maxPPY2 = trend->pos[2].maxY;
+        minPPY2 = trend->pos[2].minY;
+    }
+}
 
-                    if(minPPX2 > posPoints[i].first)
-                        minPPX2 = posPoints[i].first;
-                    if(maxPPX2 < posPoints[i].first)
-                        maxPPX2 = posPoints[i].first;
+bool ParallelCoordinates::LayerKey::operator<( const LayerKey & other ) const
+{
+    if (style != other.style) return style < other.style;
+    if (j != other.j) return j < other.j;
+    if (d0 != other.d0) return d0 < other.d0;
+    if (d1 != other.d1) return d1 < other.d1;
+    if (width != other.width) return width < other.width;
+    if (source != other.source) return source < other.source;
+    if (version != other.version) return version < other.version;
+    if (epoch != other.epoch) return epoch < other.epoch;
+    return state < other.state;
+}
 
-                    if(maxPPY2 < posPoints[i].second)
-                        maxPPY2 = posPoints[i].second;
-                    if(minPPY2 > posPoints[i].second)
-                        minPPY2 = posPoints[i].second;
+ParallelCoordinates::LayerKey ParallelCoordinates::GapLayerKey(int j, int style, const void * source, unsigned int version)
+{
+    LayerKey key;
+    key.style   = style;
+    // the trends of the first gaps are drawn each their own way
+    key.j       = ( style == LINES_TRENDS ) ? SCI::Min( j, 3 ) : 0;
+    key.d0      = data->GetRealDimension( dimLoc[j].second );
+    key.d1      = data->GetRealDimension( dimLoc[j+1].second );
+    key.width   = dimLoc[j+1].first - dimLoc[j].first;
+    key.source  = source;
+    key.version = version;
+    key.epoch   = layerEpoch;
+    if( style == LINES_TRENDS )
+        TrendState( key.state );
+    return key;
+}
 
-                }
-            }
-        }
-    }
-    // End Positive Process
-}
-
-//  Triangles algorithm for triangle ABC - alpha edges
-void ParallelCoordinates::marchingTriangles(float ax, float ay, float avalue, float bx, float by, float bvalue, float cx, float cy, float cvalue, float colgr, int posneg)
-{
-    int num = 0;
-    float x1, x2, x3, x4;
-    float y1, y2, y3, y4;
-    float r1, r2;
-    float maxV;
-
-    glBegin(GL_TRIANGLES);
-    // find which case of this triangle in 8 possible cases
-    // triangle
-    if(avalue <= thresholdTri && bvalue > thresholdTri && cvalue <= thresholdTri)
-    {
-        num = 2;
-        x1 = bx;
-        y1 = by;
-        r1 = (thresholdTri - avalue)/(bvalue - avalue);
-        r2 = (thresholdTri - cvalue)/(bvalue - cvalue);
-        x2 = (1-r1)*ax + r1*bx;
-        y2 = (1-r1)*ay + r1*by;
-        x3 = (1-r2)*cx + r2*bx;
-        y3 = (1-r2)*cy + r2*by;
-        maxV = bvalue;
-    } 
-    else if(avalue <= thresholdTri && bvalue <= thresholdTri && cvalue > thresholdTri)
-    {
-        num = 2;
-        x1 = cx;
-        y1 = cy;
-        r1 = (thresholdTri - avalue)/(cvalue - avalue);
-        r2 = (thresholdTri - bvalue)/(cvalue - bvalue);
-        x2 = (1-r1)*ax + r1*cx;
-        y2 = (1-r1)*ay + r1*cy;
-        x3 = (1-r2)*bx + r2*cx;
-        y3 = (1-r2)*by + r2*cy;
-        maxV = cvalue;
-    }
-    else if(avalue > thresholdTri && bvalue <= thresholdTri && cvalue <= thresholdTri)
-    {
-        num = 2;
-        x1 = ax;
-        y1 = ay;
-        r1 = (thresholdTri - bvalue)/(avalue - bvalue);
-        r2 = (thresholdTri - cvalue)/(avalue - cvalue);
-        x2 = (1-r1)*bx + r1*ax;
-        y2 = (1-r1)*by + r1*ay;
-        x3 = (1-r2)*cx + r2*ax;
-        y3 = (1-r2)*cy + r2*ay;
-        maxV = avalue;
-    }
-    // polygon
-    else if(avalue > thresholdTri && bvalue <= thresholdTri && cvalue > thresholdTri)
-    {
-        num = 3;
-        x1 = ax;
-        y1 = ay;
-        r1 = (thresholdTri - avalue)/(bvalue - avalue);
-        r2 = (thresholdTri - cvalue)/(bvalue - cvalue);
-        x2 = (1-r1)*ax + r1*bx;
-        y2 = (1-r1)*ay + r1*by;
-        x3 = (1-r2)*cx + r2*bx;
-        y3 = (1-r2)*cy + r2*by;
-        x4 = cx;
-        y4 = cy;
-        maxV = (avalue+cvalue)/2;
-    }
-    else if(avalue > thresholdTri && bvalue > thresholdTri && cvalue <= thresholdTri)
-    {
-        num = 3;
-        x1 = ax;
-        y1 = ay;
-        r1 = (thresholdTri - avalue)/(cvalue - avalue);
-        r2 = (thresholdTri - bvalue)/(cvalue - bvalue);
-        x2 = (1-r1)*ax + r1*cx;
-        y2 = (1-r1)*ay + r1*cy;
-        x3 = (1-r2)*bx + r2*cx;
-        y3 = (1-r2)*by + r2*cy;
-        x4 = bx;
-        y4 = by;
-        maxV = (avalue+bvalue)/2;
-    }
-    else if(avalue <= thresholdTri && bvalue > thresholdTri && cvalue > thresholdTri)
-    {
-        num = 3;
-        x1 = bx;
-        y1 = by;
-        r1 = (thresholdTri - bvalue)/(avalue - bvalue);
-        r2 = (thresholdTri - cvalue)/(avalue - cvalue);
-        x2 = (1-r1)*bx + r1*ax;
-        y2 = (1-r1)*by + r1*ay;
-        x3 = (1-r2)*cx + r2*ax;
-        y3 = (1-r2)*cy + r2*ay;
-        x4 = cx;
-        y4 = cy;
-        maxV = (bvalue+cvalue)/2;
-    }
-    else if(avalue > thresholdTri && bvalue > thresholdTri && cvalue > thresholdTri)
-    {
-        num = 2;
-        x1 = ax;
-        y1 = ay;
-        x2 = bx;
-        y2 = by;
-        x3 = cx;
-        y3 = cy;
-        maxV = (avalue+bvalue+cvalue)/3;
-    }
+void ParallelCoordinates::TrendState(std::vector<float> & state)
+{
+    float s[] = { (float)hasNeg, (float)hasPos, thresholdTri,
+                  stgrx, stgry, engrx, engry, stgrx1, stgry1, engrx1, engry1, stgrx2, stgry2, engrx2, engry2,
+                  maxPPX1, maxPPY1, minPPX1, minPPY1, maxPPX2, maxPPY2, minPPX2, minPPY2,
+                  a0, a1, a2, a3, b0, b1, b2, b3,
+                  colorgr1, colorgr2, colorgrPos1, colorgrPos2 };
+    state.assign( s, s + sizeof(s)/sizeof(float) );
+}
 
-    else
-        num = 1;
+void ParallelCoordinates::SetTrendState(const std::vector<float> & state)
+{
+    if( state.empty() )
+        return;
+    const float * s = &state[0];
+    hasNeg = (int)*s++;  hasPos = (int)*s++;  thresholdTri = *s++;
+    stgrx   = *s++;  stgry   = *s++;  engrx   = *s++;  engry   = *s++;
+    stgrx1  = *s++;  stgry1  = *s++;  engrx1  = *s++;  engry1  = *s++;
+    stgrx2  = *s++;  stgry2  = *s++;  engrx2  = *s++;  engry2  = *s++;
+    maxPPX1 = *s++;  maxPPY1 = *s++;  minPPX1 = *s++;  minPPY1 = *s++;
+    maxPPX2 = *s++;  maxPPY2 = *s++;  minPPX2 = *s++;  minPPY2 = *s++;
+    a0 = *s++;  a1 = *s++;  a2 = *s++;  a3 = *s++;
+    b0 = *s++;  b1 = *s++;  b2 = *s++;  b3 = *s++;
+    colorgr1 = *s++;  colorgr2 = *s++;  colorgrPos1 = *s++;  colorgrPos2 = *s++;
+}
 
-    float colpos;
+bool ParallelCoordinates::BeginLayer(int j, const LayerKey & key)
+{
+    glPushMatrix();
+    glTranslatef( dimLoc[j].first, 0, 0 );
 
-    if(colgr == 0.9f || colgr == 0.8f)
+    std::map< LayerKey, Layer >::iterator it = layers.find( key );
+    if( it != layers.end() )
     {
-        colpos = 0.6f;
+        glCallList( it->second.list );
+        if( key.style == LINES_TRENDS )
+            SetTrendState( it->second.state );
+        it->second.used = layerFrame;
+        glPopMatrix();
+        return true;
+    }
 
-        if(posneg == 1)
-            glColor4f(0.9f, 0.96f, 0.968f, colpos);
-        else if(posneg == 2)
-            glColor4f(1, 1, 0.92f, colpos);
+    // record the gap as if its left axis sat at x = 0
+    layerKey = key;
+    layerX0  = dimLoc[j].first;
+    layerX1  = dimLoc[j+1].first;
+    dimLoc[j].first   = 0.0f;
+    dimLoc[j+1].first = layerX1 - layerX0;
+    GLuint list = glGenLists(1);
+    if( list != 0 )
+        glNewList( list, GL_COMPILE_AND_EXECUTE );
+    Layer & layer = layers[key];
+    layer.list = list;
+    layer.used = layerFrame;
+    return false;
+}
 
-        glVertex3f(ax, ay, colgr - 0.1f);
-        glVertex3f(bx, by, colgr - 0.1f);
-        glVertex3f(cx, cy, colgr - 0.1f);
+void ParallelCoordinates::EndLayer(int j)
+{
+    Layer & layer = layers[layerKey];
+    if( layer.list != 0 )
+    {
+        glEndList();
+        if( layerKey.style == LINES_TRENDS )
+            TrendState( layer.state );
     }
     else
-    {
-        colpos = 0.1f;
+        layers.erase( layerKey );
 
-        if(posneg == 1)
-            glColor4f(0.95f, 0.96f, 0.968f, colpos);
-        else if(posneg == 2)
-            glColor4f(1, 1, 0.96f, colpos);
+    dimLoc[j].first   = layerX0;
+    dimLoc[j+1].first = layerX1;
+    glPopMatrix();
+}
 
-        glVertex3f(ax, ay, colgr);
-        glVertex3f(bx, by, colgr);
-        glVertex3f(cx, cy, colgr);
+void ParallelCoordinates::SweepContours()
+{
+    std::map< ContourKey, Contour >::iterator it = contours.begin();
+    while( it != contours.end() )
+    {
+        if( it->second.used != layerFrame )
+        {
+            contours.erase( it++ );
+            continue;
+        }
+        std::map< float, ContourLevel >::iterator l = it->second.levels.begin();
+        while( l != it->second.levels.end() )
+        {
+            if( l->second.used != layerFrame )
+                it->second.levels.erase( l++ );
+            else
+                ++l;
+        }
+        ++it;
     }
+}
 
+void ParallelCoordinates::SweepLayers()
+{
+    std::map< LayerKey, Layer >::iterator it = layers.begin();
+    while( it != layers.end() )
+    {
+        if( it->second.used != layerFrame )
+        {
+            layerTrash.push_back( it->second.list );
+            layers.erase( it++ );
+        }
+        else
+            ++it;
+    }
+    for(int i = 0; i < (int)layerTrash.size(); i++)
+        glDeleteLists( layerTrash[i], 1 );
+    layerTrash.clear();
+    layerFrame++;
+}
 
-    maxV = thresholdTri;
+bool ParallelCoordinates::BoundaryKey::operator<( const BoundaryKey & other ) const
+{
+    if (model != other.model) return model < other.model;
+    for (int i = 0; i < 4; i++)
+        if (box[i] != other.box[i]) return box[i] < other.box[i];
+    return segments < other.segments;
+}
+
+// envelope of the sampled lines of trend inside the box, computed the first time it is drawn
+const ParallelCoordinates::BoundaryStrip & ParallelCoordinates::Boundary(float startx, float engrx, float starty, float engry)
+{
+    BoundaryKey key;
+    key.model = trend;
+    key.box[0] = startx;
+    key.box[1] = engrx;
+    key.box[2] = starty;
+    key.box[3] = engry;
+    key.segments = nseg;
+
+    std::map< BoundaryKey, BoundaryStrip >::iterator it = boundaries.find(key);
+    if (it != boundaries.end())
+        return it->second;
+
+    BoundaryStrip & strip = boundaries[key];
+    trend->Envelope(startx, engrx, starty, engry, nseg, strip.first, strip.second);
+    return strip;
+}
+
+// colour of the region above thresholdTri, as in the colour maps of the legend
+void ParallelCoordinates::ContourColor(float colgr, int posneg)
+{
+    float maxV = thresholdTri;
+    float colpos;
 
     if(colgr == 0.9f || colgr == 0.8f)
         colpos = 0.8f;
@@ -1547,13 +1441,7 @@ void ParallelCoordinates::marchingTriangles(float ax, float ay, float avalue, fl
 
     if(colgr == 0.9f)
     {
-        glColor4f(1, 1, 1, 0.7f);
-        glVertex3f(ax, ay, 0.85f);
-        glVertex3f(bx, by, 0.85f);
-        glVertex3f(cx, cy, 0.85f);
-
         // colormap for brushing - green hue
-
         if(maxV < ng1)
             glColor4f(0.9686f, 0.988f, 0.96f, colpos);
         else if(maxV < ng2 && maxV >= ng1)
@@ -1620,345 +1508,202 @@ void ParallelCoordinates::marchingTriangles(float ax, float ay, float avalue, fl
                 glColor4f(0.498f, 0.153f, 0.0156f, colpos);
         }
     }
-
-    // draw triangles
-    if(num == 2)
+}
+
+bool ParallelCoordinates::ContourKey::operator<( const ContourKey & other ) const
+{
+    if (band < other.band) return true;
+    if (other.band < band) return false;
+    if (group != other.group) return group < other.group;
+    if (width != other.width) return width < other.width;
+    return rows < other.rows;
+}
+
+// field of the intersections of a trend group over a band of nseg by verseg
+// cells, made the first time the band is drawn. x is measured from the left axis.
+ParallelCoordinates::Contour & ParallelCoordinates::GetContour(const TrendModel::Group & group, int groupId, const float box[4], const std::vector<float> & top, const std::vector<float> & bottom, float width)
+{
+    ContourKey key;
+    key.band.model = trend;
+    for (int i = 0; i < 4; i++)
+        key.band.box[i] = box[i];
+    key.band.segments = nseg;
+    key.group = groupId;
+    key.width = width;
+    key.rows = verseg;
+
+    std::map< ContourKey, Contour >::iterator it = contours.find(key);
+    if (it != contours.end())
+    {
+        it->second.used = layerFrame;
+        return it->second;
+    }
+
+    Contour & contour = contours[key];
+    contour.used = layerFrame;
+
+    std::vector<float> gx, gy;
+    for (int i = 0; i <= nseg; i++)
+    {
+        for (int j = 0; j <= verseg; j++)
+        {
+            gx.push_back( width * i / nseg );
+            gy.push_back( top[i] - j*(top[i] - bottom[i])/verseg );
+        }
+    }
+    contour.mesh.SetGrid( gx, gy, nseg+1, verseg+1 );
+
+    std::vector< std::pair<float,float> > source( group.ints.size() );
+    for (int k = 0; k < (int)group.ints.size(); k++)
+        source[k] = std::make_pair( width * group.ints[k].first, group.ints[k].second );
+    contour.mesh.AddInverseDistance( source, group.radius );
+    contour.mesh.GetTriangles( contour.cells );
+
+    return contour;
+}
+
+// draw the cells of a band and the part of it above thresholdTri
+void ParallelCoordinates::DrawContour(Contour & contour, float x0, float colgr, int posneg)
+{
+    std::map< float, ContourLevel >::iterator it = contour.levels.find(thresholdTri);
+    if (it == contour.levels.end())
+    {
+        it = contour.levels.insert( std::make_pair( thresholdTri, ContourLevel() ) ).first;
+        contour.mesh.Extract( thresholdTri, it->second.vertices, it->second.indices );
+    }
+    it->second.used = layerFrame;
+    const ContourLevel & level = it->second;
+    const std::vector<float> & cellVertices = contour.mesh.GetVertices();
+    if (contour.cells.empty())
+        return;
+
+    glEnableClientState( GL_VERTEX_ARRAY );
+
+    // background cells
+    float z = colgr;
+    if(colgr == 0.9f || colgr == 0.8f)
+    {
+        if(posneg == 1)
+            glColor4f(0.9f, 0.96f, 0.968f, 0.6f);
+        else if(posneg == 2)
+            glColor4f(1, 1, 0.92f, 0.6f);
+        z = colgr - 0.1f;
+    }
+    else
     {
-        glVertex3f(x1, y1, colgr);
-        glVertex3f(x2, y2, colgr);
-        glVertex3f(x3, y3, colgr);
+        if(posneg == 1)
+            glColor4f(0.95f, 0.96f, 0.968f, 0.1f);
+        else if(posneg == 2)
+            glColor4f(1, 1, 0.96f, 0.1f);
     }
-    // draw polygon
-    else if(num == 3)
+    glPushMatrix();
+        glTranslatef( x0, 0, z );
+        glVertexPointer( 2, GL_FLOAT, 0, &cellVertices[0] );
+        glDrawElements( GL_TRIANGLES, (GLsizei)contour.cells.size(), GL_UNSIGNED_INT, &contour.cells[0] );
+    glPopMatrix();
+
+    if(colgr == 0.9f)
     {
-        glVertex3f(x1, y1, colgr);
-        glVertex3f(x2, y2, colgr);
-        glVertex3f(x3, y3, colgr);
+        glColor4f(1, 1, 1, 0.7f);
+        glPushMatrix();
+            glTranslatef( x0, 0, 0.85f );
+            glDrawElements( GL_TRIANGLES, (GLsizei)contour.cells.size(), GL_UNSIGNED_INT, &contour.cells[0] );
+        glPopMatrix();
+    }
 
-        glVertex3f(x1, y1, colgr);
-        glVertex3f(x4, y4, colgr);
-        glVertex3f(x3, y3, colgr);
+    // region above the threshold
+    if (!level.indices.empty())
+    {
+        ContourColor(colgr, posneg);
+        glPushMatrix();
+            glTranslatef( x0, 0, colgr );
+            glVertexPointer( 2, GL_FLOAT, 0, &level.vertices[0] );
+            glDrawElements( GL_TRIANGLES, (GLsizei)level.indices.size(), GL_UNSIGNED_INT, &level.indices[0] );
+        glPopMatrix();
     }
 
-    glEnd();
+    glDisableClientState( GL_VERTEX_ARRAY );
 }
-//end of marching triangle - threshold edges
 
 // draw boundary for negative group
 void ParallelCoordinates::DrawBoundary(int d0, int d1, float x0, float x1, float startx, float engrx, float starty, float engry, int numgr, float colgr)
 {
-    int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    //int step = 1;
-    float * elem3 = new float[dim];
-    float px1, py1, px2, py2, ey1, ey2;
-    float pj1_value, pj2_value, pre_pj1_value, pre_pj2_value, ey1_value, ey2_value;
-    float xmid = 0.0f;
-    float ymid = 0.0f;
-    ey1 = 0.0f;
-    ey2 = 0.0f;
+    if (trend == 0)
+        return;
 
-    // max point
-    px1 = x0;
-    py1 = starty;
-    // min point
-    ey1 = engry;
+    // upper and lower boundary of the lines in the box, from the box on the
+    // left axis to its x range on the right one
+    const BoundaryStrip & strip = Boundary(startx, engrx, starty, engry);
+    std::vector<float> top( strip.first );
+    std::vector<float> bottom( strip.second );
+    top[0] = starty;
+    bottom[0] = engry;
+    top[nseg] = engrx;
+    bottom[nseg] = startx;
+
+    // draw boundary lines
+    if(colgr == 0.9f || colgr == 0.8f)
+        glLineWidth( 3.0f );
+    else
+        glLineWidth( 1.0f );
+
+    glBegin(GL_LINES);
 
-    bool hasint = false;
-    hasint = intsComp(x0, starty, x1, startx, x0, engry, x1, engrx);
-    if(hasint == true)
+    if(colgr == 0.9f || colgr == 0.8f)
+    {
+        glColor4f(0.58f,0,0.85f, 0.7f);
+        if(colgr == 0.9f)
+            glColor4f(0,1,0, 0.7f);
+    }
+    else if(colgr == 0.2f)
+    {
+        glColor4f(0,0.265f,0.11f, 0.7f);
+    }
+    else if(colgr == 0.5f)
     {
-        xmid = xInts;
-        ymid = yInts;
+        glColor4f(0.77f, 0.11f, 0.49f, 0.7f);
     }
 
     for(int i = 1; i <= nseg; i++)
     {
-        px2 = x0 + i*(x1 - x0)/nseg;
-
-        py2 = -1.0f;
-        ey2 = 1.0f;
-
-        // start finding upper and lower intersection points for boundary
-        for(int k = 0; k < data->GetElementCount(); k += step )
-        {
-            data->GetElement( k, elem3 );
-            float y = SCI::lerp(-rangeV, rangeV, (elem3[d0]-dim_min[d0])/(dim_max[d0]-dim_min[d0]));
-            float x = SCI::lerp(-rangeV, rangeV, (elem3[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
-
-            // find max point (py2) and min point (ey2)
-            if ((x >= startx) && (x <= engrx) && (y <= starty) && (y >= engry))
-            {
-                hasint = false;
-                // finding intersection points between two lines: ((x0,y)&(x1,x)) and ((px2,rangeV)&(px2,-rangeV))
-                hasint = intsComp(x0, y, x1, x, px2, 1.0f, px2, -1.0f);
-
-                if (hasint == true)
-                {
-                    if(py2 < yInts)
-                        py2 = yInts;
-                    if(ey2 > yInts)
-                        ey2 = yInts;
-                }
-            }
-        }
-
-        if(i == nseg)
-        {
-            py2 = engrx;
-            ey2 = startx;
-        }
-        // end of finding boundary polygon (px1, py1) & (px2, py2) & (px2, ey2) & (px1, ey1)
-        // draw boundary lines: ((px1, py1) & (px2, py2)) and ((px2, ey2) & (px1, ey1))
-
-        if(colgr == 0.9f || colgr == 0.8f)
-            glLineWidth( 3.0f );
-        else
-            glLineWidth( 1.0f );
-
-        glBegin(GL_LINES);
-
-        if(colgr == 0.9f || colgr == 0.8f)
-        {
-            glColor4f(0.58f,0,0.85f, 0.7f);
-            if(colgr == 0.9f)
-                glColor4f(0,1,0, 0.7f);
-        }
-        else if(colgr == 0.2f)
-        {
-            glColor4f(0,0.265f,0.11f, 0.7f);
-        }
-        else if(colgr == 0.5f)
-        {
-            glColor4f(0.77f, 0.11f, 0.49f, 0.7f);
-        }
-
-        glVertex3f(px1, py1, colgr+0.05f);
-        glVertex3f(px2, py2, colgr+0.05f);
-
-        glVertex3f(px1, ey1, colgr+0.05f);
-        glVertex3f(px2, ey2, colgr+0.05f);
-        glEnd();
-        glLineWidth( 1.0f );
-        // end drawing boundary lines
-
-        // marching triangles for polygon (px1, py1) & (px2, py2) & (px2, ey2) & (px1, ey1)
-        float pyj1 = py1;
-        float pyj2 = py2;
-        int si;
-        float x, y;
-
-        if(px1 >= xmid)
-            verseg += 1;
-        else
-            verseg -= 1;
-
-        for (int j = 1; j <= verseg; j++)
-        {
-            float pre_pyj1 = pyj1;
-            float pre_pyj2 = pyj2;
-            pj1_value = 0.0f;
-            pj2_value = 0.0f;
-            pre_pj1_value = 0.0f;
-            pre_pj2_value = 0.0f;
-            ey1_value = 0.0f;
-            ey2_value = 0.0f;
-
-            pyj1 = py1 - j*(py1 - ey1)/verseg;
-            if(px1 < xmid)
-                pyj2 = py2 - j*(py2 - ey2)/(verseg-1);
-            else
-                pyj2 = py2 - j*(py2 - ey2)/(verseg+1);
-
-            if(numgr == 0)
-                si = (int)negints1.size();
-            else if (numgr == 1)
-                si = (int)negints2.size();
-            else if (numgr == 2)
-                si = (int)negints3.size();
-
-            for (int k = 0; k < si; k++)
-            {
-                if(numgr == 0)
-                {
-                    x = negints1[k].first;
-                    y = negints1[k].second;
-                    rad = eigenNeg1[k];
-                }
-                else if (numgr == 1)
-                {
-                    x = negints2[k].first;
-                    y = negints2[k].second;
-                    rad = eigenNeg2[k];
-                }
-                else if (numgr == 2)
-                {
-                    x = negints3[k].first;
-                    y = negints3[k].second;
-                    rad = eigenNeg3[k];
-                }
-                // compute value of vertices
-                float dis = (float)sqrt((px1 - x)*(px1 - x) + (pyj1 - y)*(pyj1 - y));
-                if (dis < rad)
-                    pj1_value += 1/dis;
-                dis = (float)sqrt((px2 - x)*(px2 - x) + (pyj2 - y)*(pyj2 - y));
-                if (dis < rad)
-                    pj2_value += 1/dis;
-
-                dis = (float)sqrt((px1 - x)*(px1 - x) + (pre_pyj1 - y)*(pre_pyj1 - y));
-                if (dis < rad)
-                    pre_pj1_value += 1/dis;
-                dis = (float)sqrt((px2 - x)*(px2 - x) + (pre_pyj2 - y)*(pre_pyj2 - y));
-                if (dis < rad)
-                    pre_pj2_value += 1/dis;
-
-                dis = (float)sqrt((px1 - x)*(px1 - x) + (ey1 - y)*(ey1 - y));
-                if (dis < rad)
-                    ey1_value += 1/dis;
-                dis = (float)sqrt((px2 - x)*(px2 - x) + (ey2 - y)*(ey2 - y));
-                if (dis < rad)
-                    ey2_value += 1/dis;
-                // end computing value of vertices
-            }
-
-            // start marching triangles
-            if(px1 < xmid)
-            {
-                marchingTriangles(px1, pre_pyj1, pre_pj1_value, px2, pre_pyj2, pre_pj2_value, px2, pyj2, pj2_value, colgr, 1);
-                marchingTriangles(px2, pyj2, pj2_value, px1, pre_pyj1, pre_pj1_value, px1, pyj1, pj1_value, colgr, 1);
-            }
-            else
-            {
-                marchingTriangles(px1, pre_pyj1, pre_pj1_value, px2, pre_pyj2, pre_pj2_value, px1, pyj1, pj1_value, colgr, 1);
-                marchingTriangles(px2, pyj2, pj2_value,  px2, pre_pyj2, pre_pj2_value, px1, pyj1, pj1_value, colgr, 1);
-            }
-            // end marching triangles
-            if (px1 < xmid && j == verseg - 1)
-                j += 2;
-        }
+        float px1 = x0 + (i-1)*(x1 - x0)/nseg;
+        float px2 = x0 + i*(x1 - x0)/nseg;
 
-        if (px1 < xmid)
-            marchingTriangles(px1, ey1, ey1_value, px1, pyj1, pj1_value, px2, pyj2, pj2_value, colgr, 1);
-        else
-            marchingTriangles(px2, ey2, ey2_value, px1, pyj1, pj1_value, px2, pyj2, pj2_value, colgr, 1);
+        glVertex3f(px1, top[i-1], colgr+0.05f);
+        glVertex3f(px2, top[i], colgr+0.05f);
 
-        // save values of boundary points for next process
-        px1 = px2;
-        py1 = py2;
-        ey1 = ey2;
+        glVertex3f(px1, bottom[i-1], colgr+0.05f);
+        glVertex3f(px2, bottom[i], colgr+0.05f);
     }
+    glEnd();
+    glLineWidth( 1.0f );
+    // end drawing boundary lines
+
+    // contours of the intersections inside the boundary
+    float box[4] = { startx, engrx, starty, engry };
+    DrawContour( GetContour(trend->neg[numgr], numgr, box, top, bottom, x1 - x0), x0, colgr, 1 );
 }
 //end drawBoundary
 
 // draw boundary for positive group
 void ParallelCoordinates::DrawPosBoundary(int d0, int d1, float x0, float x1, float maxX, float minX, float maxY, float minY, float colgr, int grnum)
 {
-    float px1, py1, px2, py2, ey1, ey2;
-    float pj1_value, pj2_value, pre_pj1_value, pre_pj2_value, ey1_value, ey2_value;
-    ey1 = 0.0f;
-    ey2 = 0.0f;
-
-    // max point
-    px1 = x0;
-    py1 = maxY;
-    // min point
-    ey1 = minY;
+    if (trend == 0)
+        return;
 
-    for(int i = 1; i <= nseg; i++)
+    // straight boundary from (maxY, minY) on the left axis to (maxX, minX) on the right one
+    std::vector<float> top( nseg+1 );
+    std::vector<float> bottom( nseg+1 );
+    for(int i = 0; i <= nseg; i++)
     {
-        px2 = x0 + i*(x1 - x0)/nseg;
-
-        // finding intersection points between two lines
-        bool hasint = intsComp(x0, maxY, x1, maxX, px2, 1.0f, px2, -1.0f);
-        py2 = yInts;
-
-        bool hasint1 = intsComp(x0, minY, x1, minX, px2, 1.0f, px2, -1.0f);
-        ey2 = yInts;
-
-        if(i == nseg)
-        {
-            py2 = maxX;
-            ey2 = minX;
-        }
-        // end of finding boundary polygon (px1, py1) & (px2, py2) & (px2, ey2) & (px1, ey1)
-
-        // marching triangles for polygon (px1, py1) & (px2, py2) & (px2, ey2) & (px1, ey1)
-        float pyj1 = py1;
-        float pyj2 = py2;
-        int si;
-        float x, y;
-
-        for (int j = 1; j <= verseg; j++)
-        {
-            float pre_pyj1 = pyj1;
-            float pre_pyj2 = pyj2;
-            pj1_value = 0.0f;
-            pj2_value = 0.0f;
-            pre_pj1_value = 0.0f;
-            pre_pj2_value = 0.0f;
-            ey1_value = 0.0f;
-            ey2_value = 0.0f;
-
-            pyj1 = py1 - j*(py1 - ey1)/verseg;
-            pyj2 = py2 - j*(py2 - ey2)/verseg;
-
-            if (grnum == 0)
-                si = (int)posints.size();
-            if (grnum == 1)
-                si = (int)posints1.size();
-            if (grnum == 2)
-                si = (int)posints2.size();
-
-            for (int k = 0; k < si; k++)
-            {
-                if(grnum == 0)
-                {
-                    x = posints[k].first;
-                    y = posints[k].second;
-                    rad = eigenPos[k];
-                }
-                if(grnum == 1)
-                {
-                    x = posints1[k].first;
-                    y = posints1[k].second;
-                    rad = eigenPos1[k];
-                }
-                if(grnum == 2)
-                {
-                    x = posints2[k].first;
-                    y = posints2[k].second;
-                    rad = eigenPos2[k];
-                }
-                // compute value of vertices
-                float dis = (float)sqrt((px1 - x)*(px1 - x) + (pyj1 - y)*(pyj1 - y));
-                if (dis < rad)
-                    pj1_value += 1/dis;
-                dis = (float)sqrt((px2 - x)*(px2 - x) + (pyj2 - y)*(pyj2 - y));
-                if (dis < rad)
-                    pj2_value += 1/dis;
-
-                dis = (float)sqrt((px1 - x)*(px1 - x) + (pre_pyj1 - y)*(pre_pyj1 - y));
-                if (dis < rad)
-                    pre_pj1_value += 1/dis;
-                dis = (float)sqrt((px2 - x)*(px2 - x) + (pre_pyj2 - y)*(pre_pyj2 - y));
-                if (dis < rad)
-                    pre_pj2_value += 1/dis;
-
-                dis = (float)sqrt((px1 - x)*(px1 - x) + (ey1 - y)*(ey1 - y));
-                if (dis < rad)
-                    ey1_value += 1/dis;
-                dis = (float)sqrt((px2 - x)*(px2 - x) + (ey2 - y)*(ey2 - y));
-                if (dis < rad)
-                    ey2_value += 1/dis;
-            }
-            marchingTriangles(px1, pre_pyj1, pre_pj1_value, px2, pre_pyj2, pre_pj2_value, px2, pyj2, pj2_value, colgr, 2);
-            marchingTriangles(px2, pyj2, pj2_value, px1, pre_pyj1, pre_pj1_value, px1, pyj1, pj1_value, colgr, 2);
-        }
-        
-        // save values of boundary points for next process
-        px1 = px2;
-        py1 = py2;
-        ey1 = ey2;
+        top[i] = SCI::lerp(maxY, maxX, (float)i/nseg);
+        bottom[i] = SCI::lerp(minY, minX, (float)i/nseg);
     }
+    top[nseg] = maxX;
+    bottom[nseg] = minX;
+
+    float box[4] = { maxX, minX, maxY, minY };
+    DrawContour( GetContour(trend->pos[grnum], 3 + grnum, box, top, bottom, x1 - x0), x0, colgr, 2 );
 }
 //end draw pos Boundary
 
@@ -1998,32 +1743,6 @@ bool ParallelCoordinates::intsComp(float x1, float y1, float x2, float y2, float
     }
 }
 
-// compute angle based on x and y coordinates
-float ParallelCoordinates::AngleCompute(float xs, float ys)
-{
-    float sA = 0.0f;
-    float pi = 3.14159265f;
-
-    if (xs <0 && ys <0)
-    {
-        sA = atan(fabsf(ys/xs))*180/pi;
-    }
-    else if (xs > 0 && ys <0)
-    {
-        sA = 180 - (atan(fabsf(ys/xs))*180/pi);
-    }
-    else if(xs >0 && ys >0)
-    {
-        sA = (atan(fabsf(ys/xs))*180/pi) + 180;
-    }
-    else if (xs <0 && ys >0)
-    {
-        sA = 360 - (atan(fabsf(ys/xs))*180/pi);
-    }
-    return sA;
-}
-// end of angleCompute
-
 // determine point inside triangle or not
 bool ParallelCoordinates::point_in_tri(float sx, float sy, float ax, float ay, float bx, float by, float cx, float cy)
 {
@@ -2055,7 +1774,8 @@ void ParallelCoordinates::saveScreenshot()
 // select line
 void ParallelCoordinates::selectedLine()
 {
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
     int j = selectedDim1;
     int d0, d1;
@@ -2116,7 +1836,8 @@ void ParallelCoordinates::DrawSelectedLine()
     glBegin(GL_LINES);
     glLineWidth(3.0f);
     glColor4f(0.0f,1.0f,0.0f, 0.7f);
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     for(int j = 0; j < (dim-1); j++)
     {
@@ -2140,7 +1861,8 @@ void ParallelCoordinates::DrawSelectedLine()
 // draw the selected lines
 void ParallelCoordinates::DrawSelectedHistogram(int jd0, int jd1)
 {
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     int d0, d1;
     float x0, x1;
@@ -2212,7 +1934,8 @@ void ParallelCoordinates::DrawSelectedHistogram(int jd0, int jd1)
 
 void ParallelCoordinates::clusterPos1(int jd0, int jd1, int itStart, int itEnd)
 {
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     int d0, d1;
     float x0, x1;
@@ -2300,7 +2023,8 @@ void ParallelCoordinates::clusterPos1(int jd0, int jd1, int itStart, int itEnd)
 
 void ParallelCoordinates::clusterPos2(int jd0, int jd1, int itStart, int itEnd)
 {
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     int d0, d1;
     float x0, x1;
@@ -2395,7 +2119,8 @@ void ParallelCoordinates::clusterPos2(int jd0, int jd1, int itStart, int itEnd)
 
 void ParallelCoordinates::clusterPos3(int jd0, int jd1, int itStart, int itEnd)
 {
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     int d0, d1;
     float x0, x1;
@@ -2515,7 +2240,8 @@ void ParallelCoordinates::minmaxItem(int j)
     float x1 = dimLoc[j+1].first;
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     xyElement(elem, 0, d0, d1, x1);
     float minx = xe;
@@ -2575,163 +2301,46 @@ void ParallelCoordinates::xyElement(float * elem, int i, int d0, int d1, float x
 
 
 // find clustering
+// the points of pair j all sit on the right axis, so only their value on
+// the left axis separates them: cluster it exactly, clusters numbered
+// from the lowest value up
 void ParallelCoordinates::kMeanCluster(int j)
 {
-    // mininum value to beat (default value is bigger than data range)
-    float bnum = 10000000.0f;
-    float minum = bnum;
-    // the current mininum value
-    float distance = 0.0f;
-    int cluster = 0;
-    bool isStillMoving = true;
-
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     int   d0 = dimLoc[j].second;
     int   d1 = dimLoc[j+1].second;
-    float x0 = dimLoc[j].first;
     float x1 = dimLoc[j+1].first;
 
-    // start to find clustering for dim[j]
-    // initilize dataset and centroid
-    clusters.clear();
-    centroid.clear();
-
-    // find the minimum and maximum element of dimension dim[j]
-    minmaxItem(j);
-
-    // 1 cluster
-    if (numClusters == 0 || numClusters == 1)
-        centroid.push_back(std::make_pair((maxElemX+minElemX)/2, (maxElemY+minElemY)/2));
-    // 2 cluster
-    if(numClusters == 2)
-    {
-        centroid.push_back(std::make_pair(minElemX, minElemY));
-        centroid.push_back(std::make_pair(maxElemX, maxElemY));
-    }
-    //  > 2 clusters
-    if (numClusters > 2)
-    {
-        centroid.push_back(std::make_pair(minElemX, minElemY));
-
-        for (int m = 2; m < numClusters; m++)
-        {
-            float xcen = (m-1)*(maxElemX+minElemX)/(numClusters-1);
-            float ycen = (m-1)*(maxElemY+minElemY)/(numClusters-1);
-            centroid.push_back(std::make_pair(xcen, ycen));
-        }
-        centroid.push_back(std::make_pair(maxElemX, maxElemY));
-    }
-
-
+    std::vector<float> values;
     for(int i = 0; i < data->GetElementCount(); i += step )
     {
-        // find (xe, ye) point of data item i
         xyElement(elem, i, d0, d1, x1);
-
-        minum = bnum;
-
-        for(int k = 0; k < numClusters; k++)
-        {
-            distance = dist(xe, ye, centroid[k].first, centroid[k].second);
-            if(distance < minum)
-            {
-                minum = distance;
-                cluster = k;
-            }
-        }
-        clusters.push_back(cluster);
-
-        // calculate new centroids
-        for(int k = 0; k < numClusters; k++)
-        {
-            float totalX = 0;
-            float totalY = 0;
-            int totalInCluster = 0;
-            for(int m = 0; m < i; m += step )
-            {
-                xyElement(elem, m, d0, d1, x1);
-                if(clusters[m] == k)
-                {
-                    totalX += xe;
-                    totalY += ye;
-                    totalInCluster += 1;
-                }
-            }
-            if(totalInCluster > 0)
-            {
-                centroid[k].first = totalX/totalInCluster;
-                centroid[k].second = totalY/totalInCluster;
-            }
-        }
+        values.push_back(xe);
     }
 
-    // keep shifting centroidss until equilibrium occurs
-    while(isStillMoving)
-    {
-        // calculate new centroids
-        for (int k = 0; k < numClusters; k++)
-        {
-            float totalX = 0;
-            float totalY = 0;
-            int totalInCluster = 0;
-
-            for(int i = 0; i < data->GetElementCount(); i+=step)
-            {
-                xyElement(elem, i, d0, d1, x1);
-                if(clusters[i] == k)
-                {
-                    totalX += xe;
-                    totalY += ye;
-                    totalInCluster += 1;
-                }
-            }
-            if(totalInCluster > 0)
-            {
-                centroid[k].first = totalX/totalInCluster;
-                centroid[k].second = totalY/totalInCluster;
-            }
-        }
-
-        // assign all data to the new centroids
-        isStillMoving = false;
+    Data::Cluster1D clustering;
+    clustering.Compute(values, SCI::Max(1, numClusters));
+    clusters = clustering.GetLabels();
 
-        for(int i = 0; i < data->GetElementCount(); i+=step)
-        {
-            xyElement(elem, i, d0, d1, x1);
-            minum = bnum;
-            for(int k = 0; k < numClusters; k++)
-            {
-                distance = dist(xe, ye, centroid[k].first, centroid[k].second);
-                if(distance < minum)
-                {
-                    minum = distance;
-                    cluster = k;
-                }
-            }
-            clusters[i] = cluster;
-            if(clusters[i] != cluster)
-            {
-                clusters[i] = cluster;
-                isStillMoving = true;
-            }
-        }
-    }
-    // end finding clustering
+    centroid.clear();
+    for (int k = 0; k < clustering.GetClusterCount(); k++)
+        centroid.push_back(std::make_pair(clustering.GetCenter(k), x1));
 
     // draw the clustering result
-    for (int k = 0; k < numClusters; k++)
+    for (int k = 0; k < (int)centroid.size(); k++)
     {
         // draw cluster points
-        for(int i = 0; i < data->GetElementCount(); i+=step)
+        for(int s = 0; s < (int)clusters.size(); s++)
         {
-            xyElement(elem, i, d0, d1, x1);
+            xyElement(elem, s*step, d0, d1, x1);
 
             glPointSize( 5.0 );
             glBegin(GL_POINTS);
 
-            if (clusters[i] == 0)
+            if (clusters[s] == 0)
             {
                 glPointSize( 5.0 );
                 glBegin(GL_POINTS);
@@ -2739,7 +2348,7 @@ void ParallelCoordinates::kMeanCluster(int j)
                 glVertex3f(ye, xe, -0.5f);
                 glEnd();
             }
-            if (clusters[i] == 1)
+            if (clusters[s] == 1)
             {
                 glPointSize( 5.0 );
                 glBegin(GL_POINTS);
@@ -2747,7 +2356,7 @@ void ParallelCoordinates::kMeanCluster(int j)
                 glVertex3f(ye, xe, -0.5f);
                 glEnd();
             }
-            if (clusters[i] == 2)
+            if (clusters[s] == 2)
             {
                 glPointSize( 5.0 );
                 glBegin(GL_POINTS);
@@ -2755,7 +2364,7 @@ void ParallelCoordinates::kMeanCluster(int j)
                 glVertex3f(ye, xe, -0.5f);
                 glEnd();
             }
-            if (clusters[i] == 3)
+            if (clusters[s] == 3)
             {
                 glPointSize( 5.0 );
                 glBegin(GL_POINTS);
@@ -2763,7 +2372,7 @@ void ParallelCoordinates::kMeanCluster(int j)
                 glVertex3f(ye, xe, -0.5f);
                 glEnd();
             }
-            if (clusters[i] == 4)
+            if (clusters[s] == 4)
             {
                 glPointSize( 5.0 );
                 glBegin(GL_POINTS);
@@ -2772,10 +2381,10 @@ void ParallelCoordinates::kMeanCluster(int j)
                 glEnd();
             }
 
-            if(clusters[i] > 4)
+            if(clusters[s] > 4)
             {
                 SCI::Vex3 cor_color;
-                cor_color = (clusters[i])*SCI::Vex3(0.1f,0.1f,0.01f);
+                cor_color = (clusters[s])*SCI::Vex3(0.1f,0.1f,0.01f);
                 glColor3f( cor_color.x, cor_color.y, cor_color.z );
 
                 glVertex3f(ye, xe, -0.5f);
@@ -2794,132 +2403,351 @@ void ParallelCoordinates::kMeanCluster(int j)
 
 void ParallelCoordinates::histCurve()
 {
-    int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    // the curves only change with the histograms, not per frame
+    const Data::ColumnHistogram & hist = data->GetHistogram();
+    if( densitySource != &hist || densityVersion != hist.GetVersion() )
+        UpdateDensityCurves( hist );
 
-
-    for(int k = 0; k < (dim-1); k++)
+    int first, last;
+    VisibleGaps(first, last);
+    for(int k = first; k <= last; k++)
     {
         int   d0 = dimLoc[k].second;
         int   d1 = dimLoc[k+1].second;
         float x0 = dimLoc[k].first;
         float x1 = dimLoc[k+1].first;
-        float tol0 = 0;
-        float tol1 = 0;
-        float mean0 = 0;
-        float mean1 = 0;
-        float stddev0 = 0;
-        float stddev1 = 0;
-
-        for(int j = 0; j < numbin; j++)
-        {
-            bin0[j] = 0;
-            bin1[j] = 0;
-            bin0x[j] = 0;
-            bin0y[j] = 0;
-            bin1x[j] = 0;
-            bin1y[j] = 0;
-        }
 
-        for(int i = 0; i < data->GetElementCount(); i += step )
-        {
-            data->GetElement( i, elem );
-            float y0 = SCI::lerp(-rangeV, rangeV, (elem[d0]-dim_min[d0])/(dim_max[d0]-dim_min[d0]));
-            float y1 = SCI::lerp(-rangeV, rangeV, (elem[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
+        DrawDensityCurve( d0, x0, x1, false );
+        DrawDensityCurve( d1, x0, x1, true );
+    }
+}
 
-            for(int j = 0; j < numbin; j++)
-            {
-                float st = -rangeV + 2*rangeV*j/numbin;
-                float en = -rangeV + 2*rangeV*(j+1)/numbin;
-                if(y0 >= st && y0 < en)
-                    bin0[j] += 1;
-                if(y1 >= st && y1 < en)
-                    bin1[j] += 1;
-            }
-        }
+void ParallelCoordinates::UpdateDensityCurves( const Data::ColumnHistogram & hist )
+{
+    int n = hist.GetDimension();
+    bool fresh = densitySource != &hist;
+    densityCurve.resize( n );
+    densityLo.resize( n );
+    densityHi.resize( n );
+    densityColumns.resize( n, 0 );
+
+    // the kernel density of a column is estimated again only when its
+    // range or counts changed, scaled so that its peak is 1
+    #pragma omp parallel for schedule(dynamic)
+    for(int r = 0; r < n; r++)
+    {
+        if( !fresh && densityColumns[r] == hist.GetVersion( r ) )
+            continue;
+
+        std::vector<float> & curve = densityCurve[r];
+        hist.GetDensity( r, numbin, curve );
+
+        float peak = 0;
+        for(int j = 0; j < (int)curve.size(); j++)
+            peak = SCI::Max( peak, curve[j] );
+        if( peak > 0 )
+            for(int j = 0; j < (int)curve.size(); j++)
+                curve[j] /= peak;
+
+        densityLo[r] = hist.GetMinimumValue( r );
+        densityHi[r] = hist.GetMaximumValue( r );
+        densityColumns[r] = hist.GetVersion( r );
+    }
+
+    densitySource  = &hist;
+    densityVersion = hist.GetVersion();
+}
 
-        for(int j = 0; j < numbin; j++)
-        {
+void ParallelCoordinates::UpdatePairHistograms(int first, int last)
+{
+    std::vector< std::pair<int,int> > pairs;
+    for(int j = SCI::Max(first, 0); j <= SCI::Min(last, dim-2); j++)
+        pairs.push_back( std::make_pair( data->GetRealDimension( dimLoc[j].second ), data->GetRealDimension( dimLoc[j+1].second ) ) );
 
-            tol0 += bin0[j];
-            tol1 += bin1[j];
-        }
+    pairHists.Retain( pairs );
+    pairHists.Compute( pairs );
+
+    std::map< std::pair<int,int>, Bundle >::iterator it = bundles.begin();
+    while( it != bundles.end() )
+    {
+        if( pairHists.GetJoint( it->first.first, it->first.second ) == 0 )
+            bundles.erase( it++ );
+        else
+            ++it;
+    }
+}
+
+void ParallelCoordinates::DrawBinnedGap(int j)
+{
+    int d0 = dimLoc[j].second;
+    int d1 = dimLoc[j+1].second;
+    int r0 = data->GetRealDimension( d0 );
+    int r1 = data->GetRealDimension( d1 );
+    const std::vector<SCI::UINT32> * joint = pairHists.GetJoint( r0, r1 );
+    if( joint == 0 )
+        return;
+
+    int B = pairHists.GetBins();
+    SCI::UINT32 maxc = 0;
+    for(int c = 0; c < (int)joint->size(); c++)
+        if( (*joint)[c] > maxc ) maxc = (*joint)[c];
+    if( maxc == 0 )
+        return;
+
+    // bin edges on each axis
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> y0 = scratch.Alloc<float>( B+1 );
+    Data::FrameArena::Span<float> y1 = scratch.Alloc<float>( B+1 );
+    for(int b = 0; b <= B; b++)
+    {
+        float v0 = SCI::lerp( pairHists.GetMinimumValue(r0), pairHists.GetMaximumValue(r0), (float)b / (float)B );
+        float v1 = SCI::lerp( pairHists.GetMinimumValue(r1), pairHists.GetMaximumValue(r1), (float)b / (float)B );
+        y0[b] = SCI::lerp( -rangeV, rangeV, (v0-dim_min[d0])/(dim_max[d0]-dim_min[d0]) );
+        y1[b] = SCI::lerp( -rangeV, rangeV, (v1-dim_min[d1])/(dim_max[d1]-dim_min[d1]) );
+    }
+
+    float x0 = dimLoc[j].first;
+    float x1 = dimLoc[j+1].first;
+    float logmax = logf( 1.0f + (float)maxc );
 
-        // compute standard deviation
-        for(int j = 0; j < numbin; j++)
+    glBegin(GL_QUADS);
+    for(int a = 0; a < B; a++)
+    {
+        for(int b = 0; b < B; b++)
         {
-            bin0x[j] = x0 + binrange*bin0[j]/tol0;
-            bin0y[j] = -rangeV + 2*rangeV*j/numbin;
-            bin1x[j] = x1 - binrange*bin1[j]/tol1;
-            bin1y[j] = -rangeV + 2*rangeV*j/numbin;
-            mean0 += bin0x[j];
-            mean1 += bin1x[j];
+            SCI::UINT32 c = (*joint)[a*B+b];
+            if( c == 0 )
+                continue;
+            glColor4f( 0.3f, 0.3f, 0.3f, 0.05f + 0.55f * logf( 1.0f + (float)c ) / logmax );
+            glVertex3f( x0, y0[a],   -0.9f );
+            glVertex3f( x1, y1[b],   -0.9f );
+            glVertex3f( x1, y1[b+1], -0.9f );
+            glVertex3f( x0, y0[a+1], -0.9f );
         }
+    }
+    glEnd();
+}
 
-        mean0 = (x1+x0)/2;
-        mean1 = (x1+x0)/2;
+const ParallelCoordinates::Bundle * ParallelCoordinates::GapBundle(int j)
+{
+    std::pair<int,int> pair( data->GetRealDimension( dimLoc[j].second ), data->GetRealDimension( dimLoc[j+1].second ) );
+    const std::vector<SCI::UINT32> * joint = pairHists.GetJoint( pair.first, pair.second );
+    if( joint == 0 )
+        return 0;
 
-        for(int j = 0; j < numbin; j++)
-        {
+    // bundled again only once rows were added to the histogram
+    Bundle & bundle = bundles[pair];
+    if( bundle.edges.GetLineCount() == 0 || bundle.rows != pairHists.GetElementCount() )
+    {
+        bundle.rows = pairHists.GetElementCount();
+        bundle.edges.SetJoint( *joint, pairHists.GetBins() );
+        bundle.edges.Bundle();
+    }
+    return &bundle;
+}
 
-            stddev0 += (bin0x[j] - mean0)*(bin0x[j] - mean0);
-            stddev1 += (bin1x[j] - mean1)*(bin1x[j] - mean1);
-        }
+void ParallelCoordinates::DrawBundledGap(int j, const Bundle & bundle)
+{
+    const Data::EdgeBundling & edges = bundle.edges;
+    float maxw = edges.GetMaximumWeight();
+    if( maxw <= 0 )
+        return;
 
-        stddev0 = sqrtf(stddev0/numbin);
-        stddev1 = sqrtf(stddev1/numbin);
+    int d0 = dimLoc[j].second;
+    int d1 = dimLoc[j+1].second;
+    int r0 = data->GetRealDimension( d0 );
+    int r1 = data->GetRealDimension( d1 );
+    float x0 = dimLoc[j].first;
+    float x1 = dimLoc[j+1].first;
 
-        glLineWidth(4.0f);
-        glBegin(GL_LINE_STRIP);
-        glColor4f(0.9f,0,0.9f, 0.7f);
-        glVertex3f(x0,-rangeV,0.95f);
+    // a unit height on either axis, as an offset and a scale on the screen
+    float o0 = SCI::lerp( -rangeV, rangeV, (pairHists.GetMinimumValue(r0)-dim_min[d0])/(dim_max[d0]-dim_min[d0]) );
+    float o1 = SCI::lerp( -rangeV, rangeV, (pairHists.GetMinimumValue(r1)-dim_min[d1])/(dim_max[d1]-dim_min[d1]) );
+    float s0 = 2.0f * rangeV * (pairHists.GetMaximumValue(r0)-pairHists.GetMinimumValue(r0))/(dim_max[d0]-dim_min[d0]);
+    float s1 = 2.0f * rangeV * (pairHists.GetMaximumValue(r1)-pairHists.GetMinimumValue(r1))/(dim_max[d1]-dim_min[d1]);
 
-        for (float t= -rangeV ; t <= rangeV; t += 0.01f)
+    int S = edges.GetSamples();
+    float logmax = logf( 1.0f + maxw );
+    for(int l = 0; l < edges.GetLineCount(); l++)
+    {
+        const float * line = edges.GetLine(l);
+        glColor4f( 0.2f, 0.3f, 0.5f, 0.05f + 0.6f * logf( 1.0f + edges.GetWeight(l) ) / logmax );
+        glBegin(GL_LINE_STRIP);
+        for(int s = 0; s < S; s++)
         {
-            float y0t, yy0t;
-            for(int j = 0; j < numbin; j++)
-            {
-                float st = -rangeV + 2*rangeV*j/numbin;
-                float en = -rangeV + 2*rangeV*(j+1)/numbin;
-                if(t >= st && t < en)
-                {
-                    y0t = bin0x[j];
-                    yy0t = bin0y[j];
-                }
-            }
+            float t = (float)s / (float)(S-1);
+            glVertex3f( SCI::lerp( x0, x1, t ), SCI::lerp( o0 + s0*line[s], o1 + s1*line[s], t ), -0.9f );
+        }
+        glEnd();
+    }
+}
+
+void ParallelCoordinates::UpdateClusterTree()
+{
+    Data::PhysicsData & pd = *data->data;
+    std::string fname = pd.GetFilename();
+    SCI::UINT64 stamp = Data::PhysicsData::FileStamp( fname.c_str() );
+    if( clusterTree.GetNodeCount() > 0 && clusterTree.GetDimension() == pd.GetDim()
+        && clusterTree.GetCount(0) == pd.GetElementCount() && stamp == clusterStamp )
+        return;
+
+    // a tree saved for the same file is as good as a new one
+    std::string tname = fname + ".tree";
+    if( stamp == 0 || !clusterTree.Load( tname.c_str(), stamp, pd.GetDim(), pd.GetElementCount() ) )
+    {
+        clusterTree.Build( pd );
+        if( stamp != 0 )
+            clusterTree.Save( tname.c_str(), stamp );
+    }
+    clusterStamp = stamp;
+}
 
-            float x0t = x0 - 3.8f*(x1-x0)/2 - 0.005f + (1/(stddev0*(sqrtf(2*3.14f))))*(exp(-((y0t-mean0)*(y0t-mean0)/(2*stddev0*stddev0))));
+void ParallelCoordinates::ClusterBoost(std::vector<float> & boost)
+{
+    boost.clear();
+
+    // the axis under the pointer, if any
+    int axis = -1;
+    float half = 1.0f / (float)SCI::Max( axisSpan, 1 );
+    for(int i = 0; i < (int)dimLoc.size(); i++)
+        if( fabsf( dimLoc[i].first - hoverX ) < half && ( axis < 0 || fabsf( dimLoc[i].first - hoverX ) < fabsf( dimLoc[axis].first - hoverX ) ) )
+            axis = i;
+    if( axis < 0 || hoverY < -rangeV || hoverY > rangeV )
+        return;
+
+    int d = dimLoc[axis].second;
+    int r = data->GetRealDimension( d );
+    if( r < 0 || r >= clusterTree.GetDimension() )
+        return;
+    float v = SCI::lerp( dim_min[d], dim_max[d], (hoverY+rangeV) / (2.0f*rangeV) );
+
+    boost.assign( clusterTree.GetNodeCount(), 1.0f );
+    for(int n = 0; n < clusterTree.GetNodeCount(); n++)
+        if( clusterTree.GetMinimum(n)[r] <= v && v <= clusterTree.GetMaximum(n)[r] )
+            boost[n] = 16.0f;
+}
+
+void ParallelCoordinates::DrawClusterGaps(int first, int last)
+{
+    if( clusterTree.GetNodeCount() == 0 )
+        return;
 
-            glVertex3f(x0t,t,0.95f);
+    QElapsedTimer timer;
+    timer.start();
+
+    // zoomed in, the same time allows more bands per gap
+    int budget = clusterBudget;
+    if( axisSpan > 0 && axisSpan < maxAxes )
+        budget = budget * maxAxes / axisSpan;
+
+    std::vector<float> boost;
+    ClusterBoost(boost);
+    std::vector<int> cut;
+    clusterTree.GetCut( budget, boost, cut );
+
+    // clusters are coloured by the top level cluster they belong to
+    static const float palette[8][3] = {
+        { 0.894f, 0.102f, 0.110f }, { 0.216f, 0.494f, 0.722f }, { 0.302f, 0.686f, 0.290f }, { 0.596f, 0.306f, 0.639f },
+        { 1.000f, 0.498f, 0.000f }, { 0.651f, 0.337f, 0.157f }, { 0.969f, 0.506f, 0.749f }, { 0.600f, 0.600f, 0.600f }
+    };
+    std::vector<const float *> color( cut.size() );
+    std::vector<float> alpha( cut.size() );
+    float logTotal = logf( 1.0f + (float)clusterTree.GetCount(0) );
+    for(int c = 0; c < (int)cut.size(); c++)
+    {
+        int top = cut[c];
+        while( clusterTree.GetDepth(top) > 1 )
+            top = clusterTree.GetParent(top);
+        int k = ( top == 0 ) ? 0 : top - clusterTree.GetChild(0, 0);
+        color[c] = palette[ k % 8 ];
+        alpha[c] = logf( 1.0f + (float)clusterTree.GetCount(cut[c]) ) / logTotal;
+    }
+
+    for(int j = first; j <= last; j++)
+    {
+        int d0 = dimLoc[j].second;
+        int d1 = dimLoc[j+1].second;
+        int r0 = data->GetRealDimension( d0 );
+        int r1 = data->GetRealDimension( d1 );
+        if( r0 < 0 || r1 < 0 || r0 >= clusterTree.GetDimension() || r1 >= clusterTree.GetDimension() )
+            continue;
+        float x0 = dimLoc[j].first;
+        float x1 = dimLoc[j+1].first;
+        float s0 = 2.0f * rangeV / ( dim_max[d0] - dim_min[d0] );
+        float s1 = 2.0f * rangeV / ( dim_max[d1] - dim_min[d1] );
+
+        glBegin(GL_QUADS);
+        for(int c = 0; c < (int)cut.size(); c++)
+        {
+            int n = cut[c];
+            glColor4f( color[c][0], color[c][1], color[c][2], 0.03f + 0.2f * alpha[c] );
+            glVertex3f( x0, -rangeV + ( clusterTree.GetMinimum(n)[r0] - dim_min[d0] ) * s0, -0.9f );
+            glVertex3f( x1, -rangeV + ( clusterTree.GetMinimum(n)[r1] - dim_min[d1] ) * s1, -0.9f );
+            glVertex3f( x1, -rangeV + ( clusterTree.GetMaximum(n)[r1] - dim_min[d1] ) * s1, -0.9f );
+            glVertex3f( x0, -rangeV + ( clusterTree.GetMaximum(n)[r0] - dim_min[d0] ) * s0, -0.9f );
         }
-        glVertex3f(x0,rangeV,0.95f);
         glEnd();
 
-        glLineWidth(4.0f);
-        glBegin(GL_LINE_STRIP);
-        glColor4f(0.9f,0,0.9f, 0.7f);
-        glVertex3f(x1,-rangeV,0.95f);
-
-        for (float t= -rangeV ; t <= rangeV; t += 0.01f)
+        glBegin(GL_LINES);
+        for(int c = 0; c < (int)cut.size(); c++)
         {
-            float y1t, yy1t;
-            for(int j = 0; j < numbin; j++)
-            {
-                float st = -rangeV + 2*rangeV*j/numbin;
-                float en = -rangeV + 2*rangeV*(j+1)/numbin;
-                if(t >= st && t < en)
-                {
-                    y1t = bin1x[j];
-                    yy1t = bin1y[j];
-                }
-            }
+            int n = cut[c];
+            glColor4f( color[c][0], color[c][1], color[c][2], 0.2f + 0.7f * alpha[c] );
+            glVertex3f( x0, -rangeV + ( clusterTree.GetCentroid(n)[r0] - dim_min[d0] ) * s0, -0.8f );
+            glVertex3f( x1, -rangeV + ( clusterTree.GetCentroid(n)[r1] - dim_min[d1] ) * s1, -0.8f );
+        }
+        glEnd();
+    }
+
+    // fit the budget to a 20ms frame, refining while the cut is cut short
+    float ms = (float)timer.nsecsElapsed() / 1.0e6f;
+    clusterRefine = false;
+    if( ms > 20.0f )
+        clusterBudget = SCI::Max( 16, clusterBudget * 3 / 4 );
+    else if( ms < 10.0f && (int)cut.size() >= budget && clusterBudget < 4096 )
+    {
+        clusterBudget = SCI::Min( 4096, clusterBudget * 5 / 4 + 1 );
+        clusterRefine = true;
+    }
+}
+
+void ParallelCoordinates::DrawDensityCurve( int d, float x0, float x1, bool right )
+{
+    int r = data->GetRealDimension( d );
+    if( r < 0 || r >= (int)densityCurve.size() || densityCurve[r].empty() )
+        return;
+
+    // the cached density is sampled at numbin points over [densityLo,densityHi],
+    // the axis shows [dim_min,dim_max]; it is read off between samples and
+    // drawn into the gap, at most binrange away from the axis
+    const std::vector<float> & curve = densityCurve[r];
+    int   samples = (int)curve.size();
+    float lo      = densityLo[r];
+    float hi      = densityHi[r];
+
+    float x = right ? x1 : x0;
 
-            float x1t = x1 + 3.8f*(x1-x0)/2 + 0.005f -(1/(stddev1*(sqrtf(2*3.14f))))*(exp(-((y1t-mean1)*(y1t-mean1)/(2*stddev1*stddev1))));
+    glLineWidth(4.0f);
+    glBegin(GL_LINE_STRIP);
+    glColor4f(0.9f,0,0.9f, 0.7f);
+    glVertex3f(x,-rangeV,0.95f);
 
-            glVertex3f(x1t,t,0.95f);
+    for (float t= -rangeV ; t <= rangeV; t += 0.01f)
+    {
+        float v  = SCI::lerp( dim_min[d], dim_max[d], (t+rangeV) / (2*rangeV) );
+        float g  = 0;
+        if( hi > lo && v >= lo && v <= hi )
+        {
+            float s = (v-lo) / (hi-lo) * samples - 0.5f;
+            int   j = SCI::Clamp( (int)floorf( s ), 0, samples-1 );
+            int   k = SCI::Min( j+1, samples-1 );
+            float f = SCI::Clamp( s - (float)j, 0.0f, 1.0f );
+            g = SCI::lerp( curve[j], curve[k], f );
         }
-        glVertex3f(x1,rangeV,0.95f);
-        glEnd();
+        float xt = right ? x - binrange*g : x + binrange*g;
 
+        glVertex3f(xt,t,0.95f);
     }
+    glVertex3f(x,rangeV,0.95f);
+    glEnd();
 }
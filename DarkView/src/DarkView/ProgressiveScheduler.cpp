@@ -0,0 +1,120 @@
+/*
+**  Data Scalable Approach for Parallel Coordinates
+**  Copyright (C) 2016 - Hoa Nguyen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <DarkView/ProgressiveScheduler.h>
+
+#include <algorithm>
+
+// units granted to a task whose cost was never measured
+static const int probeUnits = 64;
+// a grant grows at most this much over the last one, in case the estimate is off
+static const int maxGrowth = 4;
+
+ProgressiveScheduler::ProgressiveScheduler( float _frame_ms )
+{
+    frame_ms = _frame_ms;
+}
+
+int ProgressiveScheduler::AddView( )
+{
+    views.push_back( View() );
+    views.back().progressed = false;
+    views.back().frame.start();
+    return (int)views.size()-1;
+}
+
+void ProgressiveScheduler::SetFrameBudget( float ms )
+{
+    frame_ms = ms;
+}
+
+float ProgressiveScheduler::Budget( ) const
+{
+    return frame_ms / (float)std::max( (int)views.size(), 1 );
+}
+
+ProgressiveScheduler::Task & ProgressiveScheduler::GetTask( int view, int task )
+{
+    std::vector<Task> & tasks = views[view].tasks;
+    if( task >= (int)tasks.size() )
+    {
+        Task none;
+        none.ms_per_unit = -1.0f;
+        none.granted = 0;
+        tasks.resize( task+1, none );
+    }
+    return tasks[task];
+}
+
+void ProgressiveScheduler::BeginFrame( int view )
+{
+    views[view].frame.start();
+    views[view].progressed = false;
+}
+
+float ProgressiveScheduler::Remaining( int view ) const
+{
+    return Budget() - (float)views[view].frame.nsecsElapsed() / 1.0e6f;
+}
+
+int ProgressiveScheduler::Grant( int view, int task, int remaining )
+{
+    if( remaining <= 0 )
+        return 0;
+
+    View & v = views[view];
+    Task & t = GetTask( view, task );
+
+    int units;
+    float left = Remaining( view );
+    if( t.ms_per_unit < 0 )
+        units = probeUnits;
+    else if( left <= 0 )
+        units = v.progressed ? 0 : 1;
+    else
+    {
+        units = (int)std::min( left / std::max( t.ms_per_unit, 1.0e-6f ), 1.0e9f );
+        if( t.granted > 0 )
+            units = std::min( units, t.granted * maxGrowth );
+        units = std::max( units, v.progressed ? 0 : 1 );
+    }
+    units = std::min( units, remaining );
+
+    t.granted = units;
+    v.grant.start();
+    return units;
+}
+
+void ProgressiveScheduler::Done( int view, int task, int units )
+{
+    View & v = views[view];
+    Task & t = GetTask( view, task );
+    if( units <= 0 )
+        return;
+    v.progressed = true;
+
+    // moving average, a slow frame now and then does not stall the view
+    float per = (float)v.grant.nsecsElapsed() / 1.0e6f / (float)units;
+    t.ms_per_unit = ( t.ms_per_unit < 0 ) ? per : 0.7f * t.ms_per_unit + 0.3f * per;
+}
+
+void ProgressiveScheduler::Cancel( int view )
+{
+    views[view].tasks.clear();
+    views[view].progressed = false;
+}
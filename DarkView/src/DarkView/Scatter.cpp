@@ -17,6 +17,7 @@
 */
 
 #include <DarkView/Scatter.h>
+#include <Data/FrameArena.h>
 #include <GL/oglCommon.h>
 
 #include <QMouseEvent>
@@ -45,6 +46,8 @@ typedef matrix<double,4,1> parameter_vector;
 
 Scatter::Scatter(MainWidget *_mw, oglWidgets::oglFont & _font, QWidget * parent ) : QGLWidget( QGLFormat(QGL::SingleBuffer | QGL::DepthBuffer | QGL::Rgba | QGL::AlphaChannel | QGL::DirectRendering | QGL::SampleBuffers), parent )
 {
+    scheduler = 0;
+    schedulerView = -1;
     fitMeth = 0;
 
     curveDegree = 3;
@@ -66,6 +69,10 @@ Scatter::Scatter(MainWidget *_mw, oglWidgets::oglFont & _font, QWidget * parent
 
     data = 0;
     curDraw = 0;
+    elementKey = 0;
+    elementData = 0;
+    densityRows = 1000000;
+    densityKey = 0;
     selected = -1;
     d_scale = 0.1f;
     font = &_font;
@@ -275,6 +282,7 @@ void LSmain()
 void Scatter::SetData( DataIndirector * _data )
 {
     data = _data;
+    elementData++;
 
     // clear dimLoc before setup or update data
     dimLoc.clear();
@@ -334,11 +342,13 @@ void Scatter::SetData( DataIndirector * _data )
         xp3 = xx1;
 
     }
+    update();
 }
 
 void Scatter::Reset()
 {
     curDraw = 0;
+    update();
 }
 
 void Scatter::initializeGL()
@@ -349,6 +359,15 @@ void Scatter::initializeGL()
 void Scatter::resizeGL ( int, int )
 {
     curDraw = 0;
+    // the cost of a row changes with the size of the view
+    if( scheduler )
+        scheduler->Cancel( schedulerView );
+}
+
+void Scatter::SetScheduler( ProgressiveScheduler * _scheduler )
+{
+    scheduler = _scheduler;
+    schedulerView = scheduler->AddView();
 }
 
 void Scatter::mousePressEvent ( QMouseEvent * event )
@@ -445,6 +464,7 @@ void Scatter::mousePressEvent ( QMouseEvent * event )
         curDraw = 0;
     }
 
+    update();
 }
 
 void Scatter::mouseReleaseEvent ( QMouseEvent * event )
@@ -509,6 +529,7 @@ void Scatter::mouseReleaseEvent ( QMouseEvent * event )
         curPointY = selpy;
         userFreeDraw = 0;
     }
+    update();
 }
 
 void Scatter::mouseMoveEvent ( QMouseEvent * event )
@@ -601,15 +622,22 @@ void Scatter::mouseMoveEvent ( QMouseEvent * event )
     emit UpdatedSelection( scatter_pair );
     */
 
+    update();
 }
 
 void Scatter::Start()
 {
     started = true;
+    update();
 }
 
 void Scatter::paintGL()
 {
+    Data::FrameArena::Scope scratch;
+
+    if( scheduler )
+        scheduler->BeginFrame( schedulerView );
+
     glViewport( 0, 0, size().width(), size().height() );
     if( curDraw == 0 )
     {
@@ -619,13 +647,11 @@ void Scatter::paintGL()
 
     if( !started )
     {
-        update();
         return;
     }
 
     if(data == 0 )
     {
-        update();
         return;
     }
 
@@ -656,7 +682,7 @@ void Scatter::paintGL()
         x1 = dimLoc[1].first;
 
         int step = SCI::Max( 1, data->GetElementCount() / 500 );
-        float * elem = new float[dim];
+        Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
         xydim.clear();
 
         // update input (x,y) for LSmain()
@@ -832,26 +858,19 @@ void Scatter::paintGL()
 
         // draw PCP labels
         float aspect = (float)size().width()/(float)size().height();
+        const float labelColor[4] = { 0.6f, 0.6f, 0.6f, 1.0f };
+        font->BeginBatch();
         for(int d = 0; d < (dim - 1); d++)
         {
-            glPushMatrix();
-                glTranslatef( (dimLoc[d].first+dimLoc[d + 1].first)/2 - 0.01f, -0.95f, 0 );
-                glColor3f(0.6f,0.6f,0.6f);
-                glScalef(0.02f,0.02f*aspect,0.1f);
-                glRotatef(0,0,0,-1);
-                int _d1 = dimLoc[d+1].second;
-                font->Print( data->GetLabelParsed(_d1).c_str() );
-            glPopMatrix();
-
-            glPushMatrix();
-                glTranslatef( 0.9f, (dimLoc[d].first+dimLoc[d + 1].first)/2 - 0.01f, 0 );
-                glColor3f(0.6f,0.6f,0.6f);
-                glScalef(0.02f,0.02f*aspect,0.1f);
-                glRotatef(0,0,0,-1);
-                int _d = dimLoc[d].second;
-                font->Print( data->GetLabelParsed(_d).c_str() );
-            glPopMatrix();
+            float mid = (dimLoc[d].first+dimLoc[d + 1].first)/2 - 0.01f;
+
+            int _d1 = dimLoc[d+1].second;
+            font->Print( data->GetLabelParsed(_d1).c_str(), mid, -0.95f, 0.02f, 0.02f*aspect, 0, labelColor );
+
+            int _d = dimLoc[d].second;
+            font->Print( data->GetLabelParsed(_d).c_str(), 0.9f, mid, 0.02f, 0.02f*aspect, 0, labelColor );
         }        
+        font->EndBatch();
         // end of draw PCP labels
     }
 
@@ -861,7 +880,7 @@ void Scatter::paintGL()
 
     glDepthFunc( GL_LEQUAL );
 
-    float * space = new float[dim];
+    Data::FrameArena::Span<float> space = scratch.Alloc<float>( dim );
 
     // draw elements of PCP
     #if 0
@@ -874,23 +893,59 @@ void Scatter::paintGL()
         }
         curDraw = 0;
     #else
+    if( data->GetElementCount() > densityRows )
+    {
+        // all rows at once, there is nothing to add a chunk at a time
+        if( curDraw == 0 )
+            DrawDensity();
+        curDraw = data->GetElementCount();
+    }
+    else
+    {
         //hoatam
         int step = SCI::Max( 1, data->GetElementCount() / 500 );
         //int step = 1;
 
+        // the elements of a layout are built once, a chunk a frame, into
+        // buffers kept on the GPU; drawing the same layout again replays
+        // the chunks built so far and goes on after them
+        int first = -1;
         if( curDraw == 0 )
         {
-            for( ; curDraw < data->GetElementCount(); curDraw += step )
+            SCI::UINT64 key = ElementKey();
+            if( key != elementKey )
             {
-                 data->GetElement( curDraw, space );
-                 DrawElement(space);
+                elementChunks.clear();
+                elementEnd.clear();
+                elementKey = key;
+            }
+            if( elementChunks.empty() )
+            {
+                // every step-th row first
+                elementChunks.push_back( oglWidgets::oglPolylineBuffer() );
+                elementChunks.back().Begin( 3, GL_STATIC_DRAW );
+                for( ; curDraw < data->GetElementCount(); curDraw += step )
+                {
+                     data->GetElement( curDraw, space );
+                     DrawElement(space);
+                }
+                elementChunks.back().End( );
+                elementEnd.push_back( 1 );
             }
-            curDraw = 1;
+            glPointSize( 3.0 );
+            glColor3f( 0.0f, 0.8f, 0.0f );
+            for(int k = 0; k < (int)elementChunks.size(); k++)
+                elementChunks[k].Draw( GL_POINTS, false );
+            curDraw = elementEnd.back();
          }
-         else
+         else if( curDraw < data->GetElementCount() )
          {
              //hoatam
-             int fin = curDraw+500;
+             // as many rows as fit in what is left of the frame
+             first = curDraw;
+             elementChunks.push_back( oglWidgets::oglPolylineBuffer() );
+             elementChunks.back().Begin( 3, GL_STATIC_DRAW );
+             int fin = curDraw + ( scheduler ? scheduler->Grant( schedulerView, 0, data->GetElementCount()-curDraw ) : 500 );
              //int fin = curDraw+1;
              for( ; curDraw < fin && curDraw < data->GetElementCount(); curDraw++ )
              {
@@ -898,7 +953,15 @@ void Scatter::paintGL()
                  data->GetElement( curDraw, space );
                  DrawElement(space);
              }
+             elementChunks.back().End( );
+             elementEnd.push_back( curDraw );
+             glPointSize( 3.0 );
+             glColor3f( 0.0f, 0.8f, 0.0f );
+             elementChunks.back().Draw( GL_POINTS, false );
          }
+         if( scheduler && first >= 0 )
+             scheduler->Done( schedulerView, 0, curDraw-first );
+    }
      #endif
 
     // draw detail view
@@ -908,13 +971,42 @@ void Scatter::paintGL()
         detailView(sDim1, sDim2);
     }
 
-     delete [] space;
      glDisable( GL_BLEND );
-     update();
+     // frames are drawn while rows are left, otherwise only on a change
+     if( curDraw < data->GetElementCount() )
+         update();
      // end of drawing elements of PCP
  }
 
 // draw elements of dimensions
+// FNV-1a over raw bytes
+static void FoldKey( SCI::UINT64 & h, const void * p, size_t n )
+{
+    const unsigned char * b = (const unsigned char*)p;
+    for(size_t i = 0; i < n; i++)
+        h = ( h ^ b[i] ) * 1099511628211ULL;
+}
+
+template<class T>
+static void FoldKey( SCI::UINT64 & h, const std::vector<T> & v )
+{
+    if( !v.empty() )
+        FoldKey( h, &v[0], v.size() * sizeof(T) );
+}
+
+// everything the element points are placed from, so a change rebuilds them
+SCI::UINT64 Scatter::ElementKey() const
+{
+    SCI::UINT64 h = 14695981039346656037ULL;
+    int rows = ( data != 0 ) ? data->GetElementCount() : 0;
+    FoldKey( h, &elementData, sizeof(elementData) );
+    FoldKey( h, &rows, sizeof(rows) );
+    FoldKey( h, dimLoc );
+    FoldKey( h, dim_min );
+    FoldKey( h, dim_max );
+    return h;
+}
+
 void Scatter::DrawElement( float * elem )
 {
     /*
@@ -922,9 +1014,21 @@ void Scatter::DrawElement( float * elem )
     glEnable( GL_BLEND );
     glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
     */
-    glPointSize( 3.0 );
-    glBegin(GL_POINTS);
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> x = scratch.Alloc<float>( dim*(dim-1)/2 );
+    Data::FrameArena::Span<float> y = scratch.Alloc<float>( dim*(dim-1)/2 );
+    int n = ElementPoints( elem, x, y );
+    for(int i = 0; i < n; i++)
+    {
+        elementChunks.back().Vertex( x[i], y[i], -0.8f );
+    }
+    elementChunks.back().EndLine( );
+}
 
+// point of a row in every cell of the matrix, returns how many
+int Scatter::ElementPoints( float * elem, float * x, float * y )
+{
+    int n = 0;
     for(int j = 0; j < (dim); j++)
     {
         float distan = fabsf(dimLoc[0].first - dimLoc[1].first);
@@ -940,15 +1044,63 @@ void Scatter::DrawElement( float * elem )
             float y0 = SCI::lerp(x0, x0+distan, (elem[d0]-dim_min[d0])/(dim_max[d0]-dim_min[d0]));
             float y1 = SCI::lerp(x1-distan, x1, (elem[d1]-dim_min[d1])/(dim_max[d1]-dim_min[d1]));
 
-            float x, y;
-            x = y1;
-            y = y0;
+            x[n] = y1;
+            y[n] = y0;
+            n++;
+        }
+    }
+    return n;
+}
+
+// every row of the matrix through the raster, rebuilt with the layout
+void Scatter::DrawDensity()
+{
+    // one texel per pixel of the view
+    int w = SCI::Max( 16, SCI::Min( 1024, size().width() ) );
+    int h = SCI::Max( 16, SCI::Min( 1024, size().height() ) );
 
-            glColor3f( 0.0f, 0.8f, 0.0f);
-            glVertex3f( x, y, -0.8f );
+    SCI::UINT64 key = ElementKey();
+    if( key != densityKey || density.GetWidth() != w || density.GetHeight() != h )
+    {
+        Data::FrameArena::Scope scratch;
+        int cells = dim*(dim-1)/2;
+        int block = 4096;
+        Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
+        Data::FrameArena::Span<float> x    = scratch.Alloc<float>( block*cells );
+        Data::FrameArena::Span<float> y    = scratch.Alloc<float>( block*cells );
+
+        density.Resize( w, h );
+        for(int r = 0; r < data->GetElementCount(); )
+        {
+            int n = 0;
+            for(int b = 0; b < block && r < data->GetElementCount(); b++, r++)
+            {
+                data->GetElement( r, elem );
+                n += ElementPoints( elem, &x[n], &y[n] );
+            }
+            density.AddPoints( x, -1, 1, y, -1, 1, n );
         }
+
+        // empty pixels stay clear, dense ones reach the colour of the points
+        float transfer[8] = { 0.0f, 0.8f, 0.0f, 0.0f, 0.0f, 0.8f, 0.0f, 1.0f };
+        std::vector<float> intensity;
+        std::vector<SCI::UINT8> rgba;
+        density.ToneMap( Data::DensityRaster::LOG, intensity );
+        Data::DensityRaster::Colorize( intensity, transfer, 2, rgba );
+        densityTex.TexImage2D( GL_RGBA, w, h, GL_RGBA, GL_UNSIGNED_BYTE, &rgba[0] );
+        densityKey = key;
     }
+
+    glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
+    densityTex.Enable();
+    densityTex.Bind();
+    glBegin(GL_QUADS);
+        glTexCoord2f(0,0); glVertex3f( -1, -1, -0.8f );
+        glTexCoord2f(1,0); glVertex3f(  1, -1, -0.8f );
+        glTexCoord2f(1,1); glVertex3f(  1,  1, -0.8f );
+        glTexCoord2f(0,1); glVertex3f( -1,  1, -0.8f );
     glEnd();
+    densityTex.Disable();
 }
 
 // compute cubic fitting curve for cubicAxis() function
@@ -1142,7 +1294,8 @@ void Scatter::cubicAxis()
     fitErr.clear();
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     int incub = 0;
 
@@ -1402,7 +1555,8 @@ void Scatter::quadAxis()
     fitErr.clear();
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
 
     for(int j = 0; j < (dim); j++)
     {
@@ -1517,7 +1671,8 @@ void Scatter::detailView(int sd1, int sd2)
     d1 = dimLoc[sd1].second;
 
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
-    float * elem = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
     for(int i = 0; i < data->GetElementCount(); i += step )
     {
         data->GetElement( i, elem );
@@ -1615,8 +1770,9 @@ void Scatter::knn_pca()
     int step = SCI::Max( 1, data->GetElementCount() / 500 );
     //int step = 1;
     int nstep = SCI::Max( 1, data->GetElementCount())/step;
-    float * elem = new float[dim];
-    float * elem2 = new float[dim];
+    Data::FrameArena::Scope scratch;
+    Data::FrameArena::Span<float> elem = scratch.Alloc<float>( dim );
+    Data::FrameArena::Span<float> elem2 = scratch.Alloc<float>( dim );
 
     //std::cout << "nstep = " << nstep << std::endl;
 
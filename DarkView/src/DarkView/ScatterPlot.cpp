@@ -29,6 +29,10 @@ ScatterPlot::ScatterPlot( oglWidgets::oglFont & _font )
     real_dimX = -1;
     real_dimY = -1;
     curdraw = 0;
+    points_version = 1;
+    points_step = 1;
+    density_rows = 1000000;
+    density_version = 0;
 }
 
 void ScatterPlot::Reset()
@@ -36,6 +40,7 @@ void ScatterPlot::Reset()
     real_dimX = -1;
     real_dimY = -1;
     curdraw = 0;
+    points_version++;
 }
 
 void ScatterPlot::Set(DataIndirector & data, int dimX, int dimY, bool show_labels )
@@ -45,6 +50,7 @@ void ScatterPlot::Set(DataIndirector & data, int dimX, int dimY, bool show_label
         curdraw = 0;
         real_dimX = data.GetRealDimension( dimX );
         real_dimY = data.GetRealDimension( dimY );
+        points_version++;
     }
     _data = &data;
     _dimX  = dimX;
@@ -52,6 +58,20 @@ void ScatterPlot::Set(DataIndirector & data, int dimX, int dimY, bool show_label
     _show_labels = show_labels;
 }
 
+// Red for positive and blue for negative correlation; the information
+// coefficient has no sign and goes on a single hue
+SCI::Vex4 ScatterPlot::DependencyColor( )
+{
+    float dependency = _data->GetDependency( _dimX, _dimY );
+    if( _data->GetDependencyMeasure() == DataIndirector::INFORMATION )
+        return SCI::Vex4(0.5f,0,0.8f,1) * dependency;
+
+    SCI::Vex4 cor_color;
+    if( dependency > 0 ) cor_color = SCI::Vex4(1,0,0,1) * ( dependency );
+    if( dependency < 0 ) cor_color = SCI::Vex4(0,0,1,1) * (-dependency );
+    return cor_color;
+}
+
 void ScatterPlot::SetAspect( float a )
 {
     aspect = a;
@@ -101,11 +121,18 @@ void ScatterPlot::UpdateLayout( )
 }
 
 // draw SCPs in SPLOM
-bool ScatterPlot::ProgressiveDraw( )
+int ScatterPlot::GetRemaining( ) const
+{
+    return SCI::Max( 0, _data->GetElementCount() - curdraw );
+}
+
+int ScatterPlot::ProgressiveDraw( int rows )
 {
-    if( curdraw >= _data->GetElementCount() )
+    int start = curdraw;
+    int stop  = SCI::Min( _data->GetElementCount(), start + rows );
+    if( stop <= start )
     {
-        return false;
+        return 0;
     }
 
     UpdateLayout( );
@@ -113,21 +140,27 @@ bool ScatterPlot::ProgressiveDraw( )
     glPushMatrix();
     glTranslatef( center.x, center.y, 0.0f );
 
-    float correlation = _data->GetCorrelation( _dimX, _dimY );
-    SCI::Vex4 cor_color;
-    if( correlation > 0 ) cor_color = SCI::Vex4(1,0,0,1) * ( correlation );
-    if( correlation < 0 ) cor_color = SCI::Vex4(0,0,1,1) * (-correlation );
+    SCI::Vex4 cor_color = DependencyColor( );
 
     glTranslatef( -size.x/2.0f, -size.y/2.0f, 0.0f );
     glScalef( size.x / (x_max-x_min), size.y / (y_max-y_min), 1.0f );
     glTranslatef( -x_min, -y_min, 0.0f );
 
 
-    DrawPoints( cor_color, 0, _data->GetElementCount(), 1 );
+    if( _data->GetElementCount() > density_rows )
+    {
+        DrawDensity( cor_color );
+        stop = _data->GetElementCount();
+    }
+    else
+    {
+        DrawPoints( cor_color, start, stop );
+    }
+    curdraw = stop;
 
     glPopMatrix();
 
-    return true;
+    return stop - start;
 }
 
 void ScatterPlot::ProgressiveBorder( )
@@ -139,10 +172,7 @@ void ScatterPlot::ProgressiveBorder( )
 
     glEnable(GL_DEPTH_TEST);
 
-    float correlation = _data->GetCorrelation( _dimX, _dimY );
-    SCI::Vex4 cor_color;
-    if( correlation > 0 ) cor_color = SCI::Vex4(1,0,0,1) * ( correlation );
-    if( correlation < 0 ) cor_color = SCI::Vex4(0,0,1,1) * (-correlation );
+    SCI::Vex4 cor_color = DependencyColor( );
     if(border_size > 0)
     {
         glLineWidth(border_size);
@@ -222,10 +252,7 @@ void ScatterPlot::Draw( )
         glPopMatrix();
     }
 
-    float correlation = _data->GetCorrelation( _dimX, _dimY );
-    SCI::Vex4 cor_color;
-    if( correlation > 0 ) cor_color = SCI::Vex4(1,0,0,1) * ( correlation );
-    if( correlation < 0 ) cor_color = SCI::Vex4(0,0,1,1) * (-correlation );
+    SCI::Vex4 cor_color = DependencyColor( );
     if(border_size > 0)
     {
         glLineWidth(border_size);
@@ -242,24 +269,100 @@ void ScatterPlot::Draw( )
     glScalef( size.x / (x_max-x_min), size.y / (y_max-y_min), 1.0f );
     glTranslatef( -x_min, -y_min, 0.0f );
 
-    DrawPoints( cor_color, 0, _data->GetElementCount(), SCI::Max(1,_data->GetElementCount()/20000) );
+    DrawSamples( cor_color, SCI::Max(1,_data->GetElementCount()/20000) );
 
     glPopMatrix();
 
 }
 
-void ScatterPlot::DrawPoints( SCI::Vex4 col, int start, int stop, int step )
-{    
-    glBegin(GL_POINTS);
-        for(int k = start; k < stop; k+=step)
+void ScatterPlot::UpdatePoints( )
+{
+    if( points.IsCurrent( points_version ) )
+        return;
+
+    int n = _data->GetElementCount();
+    points_step = SCI::Max( 1, n / 20000 );
+    points.Begin( 2 );
+    for(int o = 0; o < points_step; o++)
+    {
+        for(int k = o; k < n; k += points_step)
         {
-            glColor4fv(col.data);
             float x = _data->GetElement( k, _dimX );
             float y = _data->GetElement( k, _dimY );
 
-            glVertex3f(x,y,0.1f);
+            points.Vertex( x, y );
         }
+    }
+    points.End( points_version );
+}
+
+// the progressive chunks are ranges of the one buffer
+void ScatterPlot::DrawPoints( SCI::Vex4 col, int start, int stop )
+{
+    UpdatePoints( );
+
+    glPushMatrix();
+    glTranslatef( 0.0f, 0.0f, 0.1f );
+    glColor4fv(col.data);
+    points.DrawRange( GL_POINTS, start, stop - start );
+    glPopMatrix();
+}
+
+void ScatterPlot::DrawSamples( SCI::Vex4 col, int step )
+{
+    if( _data->GetElementCount() > density_rows )
+    {
+        DrawDensity( col );
+    }
+    else
+    {
+        // the first rows of the buffer are every step-th row
+        DrawPoints( col, 0, ( _data->GetElementCount() + step - 1 ) / step );
+    }
+}
+
+// draw the pair as a density image over the whole plot
+void ScatterPlot::DrawDensity( SCI::Vex4 col )
+{
+    // one texel per pixel of the plot
+    GLint vp[4];
+    glGetIntegerv( GL_VIEWPORT, vp );
+    int w = SCI::Max( 16, SCI::Min( 1024, (int)( size.x * 0.5f * (float)vp[2] ) ) );
+    int h = SCI::Max( 16, SCI::Min( 1024, (int)( size.y * 0.5f * (float)vp[3] ) ) );
+
+    if( density_version != points_version || density.GetWidth() != w || density.GetHeight() != h )
+    {
+        // whole columns, not a row at a time
+        std::vector<float> x = _data->ExtractDimension( _dimX );
+        std::vector<float> y = _data->ExtractDimension( _dimY );
+        int n = SCI::Min( (int)x.size(), (int)y.size() );
+
+        density.Resize( w, h );
+        if( n > 0 )
+        {
+            density.AddPoints( &x[0], x_min, x_max, &y[0], y_min, y_max, n );
+        }
+
+        // empty pixels stay clear, dense ones reach the colour of the pair
+        float transfer[8] = { 1.0f, 1.0f, 1.0f, 0.0f, col.x, col.y, col.z, col.w };
+        std::vector<float> intensity;
+        std::vector<SCI::UINT8> rgba;
+        density.ToneMap( Data::DensityRaster::LOG, intensity );
+        Data::DensityRaster::Colorize( intensity, transfer, 2, rgba );
+        density_tex.TexImage2D( GL_RGBA, w, h, GL_RGBA, GL_UNSIGNED_BYTE, &rgba[0] );
+        density_version = points_version;
+    }
+
+    glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
+    density_tex.Enable();
+    density_tex.Bind();
+    glBegin(GL_QUADS);
+        glTexCoord2f(0,0); glVertex3f( x_min, y_min, 0.1f );
+        glTexCoord2f(1,0); glVertex3f( x_max, y_min, 0.1f );
+        glTexCoord2f(1,1); glVertex3f( x_max, y_max, 0.1f );
+        glTexCoord2f(0,1); glVertex3f( x_min, y_max, 0.1f );
     glEnd();
+    density_tex.Disable();
 }
 
 // draw fitting cubic curve
@@ -23,11 +23,29 @@
 
 #include <GL/oglCommon.h>
 
+#include <math.h>
+
 SmallMultiples::SmallMultiples(oglWidgets::oglFont &_font ) {
     font = &_font;
     mouse_x = mouse_y = FLT_MAX;
     selX = selY = 0;
     mouse_selX = mouse_selY = -1;
+    mouse_plot = -1;
+    rank_measure = -1;
+    rank_count = 16;
+}
+
+void SmallMultiples::SetRanking( int measure, int K ){
+    rank_measure = measure;
+    rank_count = SCI::Max( 1, K );
+    ranked.clear();
+    for(int i = 0; i < (int)sp.size(); i++){
+        sp[i].Reset();
+    }
+}
+
+int SmallMultiples::GetRankingMeasure( ){
+    return rank_measure;
 }
 
 void SmallMultiples::SetMouse( float mx, float my ){
@@ -61,82 +79,105 @@ void SmallMultiples::ProgressiveReset(){
     }
 }
 
-bool SmallMultiples::ProgressiveDraw( DataIndirector & data ){
+int SmallMultiples::Layout( DataIndirector & data, float sel_width ){
 
     float startX = -0.95f;
     float endX   =  0.80f;
     float startY = -0.95f;
     float endY   =  0.85f;
 
+    std::vector< std::pair<int,int> > all;
+    const std::vector< std::pair<int,int> > * pairs = &ranked;
+    if( rank_measure < 0 ){
+        for(int i = 0; i < data.GetDim(); i++){
+            for(int j = 0; j < i; j++){
+                all.push_back( std::make_pair(i,j) );
+            }
+        }
+        pairs = &all;
+    }
+
+    // Ranked plots fill a near square grid right of the large scatter plot
+    int   cols   = (int)ceilf( sqrtf( (float)pairs->size() ) );
+    int   rows   = ( cols > 0 ) ? ( (int)pairs->size() + cols - 1 ) / cols : 0;
+    float rstartX = -0.10f;
+    float rendX   =  0.95f;
+    float rscaleX = (rendX-rstartX)/(float)SCI::Max(cols,1);
+    float rscaleY = (endY-startY)/(float)SCI::Max(rows,1);
+
     float scaleX = (endX-startX)/(float)(data.GetDim()-1);
     float scaleY = (endY-startY)/(float)(data.GetDim()-0);
 
     mouse_selX = mouse_selY = -1;
+    mouse_plot = -1;
 
-    bool draw_anything = false;
-
-    for(int i = 0, k = 0; i < data.GetDim(); i++){
-        for(int j = 0; j < i; j++, k++){
-            if(k >= (int)sp.size()) sp.push_back( ScatterPlot(*font) );
+    for(int k = 0; k < (int)pairs->size(); k++){
+        int i = (*pairs)[k].first;
+        int j = (*pairs)[k].second;
+        if(k >= (int)sp.size()) sp.push_back( ScatterPlot(*font) );
+        if( rank_measure < 0 ){
             sp[k].SetCenter(startX+((float)i-1.0f+0.5f)*scaleX,startY+((float)j+0.5f)*scaleY);
             sp[k].SetSize(0.9f*scaleX,0.9f*scaleY);
+        }
+        else{
+            sp[k].SetCenter(rstartX+((float)(k%cols)+0.5f)*rscaleX,endY-((float)(k/cols)+0.5f)*rscaleY);
+            sp[k].SetSize(0.9f*rscaleX,0.8f*rscaleY);
+        }
+        sp[k].SetBorderWidth(1.0f);
+        sp[k].SetBorderColor(0.0f,0.0f,0.0f);
+        if( sp[k].DistanceToObject( mouse_x, mouse_y ) < 0.00001f ){
+            mouse_selX = i;
+            mouse_selY = j;
+            mouse_plot = k;
             sp[k].SetBorderWidth(1.0f);
-            sp[k].SetBorderColor(0.0f,0.0f,0.0f);
-            if( sp[k].DistanceToObject( mouse_x, mouse_y ) < 0.00001f ){
-                mouse_selX = i;
-                mouse_selY = j;
-                sp[k].SetBorderWidth(1.0f);
-                sp[k].SetBorderColor(1.0f,0.0f,0.0f);
-            }
-            if( selX == i && selY == j ){
-                sp[k].SetBorderWidth(2.0f);
-                sp[k].SetBorderColor(1.0f,0.0f,0.0f);
-            }
-            sp[k].Set( data, i, j, false );
-            //sp[k].SetAspect( aspect );
-            draw_anything = sp[k].ProgressiveDraw() || draw_anything;
-
+            sp[k].SetBorderColor(1.0f,0.0f,0.0f);
+        }
+        if( selX == i && selY == j ){
+            sp[k].SetBorderWidth(sel_width);
+            sp[k].SetBorderColor(1.0f,0.0f,0.0f);
         }
+        sp[k].Set( data, i, j, false );
+        //sp[k].SetAspect( aspect );
     }
 
-    return draw_anything;
-
+    return (int)pairs->size();
 }
 
-void SmallMultiples::ProgressiveBorder( DataIndirector & data ){
+bool SmallMultiples::ProgressiveDraw( DataIndirector & data, ProgressiveScheduler * scheduler, int view ){
 
-    float startX = -0.95f;
-    float endX   =  0.80f;
-    float startY = -0.95f;
-    float endY   =  0.85f;
+    // Ranking is refreshed once per frame, so enabled and swapped dimensions are followed
+    if( rank_measure >= 0 ){
+        data.GetTopPairs( rank_measure, rank_count, ranked );
+    }
 
-    float scaleX = (endX-startX)/(float)(data.GetDim()-1);
-    float scaleY = (endY-startY)/(float)(data.GetDim()-0);
+    bool draw_anything = false;
 
-    mouse_selX = mouse_selY = -1;
+    int plotN = Layout( data, 2.0f );
+    for(int o = -1; o < plotN; o++){
+        int k = ( o < 0 ) ? mouse_plot : o;
+        if( k < 0 || ( o >= 0 && k == mouse_plot ) ) continue;
+
+        int left = sp[k].GetRemaining();
+        int rows = scheduler ? scheduler->Grant( view, 0, left ) : left;
+        if( rows == 0 ){
+            // out of time, the rest waits for the next frame
+            if( left > 0 ) break;
+            continue;
+        }
+        int drawn = sp[k].ProgressiveDraw( rows );
+        if( scheduler ) scheduler->Done( view, 0, drawn );
+        draw_anything = draw_anything || drawn > 0;
+    }
 
-    for(int i = 0, k = 0; i < data.GetDim(); i++){
-        for(int j = 0; j < i; j++, k++){
-            if(k >= (int)sp.size()) sp.push_back( ScatterPlot(*font) );
-            sp[k].SetCenter(startX+((float)i-1.0f+0.5f)*scaleX,startY+((float)j+0.5f)*scaleY);
-            sp[k].SetSize(0.9f*scaleX,0.9f*scaleY);
-            sp[k].SetBorderWidth(1.0f);
-            sp[k].SetBorderColor(0.0f,0.0f,0.0f);
-            if( sp[k].DistanceToObject( mouse_x, mouse_y ) < 0.00001f ){
-                mouse_selX = i;
-                mouse_selY = j;
-                sp[k].SetBorderWidth(1.0f);
-                sp[k].SetBorderColor(1.0f,0.0f,0.0f);
-            }
-            if( selX == i && selY == j ){
-                sp[k].SetBorderWidth(3.0f);
-                sp[k].SetBorderColor(1.0f,0.0f,0.0f);
-            }
-            sp[k].Set( data, i, j, false );
-            //sp[k].SetAspect( aspect );
-            sp[k].ProgressiveBorder();
+    return draw_anything;
 
-        }
+}
+
+void SmallMultiples::ProgressiveBorder( DataIndirector & data ){
+
+    int plotN = Layout( data, 3.0f );
+    for(int k = 0; k < plotN; k++){
+        sp[k].ProgressiveBorder();
     }
 }
 
@@ -158,6 +199,29 @@ void SmallMultiples::ProgressiveLabels(float aspect, DataIndirector & data ){
     text.SetSize( 0.05f );
     text.SetAspect( aspect );
 
+    if( rank_measure >= 0 ){
+        text.SetCenter( 0.425f );
+        text.SetBottom( endY + 0.02f );
+        text.SetTextf( "Top %i pairs by %s", (int)ranked.size(), Data::Scagnostics::GetMeasureName( rank_measure ) );
+        text.Draw();
+
+        // Each plot is named below its own cell
+        int   cols    = (int)ceilf( sqrtf( (float)ranked.size() ) );
+        int   rows    = ( cols > 0 ) ? ( (int)ranked.size() + cols - 1 ) / cols : 0;
+        float rscaleX = (0.95f+0.10f)/(float)SCI::Max(cols,1);
+        float rscaleY = (endY-startY)/(float)SCI::Max(rows,1);
+        text.SetSize( SCI::Min( 0.035f, 0.08f*rscaleY ) );
+        for(int k = 0; k < (int)ranked.size(); k++){
+            int i = ranked[k].first;
+            int j = ranked[k].second;
+            text.SetCenter( -0.10f+((float)(k%cols)+0.5f)*rscaleX );
+            text.SetTop( endY-((float)(k/cols)+0.9f)*rscaleY );
+            text.SetTextf( "%s / %s  %.2f", data.GetLabelParsed(i).c_str(), data.GetLabelParsed(j).c_str(), data.GetScagnostic( i, j, rank_measure ) );
+            text.Draw();
+        }
+        return;
+    }
+
 
     glColor3f(0,0,0);
     glPushMatrix();
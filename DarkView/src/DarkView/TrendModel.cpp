@@ -0,0 +1,345 @@
+/*
+**  Data Scalable Approach for Parallel Coordinates
+**  Copyright (C) 2016 - Hoa Nguyen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <DarkView/TrendModel.h>
+#include <Data/Cluster1D.h>
+#include <algorithm>
+#include <math.h>
+
+// intersection point between line (x1,y1),(x2,y2) and line (x3,y3),(x4,y4)
+static bool Intersect(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, float & xi, float & yi)
+{
+    float d = (x1 - x2)*(y3 - y4) - (y1 - y2)*(x3 - x4);
+
+    // if d = 0 then there is no intersection point
+    if (d == 0)
+        return false;
+
+    float p = x1*y2 - y1*x2;
+    float q = x3*y4 - y3*x4;
+
+    float x = (p*(x3 - x4) - (x1 - x2)*q)/d;
+    float y = (p*(y3 - y4) - (y1 - y2)*q)/d;
+
+    // check if x and y coordinates are in both lines
+    if (x < std::min(x1, x2) || x > std::max(x1, x2) || x < std::min(x3, x4) || x > std::max(x3, x4))
+        return false;
+    if (y < std::min(y1, y2) || y > std::max(y1, y2) || y < std::min(y3, y4) || y > std::max(y3, y4))
+        return false;
+
+    xi = x;
+    yi = y;
+    return true;
+}
+
+// angle in degrees of the vector (xs, ys)
+static float Angle(float xs, float ys)
+{
+    float sA = 0.0f;
+    float pi = 3.14159265f;
+
+    if (xs < 0 && ys < 0)
+        sA = atan(fabsf(ys/xs))*180/pi;
+    else if (xs > 0 && ys < 0)
+        sA = 180 - (atan(fabsf(ys/xs))*180/pi);
+    else if (xs > 0 && ys > 0)
+        sA = (atan(fabsf(ys/xs))*180/pi) + 180;
+    else if (xs < 0 && ys > 0)
+        sA = 360 - (atan(fabsf(ys/xs))*180/pi);
+    return sA;
+}
+
+static float Distance(float x1, float y1, float x2, float y2)
+{
+    return sqrtf((y1 - y2)*(y1 - y2) + (x1 - x2)*(x1 - x2));
+}
+
+// Clusters of the values v, k at most 3, numbered from the largest values
+// down as the groups expect. Large sets are binned first.
+static void KMeans(const std::vector<float> & v, int k, std::vector<int> & cluster)
+{
+    Data::Cluster1D clustering;
+    clustering.Compute(v, std::min(k, 3), (v.size() > 16384) ? 1024 : 0);
+
+    int n = (int)v.size();
+    int last = clustering.GetClusterCount() - 1;
+    cluster.assign(n, 0);
+    for (int i = 0; i < n; i++)
+        cluster[i] = last - clustering.GetLabels()[i];
+}
+
+static void ResetGroup(TrendModel::Group & group, float range)
+{
+    group.ints.clear();
+    group.radius.clear();
+    group.minX = range;
+    group.maxX = -range;
+    group.minY = range;
+    group.maxY = -range;
+}
+
+static void ExtendGroup(TrendModel::Group & group, float px, float py)
+{
+    if (group.minX > px)
+        group.minX = px;
+    if (group.maxX < px)
+        group.maxX = px;
+    if (group.maxY < py)
+        group.maxY = py;
+    if (group.minY > py)
+        group.minY = py;
+}
+
+bool TrendModel::Key::operator<( const Key & other ) const
+{
+    if (d0 != other.d0) return d0 < other.d0;
+    if (d1 != other.d1) return d1 < other.d1;
+    if (k != other.k) return k < other.k;
+    if (negClusters != other.negClusters) return negClusters < other.negClusters;
+    if (posClusters != other.posClusters) return posClusters < other.posClusters;
+    return sample < other.sample;
+}
+
+TrendModel::TrendModel()
+{
+    range = 0;
+    correlation = 0;
+    groupSize = 0;
+    hasNeg = 0;
+    hasPos = 0;
+    for (int g = 0; g < 3; g++)
+    {
+        ResetGroup(neg[g], 0);
+        ResetGroup(pos[g], 0);
+    }
+}
+
+void TrendModel::Compute( const std::vector<float> & _x, const std::vector<float> & _y, const std::vector<int> & _neighbors, int stride, int _groupSize,
+                          const Data::LocalPCA2D & pca, float cor, int negClusters, int posClusters, float _range )
+{
+    int n = (int)_x.size();
+
+    range = _range;
+    correlation = cor;
+    x = _x;
+    y = _y;
+    groupSize = _groupSize;
+    neighbors.resize(n*groupSize);
+    for (int i = 0; i < n; i++)
+        for (int t = 0; t < groupSize; t++)
+            neighbors[i*groupSize + t] = _neighbors[i*stride + t];
+
+    meanX  = pca.meanX;
+    meanY  = pca.meanY;
+    majorX = pca.majorX;
+    majorY = pca.majorY;
+
+    trend.assign(n, 0);
+    hasNeg = 0;
+    hasPos = 0;
+    for (int g = 0; g < 3; g++)
+    {
+        ResetGroup(neg[g], range);
+        ResetGroup(pos[g], range);
+    }
+
+    // intersection of every point with the lines of its neighbourhood
+    std::vector< std::pair<float,float> > ints(n);
+    std::vector<float> radius(n, 0.0f);
+    std::vector<bool>  hasInts(n, false);
+
+    for (int i = 0; i < n; i++)
+    {
+        float mean[2] = { pca.meanX[i],  pca.meanY[i]  };
+        float pc0[2]  = { pca.majorX[i], pca.majorY[i] };
+        float pc1[2]  = { pca.minorX[i], pca.minorY[i] };
+
+        // find the points tval along the primary (xpc0, ypc0) and secondary (xpc1, ypc1) PCA vectors
+        float tval = 0.03f;
+        float xpc0 = mean[0], ypc0 = mean[1];
+        float xpc1 = mean[0], ypc1 = mean[1];
+        if (pc0[0] == 0 && pc0[1] != 0)
+            ypc0 = mean[1] + tval;
+        if (pc0[1] == 0 && pc0[0] != 0)
+            xpc0 = mean[0] + tval;
+        if (pc0[0] != 0 && pc0[1] != 0)
+        {
+            float b0 = pc0[0]*mean[1] - pc0[1]*mean[0];
+            xpc0 = mean[0] + tval;
+            ypc0 = (pc0[1]*xpc0 + b0)/pc0[0];
+        }
+        if (pc1[0] == 0 && pc1[1] != 0)
+            ypc1 = mean[1] + tval;
+        if (pc1[1] == 0 && pc1[0] != 0)
+            xpc1 = mean[0] + tval;
+        if (pc1[0] != 0 && pc1[1] != 0)
+        {
+            float b1 = pc1[0]*mean[1] - pc1[1]*mean[0];
+            xpc1 = mean[0] + tval;
+            ypc1 = (pc1[1]*xpc1 + b1)/pc1[0];
+        }
+
+        float px = _x[i];
+        float py = _y[i];
+
+        float eigenVal1 = Distance(px, py, xpc1, ypc1);
+        float eigenVal0 = Distance(px, py, xpc0, ypc0);
+        radius[i] = 0.03f*eigenVal0/eigenVal1;
+
+        // the direction of the primary PCA vector decides the trend
+        float angl = Angle(px - xpc0, py - ypc0);
+        float xi = 0, yi = 0;
+        if (angl <= 90 || (angl > 180 && angl <= 270))
+        {
+            trend[i] = 1;
+            hasPos = 1;
+            hasInts[i] = Intersect(0, py, 1, xpc0, 1, px, 0, ypc0, xi, yi);
+        }
+        else
+        {
+            trend[i] = -1;
+            hasNeg = 1;
+            hasInts[i] = Intersect(0, py, 1, px, 0, ypc0, 1, xpc0, xi, yi)
+                         && xi < 1 && xi > 0 && yi < range && yi > -range;
+        }
+        ints[i] = std::make_pair(xi, yi);
+    }
+
+    if (cor > 0.94f)
+    {
+        hasNeg = 0;
+        hasPos = 1;
+    }
+    if (cor < -0.94f)
+    {
+        hasNeg = 1;
+        hasPos = 0;
+    }
+
+    // negative points in order along the right axis, grouped by location there
+    std::vector< std::pair<float,int> > negOrder;
+    for (int i = 0; i < n; i++)
+        if (trend[i] < 0)
+            negOrder.push_back(std::make_pair(_x[i], i));
+    std::sort(negOrder.begin(), negOrder.end());
+
+    if (hasNeg > 0 && !negOrder.empty())
+    {
+        std::vector<float> v(negOrder.size());
+        for (int s = 0; s < (int)negOrder.size(); s++)
+            v[s] = negOrder[s].first;
+
+        std::vector<int> cluster;
+        KMeans(v, negClusters, cluster);
+        hasNeg = std::max(1, std::min(negClusters, 3));
+
+        // the second cluster is the first group
+        static const int group[3] = { 1, 0, 2 };
+        for (int s = 0; s < (int)negOrder.size(); s++)
+        {
+            int i = negOrder[s].second;
+            Group & g = neg[ group[ cluster[s] ] ];
+            ExtendGroup(g, _x[i], _y[i]);
+            if (hasInts[i])
+            {
+                g.ints.push_back(ints[i]);
+                g.radius.push_back(radius[i]);
+            }
+        }
+    }
+    else
+        hasNeg = 0;
+
+    // positive points in sample order, clustered the same way
+    std::vector<int> posIndex;
+    for (int i = 0; i < n; i++)
+        if (trend[i] > 0)
+            posIndex.push_back(i);
+
+    if (hasPos > 0 && !posIndex.empty())
+    {
+        std::vector<float> v(posIndex.size());
+        for (int s = 0; s < (int)posIndex.size(); s++)
+            v[s] = _x[ posIndex[s] ];
+
+        std::vector<int> cluster;
+        KMeans(v, posClusters, cluster);
+
+        for (int s = 0; s < (int)posIndex.size(); s++)
+        {
+            int i = posIndex[s];
+            if (hasInts[i])
+            {
+                pos[0].ints.push_back(ints[i]);
+                pos[0].radius.push_back(radius[i]);
+            }
+            ExtendGroup(pos[0], _x[i], _y[i]);
+
+            // only two positive clusters are drawn
+            if (cluster[s] > 1)
+                continue;
+            Group & g = pos[ cluster[s] + 1 ];
+            ExtendGroup(g, _x[i], _y[i]);
+            if (hasInts[i])
+            {
+                g.ints.push_back(ints[i]);
+                g.radius.push_back(radius[i]);
+            }
+        }
+    }
+    else
+        hasPos = 0;
+}
+
+void TrendModel::Envelope( float minX, float maxX, float maxY, float minY, int segments, std::vector<float> & upper, std::vector<float> & lower ) const
+{
+    upper.assign(segments+1, -1.0f);
+    lower.assign(segments+1, 1.0f);
+
+    // each line in the box as its start on the left axis and its slope
+    std::vector<float> start, slope;
+    for (int i = 0; i < (int)x.size(); i++)
+    {
+        if (x[i] >= minX && x[i] <= maxX && y[i] <= maxY && y[i] >= minY)
+        {
+            start.push_back(y[i]);
+            slope.push_back(x[i] - y[i]);
+        }
+    }
+    int m = (int)start.size();
+    if (m == 0 || segments <= 0)
+        return;
+
+    // one column at a time, a min/max over contiguous arrays
+    const float * s0 = &start[0];
+    const float * s1 = &slope[0];
+    for (int i = 0; i <= segments; i++)
+    {
+        float t = (float)i/segments;
+        float hi = -1.0f;
+        float lo = 1.0f;
+        for (int p = 0; p < m; p++)
+        {
+            float v = s0[p] + t*s1[p];
+            hi = v > hi ? v : hi;
+            lo = v < lo ? v : lo;
+        }
+        upper[i] = hi;
+        lower[i] = lo;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/ArtifactGraph.h>
+
+#include <stdio.h>
+
+using namespace Data;
+
+ArtifactGraph::ArtifactGraph( ) : clock(0) { }
+
+void ArtifactGraph::Clear( ){
+    nodes.clear();
+}
+
+void ArtifactGraph::Touch( const std::string & key ){
+    Node & node = nodes[key];
+    node.version = ++clock;
+    node.inputs.clear();
+}
+
+void ArtifactGraph::Built( const std::string & key, const std::vector<std::string> & inputs ){
+    Node & node = nodes[key];
+    node.inputs.clear();
+    for(int i = 0; i < (int)inputs.size(); i++){
+        node.inputs.push_back( std::make_pair( inputs[i], GetVersion( inputs[i] ) ) );
+    }
+    node.version = ++clock;
+}
+
+bool ArtifactGraph::IsStale( const std::string & key, const std::vector<std::string> & inputs ) const {
+    std::map<std::string,Node>::const_iterator it = nodes.find( key );
+    if( it == nodes.end() ) return true;
+
+    const Node & node = it->second;
+    if( node.inputs.size() != inputs.size() ) return true;
+    for(int i = 0; i < (int)inputs.size(); i++){
+        if( node.inputs[i].first != inputs[i] ) return true;
+    }
+    return IsStale( key );
+}
+
+bool ArtifactGraph::IsStale( const std::string & key ) const {
+    std::map<std::string,Node>::const_iterator it = nodes.find( key );
+    if( it == nodes.end() ) return true;
+
+    const Node & node = it->second;
+    for(int i = 0; i < (int)node.inputs.size(); i++){
+        const std::string & input = node.inputs[i].first;
+        if( GetVersion( input ) != node.inputs[i].second ) return true;
+        if( IsStale( input ) ) return true;
+    }
+    return false;
+}
+
+unsigned int ArtifactGraph::GetVersion( const std::string & key ) const {
+    std::map<std::string,Node>::const_iterator it = nodes.find( key );
+    if( it == nodes.end() ) return 0;
+    return it->second.version;
+}
+
+std::string ArtifactGraph::Key( const char * name, int a, int b ){
+    char buf[64];
+    if( b >= 0 )      sprintf( buf, "%.40s/%i/%i", name, a, b );
+    else if( a >= 0 ) sprintf( buf, "%.40s/%i", name, a );
+    else              sprintf( buf, "%.40s", name );
+    return std::string( buf );
+}
@@ -0,0 +1,176 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/AxisOrdering.h>
+
+#include <algorithm>
+
+using namespace Data;
+
+// smallest gain taken as an improvement, so rounding cannot cycle
+static const double minGain = 1e-6;
+
+AxisOrdering::AxisOrdering( ) : n(0), total(0) { }
+
+void AxisOrdering::Clear( ){
+    n = 0;
+    score.clear();
+    order.clear();
+    total = 0;
+}
+
+float AxisOrdering::Score( int a, int b ) const {
+    return score[a*n+b];
+}
+
+void AxisOrdering::Start( const std::vector<float> & _score, int _n ){
+    Clear();
+    n     = _n;
+    score = _score;
+    if( n <= 0 ) return;
+    if( n == 1 ){
+        order.push_back( 0 );
+        return;
+    }
+
+    // the best pair, then the best free axis at either end of the path
+    int a = 0, b = 1;
+    for(int i = 0; i < n; i++){
+        for(int j = i+1; j < n; j++){
+            if( Score(i,j) > Score(a,b) ){ a = i; b = j; }
+        }
+    }
+
+    std::vector<char> used( n, 0 );
+    std::vector<int>  head, tail;
+    tail.push_back( a );
+    tail.push_back( b );
+    used[a] = used[b] = 1;
+
+    for(int step = 2; step < n; step++){
+        int left  = head.empty() ? tail.front() : head.back();
+        int right = tail.back();
+        int bl = -1, br = -1;
+        for(int c = 0; c < n; c++){
+            if( used[c] ) continue;
+            if( bl < 0 || Score(left,c)  > Score(left,bl) )  bl = c;
+            if( br < 0 || Score(right,c) > Score(right,br) ) br = c;
+        }
+        if( Score(right,br) >= Score(left,bl) ){
+            tail.push_back( br );
+            used[br] = 1;
+        }
+        else{
+            head.push_back( bl );
+            used[bl] = 1;
+        }
+    }
+
+    order.assign( head.rbegin(), head.rend() );
+    order.insert( order.end(), tail.begin(), tail.end() );
+    Total();
+}
+
+bool AxisOrdering::Improve( ){
+    if( n < 3 ) return false;
+    bool reversed = TwoOpt();
+    bool moved    = OrOpt();
+    Total();
+    return reversed || moved;
+}
+
+// reverse order[i..j] when the two new neighbours score better
+bool AxisOrdering::TwoOpt( ){
+    bool improved = false;
+    for(int i = 0; i < n-1; i++){
+        for(int j = i+1; j < n; j++){
+            if( i == 0 && j == n-1 ) continue;
+            double gain = 0;
+            if( i > 0 )   gain += Score( order[i-1], order[j] ) - Score( order[i-1], order[i] );
+            if( j < n-1 ) gain += Score( order[i], order[j+1] ) - Score( order[j], order[j+1] );
+            if( gain > minGain ){
+                std::reverse( order.begin()+i, order.begin()+j+1 );
+                improved = true;
+            }
+        }
+    }
+    return improved;
+}
+
+// move order[i..i+len-1], maybe reversed, to the best other place
+bool AxisOrdering::OrOpt( ){
+    bool improved = false;
+    for(int len = 1; len <= 3 && len < n; len++){
+        for(int i = 0; i+len <= n; i++){
+            int a    = order[i];
+            int b    = order[i+len-1];
+            int prev = ( i > 0 )       ? order[i-1]   : -1;
+            int next = ( i+len < n )   ? order[i+len] : -1;
+
+            double base = 0;
+            if( prev >= 0 )              base -= Score( prev, a );
+            if( next >= 0 )              base -= Score( b, next );
+            if( prev >= 0 && next >= 0 ) base += Score( prev, next );
+
+            // place k: before order[0] for -1, after order[n-1] for n-1,
+            // otherwise between order[k] and order[k+1]
+            double best = minGain;
+            int    bestK = -2;
+            bool   bestRev = false;
+            for(int k = -1; k < n; k++){
+                if( k >= i-1 && k < i+len ) continue;
+                double g, r;
+                if( k == -1 ){
+                    g = Score( b, order[0] );
+                    r = Score( a, order[0] );
+                }
+                else if( k == n-1 ){
+                    g = Score( order[n-1], a );
+                    r = Score( order[n-1], b );
+                }
+                else{
+                    int q = order[k], s = order[k+1];
+                    g = Score( q, a ) + Score( b, s ) - Score( q, s );
+                    r = Score( q, b ) + Score( a, s ) - Score( q, s );
+                }
+                if( base + g > best ){ best = base + g; bestK = k; bestRev = false; }
+                if( base + r > best ){ best = base + r; bestK = k; bestRev = true; }
+            }
+            if( bestK == -2 ) continue;
+
+            std::vector<int> seg( order.begin()+i, order.begin()+i+len );
+            if( bestRev ) std::reverse( seg.begin(), seg.end() );
+            order.erase( order.begin()+i, order.begin()+i+len );
+            int at = ( bestK < i ) ? bestK+1 : bestK+1-len;
+            order.insert( order.begin()+at, seg.begin(), seg.end() );
+            improved = true;
+        }
+    }
+    return improved;
+}
+
+void AxisOrdering::Total( ){
+    total = 0;
+    for(int i = 0; i+1 < (int)order.size(); i++){
+        total += Score( order[i], order[i+1] );
+    }
+}
+
+const std::vector<int> & AxisOrdering::GetOrder( ) const { return order; }
+
+double AxisOrdering::GetScore( ) const { return total; }
@@ -0,0 +1,143 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/BinnedColumns.h>
+#include <Data/PhysicsData.h>
+
+using namespace Data;
+
+BinnedColumns::BinnedColumns( ) : bins(0), dimN(0), elemN(0), baseN(0) { }
+
+void BinnedColumns::Clear( ){
+    bins  = 0;
+    dimN  = 0;
+    elemN = 0;
+    baseN = 0;
+    lo.clear();
+    hi.clear();
+    tables.clear();
+    codes.clear();
+}
+
+void BinnedColumns::Build( PhysicsData & data, int _bins, Binning binning ){
+    Clear();
+
+    const ColumnHistogram & hist = data.GetHistogram();
+
+    bins  = SCI::Max( 1, SCI::Min( _bins, 256 ) );
+    dimN  = data.GetDim();
+    elemN = data.GetElementCount();
+    codes.resize( dimN );
+    tables.resize( dimN );
+    lo.resize( dimN );
+    hi.resize( dimN );
+
+    baseN = hist.GetBaseBins();
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int d = 0; d < dimN; d++){
+        // Code of each base histogram bin
+        std::vector<SCI::UINT8> & table = tables[d];
+        table.assign( baseN, 0 );
+        lo[d] = hist.GetMinimumValue( d );
+        hi[d] = hist.GetMaximumValue( d );
+        const SCI::INT64 * base = hist.GetBaseCounts( d );
+        SCI::INT64 cum = 0;
+        for(int s = 0; s < baseN; s++){
+            int code;
+            if( binning == QUANTILE ){
+                // rank of the middle of the base bin
+                double mid = (double)cum + 0.5 * (double)base[s];
+                code = ( elemN > 0 ) ? (int)( mid * bins / elemN ) : 0;
+            }
+            else{
+                code = (int)( (SCI::INT64)s * bins / baseN );
+            }
+            table[s] = (SCI::UINT8)SCI::Max( 0, SCI::Min( code, bins-1 ) );
+            cum += base[s];
+        }
+
+        std::vector<float> col = data.ExtractDimension( d );
+        codes[d].resize( col.size() );
+        for(int i = 0; i < (int)col.size(); i++){
+            codes[d][i] = table[ hist.GetBaseBin( d, col[i] ) ];
+        }
+    }
+}
+
+// the base bin of the histogram the columns were built from
+int BinnedColumns::BaseBin( int dim, float val ) const {
+    float range = hi[dim] - lo[dim];
+    if( !( range > 0 ) || !( val > lo[dim] ) ) return 0;
+    int b = (int)( (double)( val - lo[dim] ) / range * baseN );
+    return SCI::Min( b, baseN-1 );
+}
+
+void BinnedColumns::Append( const float * elem ){
+    for(int d = 0; d < dimN; d++){
+        codes[d].push_back( tables[d][ BaseBin( d, elem[d] ) ] );
+    }
+    elemN++;
+}
+
+int BinnedColumns::GetBins( ) const { return bins; }
+
+int BinnedColumns::GetDimension( ) const { return dimN; }
+
+int BinnedColumns::GetElementCount( ) const { return elemN; }
+
+float BinnedColumns::GetMinimumValue( int dim ) const { return lo[dim]; }
+
+float BinnedColumns::GetMaximumValue( int dim ) const { return hi[dim]; }
+
+const SCI::UINT8 * BinnedColumns::GetCodes( int dim ) const {
+    if( dim < 0 || dim >= dimN || codes[dim].empty() ) return 0;
+    return &codes[dim][0];
+}
+
+void BinnedColumns::GetJoint( int dim_x, int dim_y, std::vector<SCI::UINT32> & counts ) const {
+    int BB = bins*bins;
+    counts.assign( BB, 0 );
+
+    const SCI::UINT8 * cx = GetCodes( dim_x );
+    const SCI::UINT8 * cy = GetCodes( dim_y );
+    if( cx == 0 || cy == 0 ) return;
+
+    // Four partial tables so runs of the same cell do not serialize on one counter
+    std::vector<SCI::UINT32> part( 4*BB, 0 );
+    SCI::UINT32 * p0 = &part[0];
+    SCI::UINT32 * p1 = p0 + BB;
+    SCI::UINT32 * p2 = p1 + BB;
+    SCI::UINT32 * p3 = p2 + BB;
+
+    int n = (int)codes[dim_x].size();
+    int i = 0;
+    for( ; i+3 < n; i += 4 ){
+        p0[ cx[i  ]*bins + cy[i  ] ]++;
+        p1[ cx[i+1]*bins + cy[i+1] ]++;
+        p2[ cx[i+2]*bins + cy[i+2] ]++;
+        p3[ cx[i+3]*bins + cy[i+3] ]++;
+    }
+    for( ; i < n; i++ ){
+        p0[ cx[i]*bins + cy[i] ]++;
+    }
+
+    for(int b = 0; b < BB; b++){
+        counts[b] = p0[b] + p1[b] + p2[b] + p3[b];
+    }
+}
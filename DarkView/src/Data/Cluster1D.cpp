@@ -0,0 +1,212 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/Cluster1D.h>
+
+#include <algorithm>
+#include <float.h>
+
+using namespace Data;
+
+namespace {
+
+    // Dynamic program over m weighted points in increasing order. Row c
+    // holds, for every i, the cost of the best c+1 clusters of points 0..i
+    // and where the last of them starts. That start never moves left as i
+    // grows, so each row is filled by divide and conquer.
+    struct Program {
+        std::vector<double> W, S, Q;        // prefix sums of w, w*v, w*v*v
+        std::vector<double> prev, cur;
+        std::vector<int>    start;          // row c at c*m
+        int                 m;
+        int                 row;
+
+        Program( const std::vector<double> & w, const std::vector<double> & v ) : m( (int)w.size() ), row(0) {
+            W.assign( m+1, 0.0 );
+            S.assign( m+1, 0.0 );
+            Q.assign( m+1, 0.0 );
+            for(int i = 0; i < m; i++){
+                W[i+1] = W[i] + w[i];
+                S[i+1] = S[i] + w[i]*v[i];
+                Q[i+1] = Q[i] + w[i]*v[i]*v[i];
+            }
+        }
+
+        // sum of squares of points a..b around their mean
+        double Cost( int a, int b ) const {
+            double w = W[b+1] - W[a];
+            double s = S[b+1] - S[a];
+            double q = Q[b+1] - Q[a];
+            double c = q - s*s/w;
+            return ( c > 0 ) ? c : 0;
+        }
+
+        void Fill( int lo, int hi, int optlo, int opthi ){
+            if( lo > hi ) return;
+            int    mid   = ( lo + hi ) / 2;
+            int    bestj = std::max( row, optlo );
+            double best  = DBL_MAX;
+            for(int j = bestj; j <= std::min( mid, opthi ); j++){
+                double d = prev[j-1] + Cost( j, mid );
+                if( d < best ){
+                    best  = d;
+                    bestj = j;
+                }
+            }
+            cur[mid] = best;
+            start[row*m + mid] = bestj;
+            Fill( lo, mid-1, optlo, bestj );
+            Fill( mid+1, hi, bestj, opthi );
+        }
+
+        // bounds[c] is the first point of cluster c, for k clusters
+        void Solve( int k, std::vector<int> & bounds ){
+            start.assign( k*m, 0 );
+            prev.assign( m, DBL_MAX );
+            for(int i = 0; i < m; i++){
+                prev[i] = Cost( 0, i );
+            }
+            for(row = 1; row < k; row++){
+                cur.assign( m, DBL_MAX );
+                Fill( row, m-1, row, m-1 );
+                prev.swap( cur );
+            }
+
+            bounds.assign( k, 0 );
+            int i = m-1;
+            for(int c = k-1; c >= 0; c--){
+                bounds[c] = start[c*m + i];
+                i = bounds[c] - 1;
+            }
+        }
+    };
+
+}
+
+Cluster1D::Cluster1D( ) : withinss(0) { }
+
+void Cluster1D::Clear( ){
+    labels.clear();
+    center.clear();
+    minV.clear();
+    maxV.clear();
+    size.clear();
+    withinss = 0;
+}
+
+void Cluster1D::Compute( const std::vector<float> & values, int k, int bins ){
+    Clear();
+
+    int n = (int)values.size();
+    if( n == 0 ) return;
+    k = std::max( k, 1 );
+
+    std::vector< std::pair<float,int> > order( n );
+    for(int i = 0; i < n; i++){
+        order[i] = std::make_pair( values[i], i );
+    }
+    std::sort( order.begin(), order.end() );
+
+    float  lo    = order[0].first;
+    float  hi    = order[n-1].first;
+    double shift = 0.5 * ( (double)lo + (double)hi );
+
+    // distinct values, or equal width bins, become weighted points
+    std::vector<int> point( n );
+    int distinct = 1;
+    for(int s = 1; s < n; s++){
+        if( order[s].first != order[s-1].first ) distinct++;
+    }
+    bool binned = ( bins > 0 && distinct > bins && hi > lo );
+
+    std::vector<double> w, v;
+    int key = -1;
+    for(int s = 0; s < n; s++){
+        int cur = s;
+        if( binned ){
+            cur = (int)( (double)( order[s].first - lo ) / ( hi - lo ) * bins );
+            cur = std::min( cur, bins-1 );
+        }
+        else if( s > 0 && order[s].first == order[s-1].first ){
+            cur = key;
+        }
+        if( s == 0 || cur != key ){
+            w.push_back( 0 );
+            v.push_back( 0 );
+            key = cur;
+        }
+        w.back() += 1;
+        v.back() += (double)order[s].first - shift;
+        point[s] = (int)w.size() - 1;
+    }
+    for(int p = 0; p < (int)w.size(); p++){
+        v[p] /= w[p];
+    }
+
+    int kk = std::min( k, (int)w.size() );
+    std::vector<int> bounds;
+    Program program( w, v );
+    program.Solve( kk, bounds );
+
+    // label the values and measure the clusters on the values themselves
+    labels.assign( n, 0 );
+    center.assign( kk, 0.0f );
+    minV.assign( kk, 0.0f );
+    maxV.assign( kk, 0.0f );
+    size.assign( kk, 0 );
+
+    int c = 0;
+    int first = 0;
+    for(int s = 0; s <= n; s++){
+        if( s < n && ( c+1 >= kk || point[s] < bounds[c+1] ) ){
+            labels[ order[s].second ] = c;
+            continue;
+        }
+
+        double sum = 0;
+        for(int t = first; t < s; t++){ sum += (double)order[t].first - shift; }
+        double mean = sum / ( s - first );
+        for(int t = first; t < s; t++){
+            double d = (double)order[t].first - shift - mean;
+            withinss += d*d;
+        }
+        center[c] = (float)( mean + shift );
+        minV[c]   = order[first].first;
+        maxV[c]   = order[s-1].first;
+        size[c]   = s - first;
+
+        if( s == n ) break;
+        c++;
+        first = s;
+        labels[ order[s].second ] = c;
+    }
+}
+
+int Cluster1D::GetClusterCount( ) const { return (int)center.size(); }
+
+const std::vector<int> & Cluster1D::GetLabels( ) const { return labels; }
+
+float Cluster1D::GetCenter( int cluster ) const { return center[cluster]; }
+
+float Cluster1D::GetMin( int cluster ) const { return minV[cluster]; }
+
+float Cluster1D::GetMax( int cluster ) const { return maxV[cluster]; }
+
+int Cluster1D::GetSize( int cluster ) const { return size[cluster]; }
+
+double Cluster1D::GetWithinSS( ) const { return withinss; }
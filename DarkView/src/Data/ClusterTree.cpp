@@ -0,0 +1,364 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/ClusterTree.h>
+#include <Data/PhysicsData.h>
+
+#include <algorithm>
+#include <float.h>
+#include <queue>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+using namespace Data;
+
+// rows of a node the k-means of its split runs on
+static const int splitSample = 2048;
+static const int splitIterations = 8;
+
+namespace {
+
+    // Rows coded one byte per column, row major, with the ranges of the
+    // codes, and the rows of every node as a range of one permutation
+    struct Rows {
+        int                      dimN;
+        std::vector<SCI::UINT8>  code;
+        std::vector<float>       lo, hi;
+        std::vector<int>         order;
+        std::vector<int>         begin, end;     // per node
+
+        const SCI::UINT8 * Row( int r ) const { return &code[ (size_t)r*dimN ]; }
+
+        float Distance( const SCI::UINT8 * row, const float * center ) const {
+            float d = 0;
+            for(int c = 0; c < dimN; c++){
+                float t = (float)row[c] - center[c];
+                d += t*t;
+            }
+            return d;
+        }
+
+        // bounds receives the start of each child in order, and the end
+        void Split( int node, int branch, int leaf, unsigned int seed, bool rowsParallel, std::vector<int> & bounds ){
+            bounds.clear();
+            int a = begin[node];
+            int b = end[node];
+            int m = b - a;
+            if( m <= leaf || m < 2 ) return;
+
+            // k-means on an even sample of the rows
+            int stride = std::max( 1, m / splitSample );
+            std::vector<int> sample;
+            for(int s = a; s < b; s += stride) sample.push_back( order[s] );
+            int k = std::min( branch, (int)sample.size() );
+
+            // k-means++ seeding
+            std::vector<float> center( (size_t)k*dimN );
+            std::vector<float> nearest( sample.size(), FLT_MAX );
+            int pick = (int)( seed % sample.size() );
+            for(int c = 0; c < k; c++){
+                const SCI::UINT8 * row = Row( sample[pick] );
+                for(int d = 0; d < dimN; d++) center[c*dimN+d] = (float)row[d];
+
+                double total = 0;
+                for(int s = 0; s < (int)sample.size(); s++){
+                    nearest[s] = std::min( nearest[s], Distance( Row( sample[s] ), &center[c*dimN] ) );
+                    total += nearest[s];
+                }
+                if( !( total > 0 ) ){ k = c+1; break; }
+                seed = seed * 1664525u + 1013904223u;
+                double target = (double)( seed >> 8 ) / (double)( 1u << 24 ) * total;
+                pick = (int)sample.size() - 1;
+                for(int s = 0; s < (int)sample.size(); s++){
+                    target -= nearest[s];
+                    if( target <= 0 ){ pick = s; break; }
+                }
+            }
+            if( k < 2 ) return;
+
+            std::vector<int>    label( sample.size(), 0 );
+            std::vector<double> sum( (size_t)k*dimN );
+            std::vector<int>    size( k );
+            for(int it = 0; it < splitIterations; it++){
+                std::fill( sum.begin(), sum.end(), 0.0 );
+                std::fill( size.begin(), size.end(), 0 );
+                for(int s = 0; s < (int)sample.size(); s++){
+                    const SCI::UINT8 * row = Row( sample[s] );
+                    label[s] = Nearest( row, &center[0], k );
+                    size[ label[s] ]++;
+                    for(int d = 0; d < dimN; d++) sum[ label[s]*dimN+d ] += row[d];
+                }
+                for(int c = 0; c < k; c++){
+                    if( size[c] == 0 ) continue;
+                    for(int d = 0; d < dimN; d++) center[c*dimN+d] = (float)( sum[c*dimN+d] / size[c] );
+                }
+            }
+
+            // every row of the node to its nearest center
+            std::vector<SCI::UINT8> rowLabel( m );
+            #pragma omp parallel for schedule(static) if(rowsParallel)
+            for(int s = 0; s < m; s++){
+                rowLabel[s] = (SCI::UINT8)Nearest( Row( order[a+s] ), &center[0], k );
+            }
+
+            std::vector<int> count( k, 0 );
+            for(int s = 0; s < m; s++) count[ rowLabel[s] ]++;
+            int used = 0;
+            for(int c = 0; c < k; c++) if( count[c] > 0 ) used++;
+            if( used < 2 ) return;
+
+            std::vector<int> at( k, 0 );
+            bounds.push_back( a );
+            for(int c = 0, cum = 0; c < k; c++){
+                at[c] = cum;
+                cum  += count[c];
+                if( count[c] > 0 ) bounds.push_back( a + cum );
+            }
+            std::vector<int> moved( m );
+            for(int s = 0; s < m; s++) moved[ at[ rowLabel[s] ]++ ] = order[a+s];
+            std::copy( moved.begin(), moved.end(), order.begin()+a );
+        }
+
+        int Nearest( const SCI::UINT8 * row, const float * center, int k ) const {
+            int   best  = 0;
+            float bestd = FLT_MAX;
+            for(int c = 0; c < k; c++){
+                float d = Distance( row, center + c*dimN );
+                if( d < bestd ){ bestd = d; best = c; }
+            }
+            return best;
+        }
+    };
+
+}
+
+ClusterTree::ClusterTree( ) : dimN(0) { }
+
+void ClusterTree::Clear( ){
+    dimN = 0;
+    nodes.clear();
+    centroid.clear();
+    minV.clear();
+    maxV.clear();
+}
+
+void ClusterTree::Build( PhysicsData & data, int branch, int levels, int leaf ){
+    Clear();
+
+    int n = data.GetElementCount();
+    dimN  = data.GetDim();
+    if( n <= 0 || dimN <= 0 ){
+        dimN = 0;
+        return;
+    }
+    branch = std::max( 2, std::min( branch, 255 ) );
+
+    Rows rows;
+    rows.dimN = dimN;
+    rows.code.resize( (size_t)n*dimN );
+    rows.lo.resize( dimN );
+    rows.hi.resize( dimN );
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int d = 0; d < dimN; d++){
+        std::vector<float> col = data.ExtractDimension( d );
+        float lo = FLT_MAX, hi = -FLT_MAX;
+        for(int i = 0; i < n; i++){
+            lo = std::min( lo, col[i] );
+            hi = std::max( hi, col[i] );
+        }
+        float scale = ( hi > lo ) ? 256.0f / ( hi - lo ) : 0.0f;
+        for(int i = 0; i < n; i++){
+            int c = (int)( ( col[i] - lo ) * scale );
+            rows.code[ (size_t)i*dimN + d ] = (SCI::UINT8)std::max( 0, std::min( c, 255 ) );
+        }
+        rows.lo[d] = lo;
+        rows.hi[d] = hi;
+    }
+
+    rows.order.resize( n );
+    for(int i = 0; i < n; i++) rows.order[i] = i;
+
+    Node root;
+    root.parent   = -1;
+    root.first    = 0;
+    root.children = 0;
+    root.depth    = 0;
+    root.count    = n;
+    nodes.push_back( root );
+    rows.begin.push_back( 0 );
+    rows.end.push_back( n );
+
+    int threads = 1;
+    #ifdef _OPENMP
+        threads = omp_get_max_threads();
+    #endif
+
+    std::vector<int> level( 1, 0 );
+    for(int depth = 0; depth < levels && !level.empty(); depth++){
+        std::vector< std::vector<int> > bounds( level.size() );
+        bool rowsParallel = (int)level.size() < threads;
+
+        #pragma omp parallel for schedule(dynamic) if(!rowsParallel)
+        for(int l = 0; l < (int)level.size(); l++){
+            rows.Split( level[l], branch, leaf, 2166136261u ^ (unsigned int)level[l], rowsParallel, bounds[l] );
+        }
+
+        std::vector<int> next;
+        for(int l = 0; l < (int)level.size(); l++){
+            const std::vector<int> & b = bounds[l];
+            if( b.size() < 3 ) continue;
+            Node & parent    = nodes[ level[l] ];
+            parent.first     = (int)nodes.size();
+            parent.children  = (int)b.size() - 1;
+            for(int c = 0; c+1 < (int)b.size(); c++){
+                Node child;
+                child.parent   = level[l];
+                child.first    = 0;
+                child.children = 0;
+                child.depth    = depth+1;
+                child.count    = b[c+1] - b[c];
+                next.push_back( (int)nodes.size() );
+                nodes.push_back( child );
+                rows.begin.push_back( b[c] );
+                rows.end.push_back( b[c+1] );
+            }
+        }
+        level.swap( next );
+    }
+
+    // centroid and extent of every node from its rows
+    int N = (int)nodes.size();
+    centroid.assign( (size_t)N*dimN, 0.0f );
+    minV.assign( (size_t)N*dimN, 0.0f );
+    maxV.assign( (size_t)N*dimN, 0.0f );
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int node = 0; node < N; node++){
+        std::vector<double>     sum( dimN, 0.0 );
+        std::vector<SCI::UINT8> cmin( dimN, 255 ), cmax( dimN, 0 );
+        for(int s = rows.begin[node]; s < rows.end[node]; s++){
+            const SCI::UINT8 * row = rows.Row( rows.order[s] );
+            for(int d = 0; d < dimN; d++){
+                sum[d] += row[d];
+                cmin[d] = std::min( cmin[d], row[d] );
+                cmax[d] = std::max( cmax[d], row[d] );
+            }
+        }
+        double cnt = (double)std::max( 1, rows.end[node] - rows.begin[node] );
+        for(int d = 0; d < dimN; d++){
+            float step = ( rows.hi[d] - rows.lo[d] ) / 256.0f;
+            centroid[ (size_t)node*dimN+d ] = std::min( rows.hi[d], rows.lo[d] + (float)( sum[d] / cnt + 0.5 ) * step );
+            minV[ (size_t)node*dimN+d ]     = rows.lo[d] + (float)cmin[d] * step;
+            maxV[ (size_t)node*dimN+d ]     = std::min( rows.hi[d], rows.lo[d] + (float)( cmax[d] + 1 ) * step );
+        }
+    }
+}
+
+bool ClusterTree::Save( const char * fname, SCI::UINT64 stamp ) const {
+    if( nodes.empty() ) return false;
+    FILE * outfile = fopen( fname, "wb" );
+    if( !outfile ) return false;
+
+    int header[3] = { dimN, (int)nodes[0].count, (int)nodes.size() };
+    bool ok = fwrite( "DVCT", 1, 4, outfile ) == 4
+           && fwrite( &stamp, sizeof(stamp), 1, outfile ) == 1
+           && fwrite( header, sizeof(int), 3, outfile ) == 3
+           && fwrite( &nodes[0], sizeof(Node), nodes.size(), outfile ) == nodes.size()
+           && fwrite( &centroid[0], sizeof(float), centroid.size(), outfile ) == centroid.size()
+           && fwrite( &minV[0], sizeof(float), minV.size(), outfile ) == minV.size()
+           && fwrite( &maxV[0], sizeof(float), maxV.size(), outfile ) == maxV.size();
+    fclose( outfile );
+    return ok;
+}
+
+bool ClusterTree::Load( const char * fname, SCI::UINT64 stamp, int dim, int count ){
+    Clear();
+    FILE * infile = fopen( fname, "rb" );
+    if( !infile ) return false;
+
+    char        magic[4];
+    SCI::UINT64 fstamp = 0;
+    int         header[3] = { 0, 0, 0 };
+    bool ok = fread( magic, 1, 4, infile ) == 4 && memcmp( magic, "DVCT", 4 ) == 0
+           && fread( &fstamp, sizeof(fstamp), 1, infile ) == 1 && fstamp == stamp
+           && fread( header, sizeof(int), 3, infile ) == 3
+           && header[0] == dim && header[1] == count && header[2] > 0;
+    if( ok ){
+        dimN = header[0];
+        nodes.resize( header[2] );
+        centroid.resize( (size_t)header[2]*dimN );
+        minV.resize( centroid.size() );
+        maxV.resize( centroid.size() );
+        ok = fread( &nodes[0], sizeof(Node), nodes.size(), infile ) == nodes.size()
+          && fread( &centroid[0], sizeof(float), centroid.size(), infile ) == centroid.size()
+          && fread( &minV[0], sizeof(float), minV.size(), infile ) == minV.size()
+          && fread( &maxV[0], sizeof(float), maxV.size(), infile ) == maxV.size();
+    }
+    fclose( infile );
+    if( !ok ) Clear();
+    return ok;
+}
+
+int ClusterTree::GetDimension( ) const { return dimN; }
+
+int ClusterTree::GetNodeCount( ) const { return (int)nodes.size(); }
+
+int ClusterTree::GetParent( int node ) const { return nodes[node].parent; }
+
+int ClusterTree::GetChildCount( int node ) const { return nodes[node].children; }
+
+int ClusterTree::GetChild( int node, int i ) const { return nodes[node].first + i; }
+
+int ClusterTree::GetDepth( int node ) const { return nodes[node].depth; }
+
+SCI::INT64 ClusterTree::GetCount( int node ) const { return nodes[node].count; }
+
+const float * ClusterTree::GetCentroid( int node ) const { return &centroid[ (size_t)node*dimN ]; }
+
+const float * ClusterTree::GetMinimum( int node ) const { return &minV[ (size_t)node*dimN ]; }
+
+const float * ClusterTree::GetMaximum( int node ) const { return &maxV[ (size_t)node*dimN ]; }
+
+void ClusterTree::GetCut( int budget, const std::vector<float> & boost, std::vector<int> & cut ) const {
+    cut.clear();
+    if( nodes.empty() ) return;
+
+    std::priority_queue< std::pair<double,int> > open;
+    open.push( std::make_pair( 0.0, 0 ) );
+    while( !open.empty() ){
+        int node = open.top().second;
+        open.pop();
+
+        // splitting replaces the node by its children in the cut
+        const Node & nd = nodes[node];
+        if( nd.children == 0 || (int)( cut.size() + open.size() ) + nd.children > budget ){
+            cut.push_back( node );
+            continue;
+        }
+        for(int c = nd.first; c < nd.first + nd.children; c++){
+            double w = (double)nodes[c].count;
+            if( c < (int)boost.size() ) w *= boost[c];
+            open.push( std::make_pair( w, c ) );
+        }
+    }
+}
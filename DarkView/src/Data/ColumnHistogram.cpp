@@ -0,0 +1,287 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/ColumnHistogram.h>
+#include <Data/PhysicsData.h>
+
+#include <complex>
+#include <algorithm>
+#include <math.h>
+#include <float.h>
+
+using namespace Data;
+
+typedef std::complex<double> Complex;
+
+// In-place iterative radix-2 FFT, the size must be a power of two
+static void FFT( std::vector<Complex> & a, bool inverse ){
+    int n = (int)a.size();
+
+    for(int i = 1, j = 0; i < n; i++){
+        int bit = n >> 1;
+        for( ; j & bit; bit >>= 1 ){ j ^= bit; }
+        j ^= bit;
+        if( i < j ) std::swap( a[i], a[j] );
+    }
+
+    for(int len = 2; len <= n; len <<= 1){
+        double  ang = 2.0 * 3.14159265358979323846 / len * ( inverse ? 1 : -1 );
+        Complex wlen( cos(ang), sin(ang) );
+        for(int i = 0; i < n; i += len){
+            Complex w( 1, 0 );
+            for(int j = 0; j < len/2; j++){
+                Complex u = a[i+j];
+                Complex v = a[i+j+len/2] * w;
+                a[i+j]         = u + v;
+                a[i+j+len/2]   = u - v;
+                w *= wlen;
+            }
+        }
+    }
+}
+
+ColumnHistogram::ColumnHistogram( ) : dimN(0), levels(0), count(0), version(0) { }
+
+void ColumnHistogram::Clear( ){
+    dimN   = 0;
+    levels = 0;
+    count  = 0;
+    min_dval.clear();
+    max_dval.clear();
+    pyramid.clear();
+    version++;
+}
+
+void ColumnHistogram::Build( PhysicsData & data, int _levels ){
+    Clear();
+
+    levels = SCI::Max( 0, SCI::Min( _levels, 20 ) );
+    dimN   = data.GetDim();
+    count  = data.GetElementCount();
+
+    min_dval.resize( dimN );
+    max_dval.resize( dimN );
+    for(int d = 0; d < dimN; d++){
+        min_dval[d] = data.GetMinimumValue( d );
+        max_dval[d] = data.GetMaximumValue( d );
+    }
+
+    pyramid.assign( dimN, std::vector<SCI::INT64>( ( 2 << levels ) - 1, 0 ) );
+
+    int base = ( 1 << levels ) - 1;
+
+    std::vector<SCI::UINT64> prints( dimN );
+    #pragma omp parallel for schedule(dynamic)
+    for(int d = 0; d < dimN; d++){
+        std::vector<float>        col  = data.ExtractDimension( d );
+        std::vector<SCI::INT64> & tree = pyramid[d];
+        for(int i = 0; i < (int)col.size(); i++){
+            tree[ base + GetBaseBin( d, col[i] ) ]++;
+        }
+        Propagate( tree );
+        prints[d] = Fingerprint( d );
+    }
+    Restamp( prints );
+}
+
+// FNV-1a of the range and the finest counts, never 0
+SCI::UINT64 ColumnHistogram::Fingerprint( int dim ) const {
+    SCI::UINT64 h = 14695981039346656037ULL;
+    const unsigned char * p[3] = { (const unsigned char*)&min_dval[dim], (const unsigned char*)&max_dval[dim], (const unsigned char*)GetBaseCounts( dim ) };
+    size_t                n[3] = { sizeof(float), sizeof(float), sizeof(SCI::INT64) * ( (size_t)1 << levels ) };
+    for(int s = 0; s < 3; s++){
+        for(size_t i = 0; i < n[s]; i++){
+            h = ( h ^ p[s][i] ) * 1099511628211ULL;
+        }
+    }
+    return ( h == 0 ) ? 1 : h;
+}
+
+// The columns whose fingerprint moved get a new version
+void ColumnHistogram::Restamp( const std::vector<SCI::UINT64> & prints ){
+    dim_version.resize( dimN, 0 );
+    dim_print.resize( dimN, 0 );
+    for(int d = 0; d < dimN; d++){
+        if( dim_print[d] == 0 || dim_print[d] != prints[d] ){
+            dim_version[d] = ++version;
+        }
+        dim_print[d] = prints[d];
+    }
+}
+
+int ColumnHistogram::GetBaseBin( int dim, float val ) const {
+    int   binN  = 1 << levels;
+    float range = max_dval[dim] - min_dval[dim];
+    if( !( range > 0 ) || !( val > min_dval[dim] ) ) return 0;
+    if( !( val < max_dval[dim] ) ) return binN-1;
+    int b = (int)( (double)( val - min_dval[dim] ) / range * binN );
+    return SCI::Min( b, binN-1 );
+}
+
+void ColumnHistogram::Propagate( std::vector<SCI::INT64> & tree ){
+    for(int i = ( 1 << levels ) - 2; i >= 0; i--){
+        tree[i] = tree[2*i+1] + tree[2*i+2];
+    }
+}
+
+void ColumnHistogram::AddColumns( const float * values, SCI::INT64 rows, SCI::INT64 weight ){
+    if( dimN == 0 || rows <= 0 ) return;
+
+    int base = ( 1 << levels ) - 1;
+
+    std::vector<SCI::UINT64> prints( dimN );
+    #pragma omp parallel for schedule(dynamic)
+    for(int d = 0; d < dimN; d++){
+        const float             * col  = values + (size_t)d * rows;
+        std::vector<SCI::INT64> & tree = pyramid[d];
+        for(SCI::INT64 i = 0; i < rows; i++){
+            tree[ base + GetBaseBin( d, col[i] ) ] += weight;
+        }
+        Propagate( tree );
+        prints[d] = Fingerprint( d );
+    }
+    count += weight * rows;
+    version++;
+    Restamp( prints );
+}
+
+void ColumnHistogram::RemoveColumns( const float * values, SCI::INT64 rows ){
+    AddColumns( values, rows, -1 );
+}
+
+int ColumnHistogram::GetDimension( ) const { return dimN; }
+
+int ColumnHistogram::GetBaseBins( ) const { return ( dimN == 0 ) ? 0 : ( 1 << levels ); }
+
+SCI::INT64 ColumnHistogram::GetCount( ) const { return count; }
+
+unsigned int ColumnHistogram::GetVersion( ) const { return version; }
+
+unsigned int ColumnHistogram::GetVersion( int dim ) const {
+    if( dim < 0 || dim >= dimN || dim >= (int)dim_version.size() ) return 0;
+    return dim_version[dim];
+}
+
+const SCI::INT64 * ColumnHistogram::GetBaseCounts( int dim ) const {
+    if( dim < 0 || dim >= dimN ) return 0;
+    return &pyramid[dim][ ( 1 << levels ) - 1 ];
+}
+
+float ColumnHistogram::GetMinimumValue( int dim ) const {
+    if( dim < 0 || dim >= dimN ) return FLT_MAX;
+    return min_dval[dim];
+}
+
+float ColumnHistogram::GetMaximumValue( int dim ) const {
+    if( dim < 0 || dim >= dimN ) return FLT_MAX;
+    return max_dval[dim];
+}
+
+void ColumnHistogram::GetHistogram( int dim, int bins, std::vector<float> & out ) const {
+    out.assign( SCI::Max( bins, 0 ), 0.0f );
+    if( bins <= 0 || dim < 0 || dim >= dimN ) return;
+
+    // Coarsest level with at least as many bins as requested
+    int l = 0;
+    while( l < levels && ( 1 << l ) < bins ){ l++; }
+
+    int                srcN = 1 << l;
+    const SCI::INT64 * src  = &pyramid[dim][ srcN - 1 ];
+
+    if( srcN == bins ){
+        for(int b = 0; b < bins; b++){ out[b] = (float)src[b]; }
+        return;
+    }
+
+    // Split each source bin over the output bins it overlaps
+    for(int s = 0; s < srcN; s++){
+        if( src[s] == 0 ) continue;
+        double lo = (double)s     * bins / srcN;
+        double hi = (double)(s+1) * bins / srcN;
+        int    b0 = (int)lo;
+        int    b1 = SCI::Min( bins-1, (int)ceil(hi) - 1 );
+        for(int b = b0; b <= b1; b++){
+            double overlap = std::min( hi, (double)(b+1) ) - std::max( lo, (double)b );
+            out[b] += (float)( src[s] * overlap / ( hi - lo ) );
+        }
+    }
+}
+
+void ColumnHistogram::GetDensity( int dim, int bins, std::vector<float> & out, float bandwidth ) const {
+    out.assign( SCI::Max( bins, 0 ), 0.0f );
+    if( bins <= 0 || dim < 0 || dim >= dimN || count <= 0 ) return;
+
+    double range = (double)max_dval[dim] - (double)min_dval[dim];
+    if( !( range > 0 ) ){
+        out[bins/2] = 1.0f;
+        return;
+    }
+
+    double delta = range / bins;
+
+    // The counts in the output bins, from the coarsest pyramid level that
+    // has at least as many bins
+    std::vector<float> grid;
+    GetHistogram( dim, bins, grid );
+
+    double h = bandwidth;
+    if( !( h > 0 ) ){
+        // Silverman's rule from the moments and quartiles of the bins
+        double n = (double)count, mean = 0, var = 0;
+        for(int j = 0; j < bins; j++){ mean += grid[j] * ( j + 0.5 ); }
+        mean /= n;
+        for(int j = 0; j < bins; j++){ var += grid[j] * ( j + 0.5 - mean ) * ( j + 0.5 - mean ); }
+        double sigma = sqrt( var / n ) * delta;
+
+        double q1 = -1, q3 = -1, cum = 0;
+        for(int j = 0; j < bins; j++){
+            cum += (double)grid[j];
+            if( q1 < 0 && cum >= 0.25 * n ) q1 = j;
+            if( q3 < 0 && cum >= 0.75 * n ) q3 = j;
+        }
+        double spread = ( q3 - q1 ) * delta / 1.34;
+        if( spread > 0 && spread < sigma ) sigma = spread;
+
+        h = 0.9 * sigma * pow( n, -0.2 );
+    }
+    h = std::max( h, delta );
+
+    // Zero padding keeps the circular convolution from wrapping around
+    int L = SCI::Min( bins-1, (int)ceil( 4.0 * h / delta ) );
+    int P = 1;
+    while( P < bins + L ){ P <<= 1; }
+
+    std::vector<Complex> fg( P, Complex(0,0) );
+    std::vector<Complex> fk( P, Complex(0,0) );
+    for(int j = 0; j < bins; j++){ fg[j] = grid[j]; }
+
+    double norm = 1.0 / ( h * sqrt( 2.0 * 3.14159265358979323846 ) );
+    for(int j = -L; j <= L; j++){
+        double u = j * delta / h;
+        fk[ ( j + P ) % P ] = norm * exp( -0.5 * u * u );
+    }
+
+    FFT( fg, false );
+    FFT( fk, false );
+    for(int j = 0; j < P; j++){ fg[j] *= fk[j]; }
+    FFT( fg, true );
+
+    for(int j = 0; j < bins; j++){
+        out[j] = (float)std::max( 0.0, fg[j].real() / P / (double)count );
+    }
+}
@@ -0,0 +1,174 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/ColumnStatistics.h>
+
+#include <math.h>
+#include <float.h>
+
+using namespace Data;
+
+ColumnStatistics::ColumnStatistics( int _dimN ){
+    Reset( _dimN );
+}
+
+void ColumnStatistics::Reset( int _dimN ){
+    count = 0;
+    dimN  = _dimN;
+    mean.assign( dimN, 0.0 );
+    comoment.assign( dimN*dimN, 0.0 );
+    min_dval.assign( dimN,  FLT_MAX );
+    max_dval.assign( dimN, -FLT_MAX );
+}
+
+void ColumnStatistics::AddColumns( const float * values, SCI::INT64 rows ){
+    if( rows <= 0 || dimN == 0 ) return;
+
+    // Two pass statistics of the block, then merged into the running totals
+    ColumnStatistics block( dimN );
+    block.count = rows;
+
+    for(int d = 0; d < dimN; d++){
+        const float * col = values + d*rows;
+        double sum = 0;
+        for(SCI::INT64 i = 0; i < rows; i++){
+            sum += col[i];
+            block.min_dval[d] = SCI::Min( block.min_dval[d], col[i] );
+            block.max_dval[d] = SCI::Max( block.max_dval[d], col[i] );
+        }
+        block.mean[d] = sum / (double)rows;
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < dimN; i++){
+        const float * ci = values + i*rows;
+        double        mi = block.mean[i];
+        for(int j = i; j < dimN; j++){
+            const float * cj = values + j*rows;
+            double        mj = block.mean[j];
+            double sum = 0;
+            for(SCI::INT64 r = 0; r < rows; r++){
+                sum += ( ci[r] - mi ) * ( cj[r] - mj );
+            }
+            block.comoment[i*dimN+j] = sum;
+            block.comoment[j*dimN+i] = sum;
+        }
+    }
+
+    Merge( block );
+}
+
+void ColumnStatistics::Merge( const ColumnStatistics & other ){
+    if( other.count == 0 ) return;
+    if( count == 0 ){
+        *this = other;
+        return;
+    }
+    if( other.dimN != dimN ) return;
+
+    double na = (double)count;
+    double nb = (double)other.count;
+    double n  = na + nb;
+
+    std::vector<double> delta( dimN );
+    for(int d = 0; d < dimN; d++){
+        delta[d] = other.mean[d] - mean[d];
+    }
+
+    for(int i = 0; i < dimN; i++){
+        for(int j = 0; j < dimN; j++){
+            comoment[i*dimN+j] += other.comoment[i*dimN+j] + delta[i] * delta[j] * na * nb / n;
+        }
+    }
+
+    for(int d = 0; d < dimN; d++){
+        mean[d]    += delta[d] * nb / n;
+        min_dval[d] = SCI::Min( min_dval[d], other.min_dval[d] );
+        max_dval[d] = SCI::Max( max_dval[d], other.max_dval[d] );
+    }
+
+    count += other.count;
+}
+
+SCI::INT64 ColumnStatistics::GetCount( ) const { return count; }
+
+int ColumnStatistics::GetDimension( ) const { return dimN; }
+
+double ColumnStatistics::GetMean( int dim ) const {
+    if( dim < 0 || dim >= dimN ) return 0;
+    return mean[dim];
+}
+
+double ColumnStatistics::GetVariance( int dim ) const {
+    if( dim < 0 || dim >= dimN || count == 0 ) return 0;
+    return comoment[dim*dimN+dim] / (double)count;
+}
+
+float ColumnStatistics::GetMinimumValue( int dim ) const {
+    if( dim < 0 || dim >= dimN ) return FLT_MAX;
+    return min_dval[dim];
+}
+
+float ColumnStatistics::GetMaximumValue( int dim ) const {
+    if( dim < 0 || dim >= dimN ) return FLT_MAX;
+    return max_dval[dim];
+}
+
+double ColumnStatistics::GetCorrelation( int dim_x, int dim_y ) const {
+    if( dim_x < 0 || dim_x >= dimN || dim_y < 0 || dim_y >= dimN ) return 0;
+
+    double num  = comoment[dim_x*dimN+dim_y];
+    double denx = comoment[dim_x*dimN+dim_x];
+    double deny = comoment[dim_y*dimN+dim_y];
+
+    if( ::fabs(num) < 1.0e-100 || denx < 1.0e-100 || deny < 1.0e-100 ) return 0;
+
+    return num / ( sqrt(denx) * sqrt(deny) );
+}
+
+bool ColumnStatistics::Overlaps( int dim, float lo, float hi ) const {
+    if( count == 0 ) return false;
+    if( dim < 0 || dim >= dimN ) return true;
+    return max_dval[dim] >= lo && min_dval[dim] <= hi;
+}
+
+bool ColumnStatistics::Write( FILE * outfile ) const {
+    SCI::INT64 hdr[2] = { count, dimN };
+    if( fwrite( hdr, sizeof(SCI::INT64), 2, outfile ) != 2 ) return false;
+    if( dimN == 0 ) return true;
+    if( fwrite( &mean[0],     sizeof(double), dimN,      outfile ) != (size_t)dimN )        return false;
+    if( fwrite( &comoment[0], sizeof(double), dimN*dimN, outfile ) != (size_t)(dimN*dimN) ) return false;
+    if( fwrite( &min_dval[0], sizeof(float),  dimN,      outfile ) != (size_t)dimN )        return false;
+    if( fwrite( &max_dval[0], sizeof(float),  dimN,      outfile ) != (size_t)dimN )        return false;
+    return true;
+}
+
+bool ColumnStatistics::Read( FILE * infile ){
+    SCI::INT64 hdr[2];
+    if( fread( hdr, sizeof(SCI::INT64), 2, infile ) != 2 ) return false;
+    if( hdr[0] < 0 || hdr[1] < 0 || hdr[1] > 65536 ) return false;
+
+    Reset( (int)hdr[1] );
+    count = hdr[0];
+    if( dimN == 0 ) return true;
+    if( fread( &mean[0],     sizeof(double), dimN,      infile ) != (size_t)dimN )        return false;
+    if( fread( &comoment[0], sizeof(double), dimN*dimN, infile ) != (size_t)(dimN*dimN) ) return false;
+    if( fread( &min_dval[0], sizeof(float),  dimN,      infile ) != (size_t)dimN )        return false;
+    if( fread( &max_dval[0], sizeof(float),  dimN,      infile ) != (size_t)dimN )        return false;
+    return true;
+}
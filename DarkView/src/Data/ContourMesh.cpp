@@ -0,0 +1,202 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/ContourMesh.h>
+
+#include <math.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+    #include <xmmintrin.h>
+    #define CONTOUR_SSE
+#endif
+
+using namespace Data;
+
+namespace {
+
+    // Marching triangles over one iso level. Crossing vertices are made
+    // the first time an edge is cut, so neighbouring triangles share them.
+    struct Cutter {
+        const std::vector<float> & field;
+        float                      iso;
+        int                        rows;
+        std::vector<float>       & vertices;
+        std::vector<unsigned int>& indices;
+        std::vector<int>           cross;
+
+        Cutter( const std::vector<float> & _field, float _iso, int _rows, std::vector<float> & _vertices, std::vector<unsigned int> & _indices )
+            : field(_field), iso(_iso), rows(_rows), vertices(_vertices), indices(_indices), cross( 3*_field.size(), -1 ) { }
+
+        // vertex where the edge between grid vertices p and q reaches iso
+        unsigned int Crossing( unsigned int p, unsigned int q ){
+            unsigned int lo = ( p < q ) ? p : q;
+            unsigned int hi = ( p < q ) ? q : p;
+            unsigned int diff = hi - lo;
+            int type = ( diff == 1 ) ? 1 : ( ( diff == (unsigned int)rows ) ? 0 : 2 );
+            int & id = cross[ 3*lo + type ];
+            if( id < 0 ){
+                float r = ( iso - field[lo] ) / ( field[hi] - field[lo] );
+                id = (int)( vertices.size() / 2 );
+                vertices.push_back( (1-r)*vertices[2*lo]   + r*vertices[2*hi]   );
+                vertices.push_back( (1-r)*vertices[2*lo+1] + r*vertices[2*hi+1] );
+            }
+            return (unsigned int)id;
+        }
+
+        void Triangle( unsigned int a, unsigned int b, unsigned int c ){
+            indices.push_back( a );
+            indices.push_back( b );
+            indices.push_back( c );
+        }
+
+        void Cut( unsigned int p0, unsigned int p1, unsigned int p2 ){
+            bool in0 = field[p0] > iso;
+            bool in1 = field[p1] > iso;
+            bool in2 = field[p2] > iso;
+            int  inside = (int)in0 + (int)in1 + (int)in2;
+
+            if( inside == 0 ) return;
+            if( inside == 3 ){
+                Triangle( p0, p1, p2 );
+                return;
+            }
+
+            // rotate, keeping the winding, so p0 is the odd one out
+            if( ( inside == 1 && in1 ) || ( inside == 2 && !in1 ) ){
+                unsigned int t = p0; p0 = p1; p1 = p2; p2 = t;
+            }
+            else if( ( inside == 1 && in2 ) || ( inside == 2 && !in2 ) ){
+                unsigned int t = p0; p0 = p2; p2 = p1; p1 = t;
+            }
+
+            if( inside == 1 ){
+                Triangle( p0, Crossing( p0, p1 ), Crossing( p0, p2 ) );
+            }
+            else{
+                unsigned int c1 = Crossing( p0, p1 );
+                unsigned int c2 = Crossing( p2, p0 );
+                Triangle( p1, p2, c2 );
+                Triangle( p1, c2, c1 );
+            }
+        }
+    };
+
+}
+
+ContourMesh::ContourMesh( ) : columns(0), rows(0) { }
+
+void ContourMesh::Clear( ){
+    columns = 0;
+    rows    = 0;
+    gx.clear();
+    gy.clear();
+    vertices.clear();
+    field.clear();
+}
+
+void ContourMesh::SetGrid( const std::vector<float> & x, const std::vector<float> & y, int _columns, int _rows ){
+    columns = _columns;
+    rows    = _rows;
+    gx      = x;
+    gy      = y;
+
+    vertices.resize( 2*gx.size() );
+    for(int v = 0; v < (int)gx.size(); v++){
+        vertices[2*v]   = gx[v];
+        vertices[2*v+1] = gy[v];
+    }
+    field.assign( gx.size(), 0.0f );
+}
+
+void ContourMesh::AddInverseDistance( const std::vector< std::pair<float,float> > & source, const std::vector<float> & radius ){
+    const int band = 256;
+    int N      = (int)field.size();
+    int bandN  = ( N + band - 1 ) / band;
+    int sN     = (int)source.size();
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int b = 0; b < bandN; b++){
+        int v0 = b * band;
+        int v1 = ( v0 + band < N ) ? v0 + band : N;
+        const float * px = &gx[0];
+        const float * py = &gy[0];
+        float       * pf = &field[0];
+
+        for(int s = 0; s < sN; s++){
+            float sx = source[s].first;
+            float sy = source[s].second;
+            float r2 = radius[s] * radius[s];
+            int v = v0;
+#ifdef CONTOUR_SSE
+            __m128 vsx = _mm_set1_ps( sx );
+            __m128 vsy = _mm_set1_ps( sy );
+            __m128 vr2 = _mm_set1_ps( r2 );
+            __m128 one = _mm_set1_ps( 1.0f );
+            for( ; v + 3 < v1; v += 4 ){
+                __m128 dx = _mm_sub_ps( _mm_loadu_ps( px + v ), vsx );
+                __m128 dy = _mm_sub_ps( _mm_loadu_ps( py + v ), vsy );
+                __m128 d2 = _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) );
+                __m128 in = _mm_cmplt_ps( d2, vr2 );
+                __m128 w  = _mm_and_ps( in, _mm_div_ps( one, _mm_sqrt_ps( d2 ) ) );
+                _mm_storeu_ps( pf + v, _mm_add_ps( _mm_loadu_ps( pf + v ), w ) );
+            }
+#endif
+            for( ; v < v1; v++ ){
+                float dx = px[v] - sx;
+                float dy = py[v] - sy;
+                float d2 = dx*dx + dy*dy;
+                if( d2 < r2 ) pf[v] += 1.0f / sqrtf( d2 );
+            }
+        }
+    }
+}
+
+int ContourMesh::GetColumns( ) const { return columns; }
+
+int ContourMesh::GetRows( ) const { return rows; }
+
+const std::vector<float> & ContourMesh::GetVertices( ) const { return vertices; }
+
+const std::vector<float> & ContourMesh::GetField( ) const { return field; }
+
+void ContourMesh::GetTriangles( std::vector<unsigned int> & indices ) const {
+    indices.clear();
+    for(int i = 0; i+1 < columns; i++){
+        for(int j = 0; j+1 < rows; j++){
+            unsigned int a = i*rows + j;
+            unsigned int b = a + rows;
+            indices.push_back( a );     indices.push_back( b );     indices.push_back( b+1 );
+            indices.push_back( a );     indices.push_back( b+1 );   indices.push_back( a+1 );
+        }
+    }
+}
+
+void ContourMesh::Extract( float iso, std::vector<float> & out, std::vector<unsigned int> & indices ) const {
+    out = vertices;
+    indices.clear();
+
+    Cutter cut( field, iso, rows, out, indices );
+    for(int i = 0; i+1 < columns; i++){
+        for(int j = 0; j+1 < rows; j++){
+            unsigned int a = i*rows + j;
+            unsigned int b = a + rows;
+            cut.Cut( a, b, b+1 );
+            cut.Cut( a, b+1, a+1 );
+        }
+    }
+}
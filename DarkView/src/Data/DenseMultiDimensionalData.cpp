@@ -23,11 +23,12 @@
 
 using namespace Data;
 
-DenseMultiDimensionalData::DenseMultiDimensionalData( int _elemN, int _dimN ) : MultiDimensionalData(_elemN,_dimN){
+DenseMultiDimensionalData::DenseMultiDimensionalData( int _elemN, int _dimN ) : MultiDimensionalData(_elemN,_dimN), external(0) {
     data.resize( elemN * dimN, FLT_MAX );
 }
 
 void DenseMultiDimensionalData::Resize( int _elemN, int _dimN ){
+    external = 0;
     MultiDimensionalData::Resize(_elemN,_dimN);
     data.resize( elemN * dimN, FLT_MAX );
 }
@@ -39,7 +40,7 @@ int DenseMultiDimensionalData::GetDataSize() const {
 
 // Various functions for setting values
 void DenseMultiDimensionalData::SetElement( int elem_id, const std::vector<float> & val ){
-    if( elem_id < 0 || elem_id >= GetElementCount() ) return;
+    if( external || elem_id < 0 || elem_id >= GetElementCount() ) return;
     for(int cur_dim = 0; cur_dim < GetDimension() && cur_dim < (int)val.size(); cur_dim++){
         data[ cur_dim * GetElementCount() + elem_id] = val[cur_dim];
     }
@@ -47,13 +48,13 @@ void DenseMultiDimensionalData::SetElement( int elem_id, const std::vector<float
 }
 
 void DenseMultiDimensionalData::SetElement( int elem_id, int dim, float val ){
-    if( elem_id < 0 || elem_id >= GetElementCount() ) return;
+    if( external || elem_id < 0 || elem_id >= GetElementCount() ) return;
     data[ dim * GetElementCount() + elem_id ] = val;
     min_val = max_val = FLT_MAX;
 }
 
 void DenseMultiDimensionalData::SetElement( int elem_id, const float  * val ){
-    if( elem_id < 0 || elem_id >= GetElementCount() ) return;
+    if( external || elem_id < 0 || elem_id >= GetElementCount() ) return;
     for(int cur_dim = 0; cur_dim < GetDimension(); cur_dim++){
         data[ cur_dim * GetElementCount() + elem_id] = val[cur_dim];
     }
@@ -61,7 +62,7 @@ void DenseMultiDimensionalData::SetElement( int elem_id, const float  * val ){
 }
 
 void DenseMultiDimensionalData::SetElement( int elem_id, const double * val ){
-    if( elem_id < 0 || elem_id >= GetElementCount() ) return;
+    if( external || elem_id < 0 || elem_id >= GetElementCount() ) return;
     for(int cur_dim = 0; cur_dim < GetDimension(); cur_dim++){
         data[ cur_dim * GetElementCount() + elem_id] = (float)val[cur_dim];
     }
@@ -73,42 +74,46 @@ void DenseMultiDimensionalData::SetElement( int elem_id, const double * val ){
 SCI::VexN DenseMultiDimensionalData::GetElement( int elem_id ) const {
     SCI::VexN ret( GetDimension() );
     if( elem_id < 0 || elem_id >= GetElementCount() ) return ret;
+    const float * values = Values();
     for(int cur_dim = 0; cur_dim < GetDimension(); cur_dim++){
-        ret[cur_dim] = data[ cur_dim*GetElementCount() + elem_id ] ;
+        ret[cur_dim] = values[ cur_dim*GetElementCount() + elem_id ] ;
     }
     return ret;
 }
 
 float DenseMultiDimensionalData::GetElement( int elem_id, int dim ) const {
     if( elem_id < 0 || elem_id >= GetElementCount() ) return FLT_MAX;
-    return data[ dim*GetElementCount() + elem_id ];
+    return Values()[ dim*GetElementCount() + elem_id ];
 }
 
 void DenseMultiDimensionalData::GetElement( int elem_id, float  * space ) const {
     if( elem_id < 0 || elem_id >= GetElementCount() ) return;
+    const float * values = Values();
     for(int cur_dim = 0; cur_dim < GetDimension(); cur_dim++){
-        space[cur_dim] = data[ cur_dim*GetElementCount() + elem_id];
+        space[cur_dim] = values[ cur_dim*GetElementCount() + elem_id];
     }
 }
 
 void DenseMultiDimensionalData::GetElement( int elem_id, double * space ) const {
     if( elem_id < 0 || elem_id >= GetElementCount() ) return;
+    const float * values = Values();
     for(int cur_dim = 0; cur_dim < GetDimension(); cur_dim++){
-        space[cur_dim] = data[ cur_dim*GetElementCount() + elem_id];
+        space[cur_dim] = values[ cur_dim*GetElementCount() + elem_id];
     }
 }
 
 
 void DenseMultiDimensionalData::RecalculateMinumumAndMaximum(){
     if( fabsf(min_val) == FLT_MAX || fabsf(max_val) == FLT_MAX ){
+        const float * values = Values();
         min_val =  FLT_MAX;
         max_val = -FLT_MAX;
         for(int cur_dim = 0; cur_dim < GetDimension(); cur_dim++){
             min_dval[cur_dim] =  FLT_MAX;
             max_dval[cur_dim] = -FLT_MAX;
             for(int elem_id = 0; elem_id < GetElementCount(); elem_id++ ){
-                min_dval[cur_dim] = SCI::Min( min_dval[cur_dim], data[ cur_dim*GetElementCount() + elem_id ] );
-                max_dval[cur_dim] = SCI::Max( max_dval[cur_dim], data[ cur_dim*GetElementCount() + elem_id ] );
+                min_dval[cur_dim] = SCI::Min( min_dval[cur_dim], values[ cur_dim*GetElementCount() + elem_id ] );
+                max_dval[cur_dim] = SCI::Max( max_dval[cur_dim], values[ cur_dim*GetElementCount() + elem_id ] );
             }
             min_val = SCI::Min( min_val, min_dval[cur_dim] );
             max_val = SCI::Max( max_val, max_dval[cur_dim] );
@@ -0,0 +1,277 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/DensityRaster.h>
+
+#include <algorithm>
+#include <math.h>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+using namespace Data;
+
+// levels of the equalization histogram
+static const int equalizeBins = 1024;
+
+static int ThreadCount( ){
+    #ifdef _OPENMP
+        return omp_get_max_threads();
+    #else
+        return 1;
+    #endif
+}
+
+static int ThreadNumber( ){
+    #ifdef _OPENMP
+        return omp_get_thread_num();
+    #else
+        return 0;
+    #endif
+}
+
+// scale taking [lo,hi] to [0,1], a flat range goes to the middle
+static void Mapping( float lo, float hi, float & offset, float & scale ){
+    if( hi > lo ){
+        offset = lo;
+        scale  = 1.0f / ( hi - lo );
+    }
+    else{
+        offset = lo - 0.5f;
+        scale  = 1.0f;
+    }
+}
+
+static inline void Plot( float * buf, int w, int h, int x, int y, float c ){
+    if( x >= 0 && x < w && y >= 0 && y < h ) buf[y*w+x] += c;
+}
+
+// point at pixel coordinates x,y shared over the four nearest pixels
+static inline void Splat( float * buf, int w, int h, float x, float y, float c ){
+    if( !( x > -1.0f && x < (float)w && y > -1.0f && y < (float)h ) ) return;
+    int   xi = (int)floorf( x );
+    int   yi = (int)floorf( y );
+    float fx = x - (float)xi;
+    float fy = y - (float)yi;
+    Plot( buf, w, h, xi,   yi,   c*(1-fx)*(1-fy) );
+    Plot( buf, w, h, xi+1, yi,   c*fx*(1-fy) );
+    Plot( buf, w, h, xi,   yi+1, c*(1-fx)*fy );
+    Plot( buf, w, h, xi+1, yi+1, c*fx*fy );
+}
+
+// Wu's line between pixel coordinates, one step per pixel of the major
+// axis with the weight split between the two pixels across it
+static void WuLine( float * buf, int w, int h, float x0, float y0, float x1, float y1, float c ){
+    if( !( x0 == x0 && y0 == y0 && x1 == x1 && y1 == y1 ) ) return;
+
+    bool steep = fabsf( y1 - y0 ) > fabsf( x1 - x0 );
+    if( steep ){
+        std::swap( x0, y0 );
+        std::swap( x1, y1 );
+    }
+    if( x0 > x1 ){
+        std::swap( x0, x1 );
+        std::swap( y0, y1 );
+    }
+
+    int   major = steep ? h : w;
+    int   minor = steep ? w : h;
+    float grad  = ( x1 > x0 ) ? ( y1 - y0 ) / ( x1 - x0 ) : 0.0f;
+    int   xa    = std::max( (int)floorf( x0 + 0.5f ), 0 );
+    int   xb    = std::min( (int)floorf( x1 + 0.5f ), major-1 );
+
+    for(int x = xa; x <= xb; x++){
+        float y  = y0 + grad * ( (float)x - x0 );
+        if( !( y > -1.0f && y < (float)minor ) ) continue;
+        int   yi = (int)floorf( y );
+        float f  = y - (float)yi;
+        if( steep ){
+            Plot( buf, w, h, yi,   x, c*(1-f) );
+            Plot( buf, w, h, yi+1, x, c*f );
+        }
+        else{
+            Plot( buf, w, h, x, yi,   c*(1-f) );
+            Plot( buf, w, h, x, yi+1, c*f );
+        }
+    }
+}
+
+DensityRaster::DensityRaster( ) : width(0), height(0), pending(false) { }
+
+void DensityRaster::Resize( int _width, int _height ){
+    width  = std::max( _width, 0 );
+    height = std::max( _height, 0 );
+    Clear();
+}
+
+void DensityRaster::Clear( ){
+    density.assign( (size_t)width*height, 0.0f );
+    std::vector< std::vector<float> >().swap( parts );
+    pending = false;
+}
+
+int DensityRaster::GetWidth( ) const { return width; }
+
+int DensityRaster::GetHeight( ) const { return height; }
+
+float * DensityRaster::Part( int thread ){
+    std::vector<float> & part = parts[thread];
+    if( part.size() != density.size() ){
+        part.assign( density.size(), 0.0f );
+    }
+    return &part[0];
+}
+
+void DensityRaster::Merge( ){
+    if( !pending ) return;
+    pending = false;
+
+    int N       = (int)density.size();
+    int threads = (int)parts.size();
+
+    #pragma omp parallel for schedule(static)
+    for(int p = 0; p < N; p++){
+        float sum = 0;
+        for(int t = 0; t < threads; t++){
+            if( parts[t].empty() ) continue;
+            sum += parts[t][p];
+        }
+        density[p] += sum;
+    }
+
+    // a full image per thread is not kept once it is summed
+    std::vector< std::vector<float> >().swap( parts );
+}
+
+void DensityRaster::AddPoints( const float * x, float x_min, float x_max, const float * y, float y_min, float y_max, int n, float weight ){
+    if( density.empty() || n <= 0 ) return;
+
+    float ox, sx, oy, sy;
+    Mapping( x_min, x_max, ox, sx );
+    Mapping( y_min, y_max, oy, sy );
+    sx *= (float)( width-1 );
+    sy *= (float)( height-1 );
+
+    int threads = ThreadCount();
+    parts.resize( std::max( (int)parts.size(), threads ) );
+
+    #pragma omp parallel num_threads(threads)
+    {
+        float * buf = Part( ThreadNumber() );
+
+        #pragma omp for schedule(static)
+        for(int i = 0; i < n; i++){
+            Splat( buf, width, height, ( x[i] - ox ) * sx, ( y[i] - oy ) * sy, weight );
+        }
+    }
+    pending = true;
+}
+
+void DensityRaster::AddSegments( const float * segments, int n, float weight ){
+    if( density.empty() || n <= 0 ) return;
+
+    float sx = (float)( width-1 );
+    float sy = (float)( height-1 );
+
+    int threads = ThreadCount();
+    parts.resize( std::max( (int)parts.size(), threads ) );
+
+    #pragma omp parallel num_threads(threads)
+    {
+        float * buf = Part( ThreadNumber() );
+
+        #pragma omp for schedule(static)
+        for(int i = 0; i < n; i++){
+            const float * s = segments + (size_t)i*4;
+            WuLine( buf, width, height, s[0]*sx, s[1]*sy, s[2]*sx, s[3]*sy, weight );
+        }
+    }
+    pending = true;
+}
+
+const std::vector<float> & DensityRaster::GetDensity( ){
+    Merge();
+    return density;
+}
+
+float DensityRaster::GetMaximum( ){
+    Merge();
+    float m = 0;
+    for(int p = 0; p < (int)density.size(); p++){
+        m = std::max( m, density[p] );
+    }
+    return m;
+}
+
+void DensityRaster::ToneMap( ToneMapping mapping, std::vector<float> & intensity ){
+    float maxd = GetMaximum();
+    int   N    = (int)density.size();
+    intensity.assign( N, 0.0f );
+    if( maxd <= 0 ) return;
+
+    if( mapping == LINEAR ){
+        for(int p = 0; p < N; p++){
+            intensity[p] = density[p] / maxd;
+        }
+        return;
+    }
+
+    float logMax = logf( 1.0f + maxd );
+    if( mapping == LOG ){
+        for(int p = 0; p < N; p++){
+            intensity[p] = logf( 1.0f + density[p] ) / logMax;
+        }
+        return;
+    }
+
+    // equalize on a log scale histogram, so sorting is never needed
+    std::vector<int> level( N, -1 );
+    std::vector<double> cdf( equalizeBins+1, 0.0 );
+    for(int p = 0; p < N; p++){
+        if( density[p] <= 0 ) continue;
+        int l = (int)( logf( 1.0f + density[p] ) / logMax * ( equalizeBins-1 ) );
+        level[p] = std::min( std::max( l, 0 ), equalizeBins-1 );
+        cdf[ level[p]+1 ] += 1;
+    }
+    for(int l = 0; l < equalizeBins; l++){
+        cdf[l+1] += cdf[l];
+    }
+    double covered = cdf[equalizeBins];
+    for(int p = 0; p < N; p++){
+        if( level[p] < 0 ) continue;
+        intensity[p] = (float)( cdf[ level[p]+1 ] / covered );
+    }
+}
+
+void DensityRaster::Colorize( const std::vector<float> & intensity, const float * transfer, int entries, std::vector<SCI::UINT8> & rgba ){
+    int N = (int)intensity.size();
+    rgba.assign( (size_t)N*4, 0 );
+    if( entries <= 0 ) return;
+
+    for(int p = 0; p < N; p++){
+        float t  = std::min( std::max( intensity[p], 0.0f ), 1.0f ) * (float)( entries-1 );
+        int   e  = std::min( (int)t, entries-1 );
+        int   e1 = std::min( e+1, entries-1 );
+        float f  = t - (float)e;
+        for(int c = 0; c < 4; c++){
+            float v = transfer[e*4+c] * (1-f) + transfer[e1*4+c] * f;
+            rgba[p*4+c] = (SCI::UINT8)( std::min( std::max( v, 0.0f ), 1.0f ) * 255.0f + 0.5f );
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/DependencyMatrix.h>
+#include <Data/BinnedColumns.h>
+#include <Data/PhysicsData.h>
+
+#include <math.h>
+
+using namespace Data;
+
+// Mutual information in bits of an nx by ny table of counts
+static double MutualInformation( const std::vector<double> & joint, int nx, int ny, double total ){
+    if( total <= 0 ) return 0;
+
+    std::vector<double> px( nx, 0.0 );
+    std::vector<double> py( ny, 0.0 );
+    for(int x = 0; x < nx; x++){
+        for(int y = 0; y < ny; y++){
+            px[x] += joint[x*ny+y];
+            py[y] += joint[x*ny+y];
+        }
+    }
+
+    double info = 0;
+    for(int x = 0; x < nx; x++){
+        for(int y = 0; y < ny; y++){
+            double c = joint[x*ny+y];
+            if( c <= 0 ) continue;
+            info += c * log( c * total / ( px[x] * py[y] ) );
+        }
+    }
+    return info / total / log(2.0);
+}
+
+// Merge a bins x bins table down to nx by ny cells
+static void MergeJoint( const std::vector<SCI::UINT32> & joint, int bins, int nx, int ny, std::vector<double> & out ){
+    out.assign( nx*ny, 0.0 );
+    int fx = bins / nx;
+    int fy = bins / ny;
+    for(int x = 0; x < bins; x++){
+        for(int y = 0; y < bins; y++){
+            out[ (x/fx)*ny + (y/fy) ] += joint[x*bins+y];
+        }
+    }
+}
+
+DependencyMatrix::DependencyMatrix( ) : dimN(0) { }
+
+void DependencyMatrix::Clear( ){
+    dimN = 0;
+    mi.clear();
+    mic.clear();
+}
+
+void DependencyMatrix::Build( PhysicsData & data, int _bins ){
+    Clear();
+
+    int bins = 2;
+    while( bins < _bins && bins < 128 ){ bins <<= 1; }
+
+    BinnedColumns binned;
+    binned.Build( data, bins, BinnedColumns::QUANTILE );
+
+    dimN = binned.GetDimension();
+    mi.assign( dimN*dimN, 0.0f );
+    mic.assign( dimN*dimN, 0.0f );
+
+    std::vector< std::pair<int,int> > pairs;
+    for(int i = 0; i < dimN; i++){
+        for(int j = i; j < dimN; j++){
+            pairs.push_back( std::make_pair(i,j) );
+        }
+    }
+
+    // Grids up to n^0.6 cells, as for the maximal information coefficient
+    double total    = (double)binned.GetElementCount();
+    double maxcells = SCI::Max( 4.0f, (float)pow( total, 0.6 ) );
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int p = 0; p < (int)pairs.size(); p++){
+        int i = pairs[p].first;
+        int j = pairs[p].second;
+
+        std::vector<SCI::UINT32> joint;
+        std::vector<double>      merged;
+        binned.GetJoint( i, j, joint );
+
+        MergeJoint( joint, bins, bins, bins, merged );
+        float info = (float)MutualInformation( merged, bins, bins, total );
+
+        float best = 0;
+        for(int nx = 2; nx <= bins; nx <<= 1){
+            for(int ny = 2; ny <= bins; ny <<= 1){
+                if( nx*ny > maxcells ) continue;
+                MergeJoint( joint, bins, nx, ny, merged );
+                double norm = log( (double)SCI::Min(nx,ny) ) / log(2.0);
+                best = SCI::Max( best, (float)( MutualInformation( merged, nx, ny, total ) / norm ) );
+            }
+        }
+        if( i == j ) best = 1.0f;
+
+        mi[i*dimN+j]  = mi[j*dimN+i]  = info;
+        mic[i*dimN+j] = mic[j*dimN+i] = SCI::Min( best, 1.0f );
+    }
+}
+
+int DependencyMatrix::GetDimension( ) const { return dimN; }
+
+float DependencyMatrix::GetMutualInformation( int dim_x, int dim_y ) const {
+    if( dim_x < 0 || dim_x >= dimN || dim_y < 0 || dim_y >= dimN ) return 0;
+    return mi[dim_x*dimN+dim_y];
+}
+
+float DependencyMatrix::GetInformationCoefficient( int dim_x, int dim_y ) const {
+    if( dim_x < 0 || dim_x >= dimN || dim_y < 0 || dim_y >= dimN ) return 0;
+    return mic[dim_x*dimN+dim_y];
+}
@@ -0,0 +1,191 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/EdgeBundling.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace Data;
+
+// the kernel shrinks by this much after every pass
+static const float kernelDecay = 0.7f;
+
+// Gaussian of deviation sigma, truncated at 3 sigma, summing to 1
+static void Kernel( float sigma, std::vector<float> & kernel ){
+    int radius = std::max( 1, (int)ceilf( 3.0f * sigma ) );
+    kernel.resize( 2*radius+1 );
+    float sum = 0;
+    for(int i = -radius; i <= radius; i++){
+        kernel[i+radius] = expf( -0.5f * (float)(i*i) / ( sigma*sigma ) );
+        sum += kernel[i+radius];
+    }
+    for(int i = 0; i < (int)kernel.size(); i++) kernel[i] /= sum;
+}
+
+// n values at stride apart convolved with kernel, zero beyond the ends
+static void Convolve( const float * in, float * out, int n, int stride, const std::vector<float> & kernel ){
+    int radius = (int)kernel.size() / 2;
+    for(int i = 0; i < n; i++){
+        float sum = 0;
+        int lo = std::max( 0, i-radius );
+        int hi = std::min( n-1, i+radius );
+        for(int j = lo; j <= hi; j++) sum += kernel[j-i+radius] * in[j*stride];
+        out[i*stride] = sum;
+    }
+}
+
+// density of column at height y in grid cells, linearly interpolated
+static inline float Sample( const float * column, int height, float y ){
+    if( y <= 0 ) return column[0];
+    if( y >= (float)(height-1) ) return column[height-1];
+    int   yi = (int)y;
+    float f  = y - (float)yi;
+    return column[yi] * (1-f) + column[yi+1] * f;
+}
+
+EdgeBundling::EdgeBundling( ) : samples(0) { }
+
+void EdgeBundling::SetLines( const float * a, const float * b, const float * w, int n ){
+    ends.resize( (size_t)std::max( n, 0 ) * 2 );
+    weight.resize( std::max( n, 0 ) );
+    for(int i = 0; i < n; i++){
+        ends[i*2+0] = a[i];
+        ends[i*2+1] = b[i];
+        weight[i]   = w ? w[i] : 1.0f;
+    }
+    Straighten( 2 );
+}
+
+void EdgeBundling::SetJoint( const std::vector<SCI::UINT32> & joint, int bins ){
+    ends.clear();
+    weight.clear();
+    for(int i = 0; i < bins; i++){
+        for(int j = 0; j < bins; j++){
+            SCI::UINT32 c = joint[i*bins+j];
+            if( c == 0 ) continue;
+            ends.push_back( ( (float)i + 0.5f ) / (float)bins );
+            ends.push_back( ( (float)j + 0.5f ) / (float)bins );
+            weight.push_back( (float)c );
+        }
+    }
+    Straighten( 2 );
+}
+
+void EdgeBundling::Straighten( int _samples ){
+    samples = std::max( _samples, 2 );
+    int n = (int)weight.size();
+    points.resize( (size_t)n*samples );
+    for(int i = 0; i < n; i++){
+        for(int s = 0; s < samples; s++){
+            float t = (float)s / (float)(samples-1);
+            points[(size_t)i*samples+s] = ends[i*2+0] * (1-t) + ends[i*2+1] * t;
+        }
+    }
+}
+
+void EdgeBundling::Bundle( int iterations, float bandwidth, int _samples, int height ){
+    Straighten( _samples );
+    int n = (int)weight.size();
+    int S = samples;
+    int H = std::max( height, 8 );
+    if( n < 2 ) return;
+
+    // one column of H cells per station
+    std::vector<float> density( (size_t)S*H );
+    std::vector<float> blurred( (size_t)S*H );
+    std::vector<float> moved( points.size() );
+    std::vector<float> kernelY, kernelX;
+
+    float h = bandwidth;
+    for(int it = 0; it < iterations; it++, h *= kernelDecay){
+
+        // splat, a station per thread
+        #pragma omp parallel for schedule(static)
+        for(int s = 0; s < S; s++){
+            float * column = &density[(size_t)s*H];
+            std::fill( column, column+H, 0.0f );
+            for(int i = 0; i < n; i++){
+                float y  = std::min( std::max( points[(size_t)i*S+s], 0.0f ), 1.0f ) * (float)(H-1);
+                int   yi = std::min( (int)y, H-2 );
+                float f  = y - (float)yi;
+                column[yi]   += weight[i] * (1-f);
+                column[yi+1] += weight[i] * f;
+            }
+        }
+
+        // separable Gaussian, first along each column, then across them
+        Kernel( std::max( h * (float)(H-1), 0.5f ), kernelY );
+        #pragma omp parallel for schedule(static)
+        for(int s = 0; s < S; s++){
+            Convolve( &density[(size_t)s*H], &blurred[(size_t)s*H], H, 1, kernelY );
+        }
+        float sigmaX = h * (float)(S-1);
+        if( sigmaX >= 0.5f ){
+            Kernel( sigmaX, kernelX );
+            #pragma omp parallel for schedule(static)
+            for(int y = 0; y < H; y++){
+                Convolve( &blurred[y], &density[y], S, H, kernelX );
+            }
+        }
+        else{
+            density.swap( blurred );
+        }
+
+        // every inner sample up the gradient, by at most half the kernel
+        float step = 0.5f * h;
+        #pragma omp parallel for schedule(static)
+        for(int i = 0; i < n; i++){
+            const float * p = &points[(size_t)i*S];
+            float       * q = &moved[(size_t)i*S];
+            q[0]   = p[0];
+            q[S-1] = p[S-1];
+            for(int s = 1; s < S-1; s++){
+                const float * column = &density[(size_t)s*H];
+                float y    = p[s] * (float)(H-1);
+                float grad = Sample( column, H, y+1.0f ) - Sample( column, H, y-1.0f );
+                float mag  = fabsf( grad ) + 1e-6f * ( Sample( column, H, y ) + 1e-6f );
+                q[s] = std::min( std::max( p[s] + step * grad / mag, 0.0f ), 1.0f );
+            }
+        }
+
+        // smooth each line, the ends stay put
+        #pragma omp parallel for schedule(static)
+        for(int i = 0; i < n; i++){
+            const float * q = &moved[(size_t)i*S];
+            float       * p = &points[(size_t)i*S];
+            for(int s = 1; s < S-1; s++){
+                p[s] = 0.25f * q[s-1] + 0.5f * q[s] + 0.25f * q[s+1];
+            }
+        }
+    }
+}
+
+int EdgeBundling::GetLineCount( ) const { return (int)weight.size(); }
+
+int EdgeBundling::GetSamples( ) const { return samples; }
+
+float EdgeBundling::GetWeight( int line ) const { return weight[line]; }
+
+float EdgeBundling::GetMaximumWeight( ) const {
+    float m = 0;
+    for(int i = 0; i < (int)weight.size(); i++) m = std::max( m, weight[i] );
+    return m;
+}
+
+const float * EdgeBundling::GetLine( int line ) const { return &points[(size_t)line*samples]; }
@@ -0,0 +1,566 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/FederatedData.h>
+
+#include <iostream>
+#include <algorithm>
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+    #include <io.h>
+#else
+    #include <dirent.h>
+    #include <glob.h>
+#endif
+
+using namespace Data;
+
+static const char STATS_MAGIC[8] = { 'D','V','S','T','A','T','S','1' };
+
+static bool HasSuffix( const std::string & str, const char * suffix ){
+    size_t len = strlen( suffix );
+    return str.size() >= len && str.compare( str.size()-len, len, suffix ) == 0;
+}
+
+static bool isDirectory( const char * name ){
+    struct stat st;
+    if( stat( name, &st ) != 0 ) return false;
+    return ( st.st_mode & S_IFMT ) == S_IFDIR;
+}
+
+// Sidecar files written next to the shards are never shards themselves
+static bool isDataFile( const std::string & name ){
+    return !HasSuffix( name, ".meta" ) && !HasSuffix( name, ".stats" );
+}
+
+FederatedData::FederatedData( ) : PhysicsData( ) { }
+
+FederatedData::~FederatedData( ){ }
+
+bool FederatedData::isPattern( const char * name ){
+    if( name == 0 ) return false;
+    if( strpbrk( name, "*?[" ) != 0 ) return true;
+    return isDirectory( name );
+}
+
+std::string FederatedData::MetaFilename( ) const {
+    if( !shards.empty() && strpbrk( filename.c_str(), "*?[" ) != 0 ){
+        return shards[0].filename + std::string(".meta");
+    }
+    return PhysicsData::MetaFilename();
+}
+
+bool FederatedData::isFederated( ) const {
+    return !shards.empty();
+}
+
+bool FederatedData::ListFiles( const char * pattern, std::vector<std::string> & files ){
+    std::string base( pattern );
+    while( base.size() > 1 && ( base[base.size()-1] == '/' || base[base.size()-1] == '\\' ) ){
+        base.erase( base.size()-1 );
+    }
+
+#ifndef WIN32
+    if( isDirectory( base.c_str() ) ){
+        DIR * dir = opendir( base.c_str() );
+        if( dir == 0 ) return false;
+        struct dirent * ent;
+        while( ( ent = readdir( dir ) ) != 0 ){
+            std::string name( ent->d_name );
+            if( name[0] == '.' ) continue;
+            if( !HasSuffix( name, ".dat" ) && !HasSuffix( name, ".txt" ) ) continue;
+            std::string path = base + "/" + name;
+            if( !isDirectory( path.c_str() ) ) files.push_back( path );
+        }
+        closedir( dir );
+    }
+    else{
+        glob_t g;
+        if( glob( base.c_str(), 0, 0, &g ) == 0 ){
+            for(size_t i = 0; i < g.gl_pathc; i++){
+                std::string path( g.gl_pathv[i] );
+                if( isDataFile( path ) && !isDirectory( path.c_str() ) ) files.push_back( path );
+            }
+        }
+        globfree( &g );
+    }
+#else
+    std::vector<std::string> specs;
+    std::string              dir;
+    if( isDirectory( base.c_str() ) ){
+        dir = base;
+        specs.push_back( base + "/*.dat" );
+        specs.push_back( base + "/*.txt" );
+    }
+    else{
+        size_t slash = base.find_last_of( "/\\" );
+        dir = ( slash == std::string::npos ) ? std::string(".") : base.substr( 0, slash );
+        specs.push_back( base );
+    }
+    for(int i = 0; i < (int)specs.size(); i++){
+        struct _finddata_t fd;
+        intptr_t h = _findfirst( specs[i].c_str(), &fd );
+        if( h == -1 ) continue;
+        do {
+            std::string name( fd.name );
+            if( ( fd.attrib & _A_SUBDIR ) == 0 && isDataFile( name ) ) files.push_back( dir + "/" + name );
+        } while( _findnext( h, &fd ) == 0 );
+        _findclose( h );
+    }
+#endif
+
+    // Global row ids follow file name order
+    std::sort( files.begin(), files.end() );
+    files.erase( std::unique( files.begin(), files.end() ), files.end() );
+    return true;
+}
+
+bool FederatedData::Open( const char * pattern ){
+    Close();
+    external = 0;
+    shared.Release();
+    data.clear();
+    labels.clear();
+    labels_parsed.clear();
+    dim_enabled.clear();
+    ClearDerived();
+
+    std::vector<std::string> files;
+    if( !ListFiles( pattern, files ) || files.empty() ){
+        std::cout << "No data files found: " << pattern << std::endl << std::flush;
+        return false;
+    }
+
+    std::cout << "Opening " << files.size() << " shards: " << pattern << std::endl << std::flush;
+
+    shards.resize( files.size() );
+    for(int s = 0; s < (int)shards.size(); s++){
+        shards[s].filename  = files[s];
+        shards[s].first_row = 0;
+        shards[s].rowN      = 0;
+        shards[s].valid     = false;
+    }
+
+    // Shards with cached statistics outside the filter are never read
+    int shardN = (int)shards.size();
+    #pragma omp parallel for schedule(dynamic)
+    for(int s = 0; s < shardN; s++){
+        DataShard & shard = shards[s];
+        shard.valid = ReadStatistics( shard );
+        if( !shard.valid || Passes( shard ) ){
+            shard.valid = LoadShard( shard );
+        }
+    }
+
+    // All shards must agree with the first one on the number of columns
+    int dim = 0;
+    SCI::INT64 rows = 0;
+    for(int s = 0; s < (int)shards.size(); s++){
+        DataShard & shard = shards[s];
+        if( !shard.valid ) continue;
+        if( dim == 0 ){ dim = shard.stats.GetDimension(); }
+        if( shard.stats.GetDimension() != dim ){
+            std::cout << "Skipping shard with " << shard.stats.GetDimension() << " columns: " << shard.filename.c_str() << std::endl << std::flush;
+            shard.valid = false;
+            std::vector<float>().swap( shard.values );
+            continue;
+        }
+        shard.first_row = rows;
+        rows += shard.rowN;
+    }
+
+    if( dim == 0 ){
+        shards.clear();
+        return false;
+    }
+
+    filename = std::string( pattern );
+    while( filename.size() > 1 && ( filename[filename.size()-1] == '/' || filename[filename.size()-1] == '\\' ) ){
+        filename.erase( filename.size()-1 );
+    }
+
+    MultiDimensionalData::Resize( 0, dim );
+    Refresh();
+
+    dim_enabled.resize(dimN,true);
+    LoadMeta();
+
+    return true;
+}
+
+void FederatedData::Close( ){
+    if( !isFederated() ) return;
+
+    shards.clear();
+    active.clear();
+    active_first.clear();
+    stats.Reset( 0 );
+    Resize( 0, 0 );
+}
+
+bool FederatedData::LoadShard( DataShard & shard ){
+    std::vector<float> rowmajor;
+    int dim = 0;
+
+    #pragma omp critical (federated_log)
+    std::cout << "Loading shard: " << shard.filename.c_str() << std::endl << std::flush;
+
+    if( !ReadValues( shard.filename.c_str(), rowmajor, dim ) ) return false;
+
+    SCI::INT64 rowN = (SCI::INT64)rowmajor.size() / dim;
+    shard.values.resize( (size_t)rowN * dim );
+    for(SCI::INT64 i = 0; i < rowN; i++){
+        for(int d = 0; d < dim; d++){
+            shard.values[ d*rowN + i ] = rowmajor[ i*dim + d ];
+        }
+    }
+
+    shard.rowN = rowN;
+    shard.stats.Reset( dim );
+    shard.stats.AddColumns( shard.values.empty() ? 0 : &shard.values[0], rowN );
+
+    WriteStatistics( shard );
+
+    return rowN > 0;
+}
+
+bool FederatedData::ReadStatistics( DataShard & shard ){
+    std::string sname = shard.filename + ".stats";
+    FILE * infile = fopen( sname.c_str(), "rb" );
+    if( !infile ) return false;
+
+    char        magic[8];
+    SCI::UINT64 stamp = 0;
+    bool ok = fread( magic, 1, 8, infile ) == 8
+              && memcmp( magic, STATS_MAGIC, 8 ) == 0
+              && fread( &stamp, sizeof(stamp), 1, infile ) == 1
+              && stamp == FileStamp( shard.filename.c_str() )
+              && shard.stats.Read( infile );
+    fclose( infile );
+
+    if( !ok || shard.stats.GetCount() == 0 ) return false;
+
+    shard.rowN = shard.stats.GetCount();
+    return true;
+}
+
+void FederatedData::WriteStatistics( const DataShard & shard ){
+    std::string sname = shard.filename + ".stats";
+    FILE * outfile = fopen( sname.c_str(), "wb" );
+    if( !outfile ) return;
+
+    SCI::UINT64 stamp = FileStamp( shard.filename.c_str() );
+    fwrite( STATS_MAGIC, 1, 8, outfile );
+    fwrite( &stamp, sizeof(stamp), 1, outfile );
+    shard.stats.Write( outfile );
+    fclose( outfile );
+}
+
+bool FederatedData::Passes( const DataShard & shard ) const {
+    std::map< int, std::pair<float,float> >::const_iterator it;
+    for( it = filter.begin(); it != filter.end(); it++ ){
+        if( !shard.stats.Overlaps( it->first, it->second.first, it->second.second ) ) return false;
+    }
+    return true;
+}
+
+void FederatedData::SetFilter( int dim, float lo, float hi ){
+    filter[dim] = std::make_pair( SCI::Min(lo,hi), SCI::Max(lo,hi) );
+}
+
+void FederatedData::ClearFilter( int dim ){
+    if( dim < 0 )
+        filter.clear();
+    else
+        filter.erase( dim );
+}
+
+bool FederatedData::Refresh( ){
+    if( !isFederated() ) return false;
+
+    // Rows of shards filtered out leave the histograms before their values go
+    bool incremental = histogram.GetDimension() == dimN && histogram.GetCount() == elemN;
+    std::vector<int> before = active;
+    if( incremental ){
+        for(int a = 0; a < (int)before.size(); a++){
+            DataShard & shard = shards[ before[a] ];
+            if( !Passes( shard ) && !shard.values.empty() ){
+                histogram.RemoveColumns( &shard.values[0], shard.rowN );
+            }
+        }
+    }
+
+    int shardN = (int)shards.size();
+    #pragma omp parallel for schedule(dynamic)
+    for(int s = 0; s < shardN; s++){
+        DataShard & shard = shards[s];
+        if( !shard.valid ) continue;
+        if( Passes( shard ) ){
+            if( shard.values.empty() ){
+                shard.valid = LoadShard( shard ) && shard.stats.GetDimension() == dimN;
+            }
+        }
+        else{
+            std::vector<float>().swap( shard.values );
+        }
+    }
+
+    Rebuild();
+
+    // Rows of shards joining are added, unless they widen a column past
+    // the range the histograms were built for
+    for(int d = 0; incremental && d < dimN; d++){
+        incremental = min_dval[d] >= histogram.GetMinimumValue( d ) && max_dval[d] <= histogram.GetMaximumValue( d );
+    }
+    if( incremental ){
+        for(int a = 0; a < (int)active.size(); a++){
+            const DataShard & shard = shards[ active[a] ];
+            if( std::find( before.begin(), before.end(), active[a] ) == before.end() && !shard.values.empty() ){
+                histogram.AddColumns( &shard.values[0], shard.rowN );
+            }
+        }
+    }
+    if( !incremental || histogram.GetCount() != elemN ){
+        histogram.Clear();
+    }
+    return true;
+}
+
+int FederatedData::Rescan( ){
+    if( !isFederated() ) return 0;
+
+    std::vector<std::string> files;
+    if( !ListFiles( filename.c_str(), files ) ) return 0;
+
+    // New shards take the global row ids after the last known one, so the
+    // ids of open rows stay as they are and keep increasing with the shard
+    SCI::INT64 rows = 0;
+    for(int s = 0; s < (int)shards.size(); s++){
+        if( shards[s].valid ) rows = std::max( rows, shards[s].first_row + shards[s].rowN );
+    }
+
+    int first = (int)shards.size();
+    for(int f = 0; f < (int)files.size(); f++){
+        bool known = false;
+        for(int s = 0; s < first && !known; s++){
+            known = shards[s].filename == files[f];
+        }
+        if( known ) continue;
+
+        DataShard shard;
+        shard.filename  = files[f];
+        shard.first_row = rows;
+        shard.rowN      = 0;
+        shard.valid     = ReadStatistics( shard ) && shard.stats.GetDimension() == dimN;
+        if( !shard.valid ){
+            shard.valid = LoadShard( shard ) && shard.stats.GetDimension() == dimN;
+        }
+        if( shard.valid ) rows += shard.rowN;
+        shards.push_back( shard );
+    }
+    return (int)shards.size() - first;
+}
+
+void FederatedData::Rebuild( ){
+    active.clear();
+    active_first.assign( 1, 0 );
+    stats.Reset( dimN );
+    ClearDerived( true );
+
+    SCI::INT64 total = 0;
+    for(int s = 0; s < (int)shards.size(); s++){
+        const DataShard & shard = shards[s];
+        if( !shard.valid || shard.values.empty() ) continue;
+
+        // Element ids are int, global row ids are not limited
+        if( total + shard.rowN > INT_MAX ){
+            std::cout << "Federated dataset exceeds " << INT_MAX << " rows, remaining shards are inactive" << std::endl << std::flush;
+            break;
+        }
+
+        total += shard.rowN;
+        active.push_back( s );
+        active_first.push_back( (int)total );
+        stats.Merge( shard.stats );
+    }
+
+    MultiDimensionalData::Resize( (int)total, dimN );
+
+    min_val =  FLT_MAX;
+    max_val = -FLT_MAX;
+    for(int d = 0; d < dimN; d++){
+        min_dval[d] = stats.GetMinimumValue( d );
+        max_dval[d] = stats.GetMaximumValue( d );
+        min_val = SCI::Min( min_val, min_dval[d] );
+        max_val = SCI::Max( max_val, max_dval[d] );
+    }
+
+    SetCorrelation( stats );
+
+    std::cout << "Federated dataset: " << active.size() << " of " << shards.size() << " shards active, " << total << " rows" << std::endl << std::flush;
+}
+
+int FederatedData::GetShardCount( ) const {
+    return (int)shards.size();
+}
+
+const DataShard & FederatedData::GetShard( int shard ) const {
+    return shards[shard];
+}
+
+bool FederatedData::isShardActive( int shard ) const {
+    return std::binary_search( active.begin(), active.end(), shard );
+}
+
+SCI::INT64 FederatedData::GetRowCount( ) const {
+    SCI::INT64 rows = 0;
+    for(int s = 0; s < (int)shards.size(); s++){
+        if( shards[s].valid ) rows += shards[s].rowN;
+    }
+    return rows;
+}
+
+const ColumnStatistics & FederatedData::GetStatistics( ) const {
+    return stats;
+}
+
+const DataShard * FederatedData::Locate( int elem_id, SCI::INT64 & row ) const {
+    if( elem_id < 0 || elem_id >= elemN ) return 0;
+    int k = (int)( std::upper_bound( active_first.begin(), active_first.end(), elem_id ) - active_first.begin() ) - 1;
+    row = elem_id - active_first[k];
+    return &shards[ active[k] ];
+}
+
+DataShard * FederatedData::Locate( int elem_id, SCI::INT64 & row ){
+    return const_cast<DataShard*>( static_cast<const FederatedData*>(this)->Locate( elem_id, row ) );
+}
+
+// Get a rough estimate of the size of the data contained in the class
+int FederatedData::GetDataSize() const {
+    if( !isFederated() ) return PhysicsData::GetDataSize();
+    SCI::INT64 bytes = 0;
+    for(int s = 0; s < (int)shards.size(); s++){
+        bytes += (SCI::INT64)( shards[s].values.size() * sizeof(float) );
+    }
+    return ( bytes > INT_MAX ) ? INT_MAX : (int)bytes;
+}
+
+// Various functions for setting values
+void FederatedData::SetElement( int elem_id, const std::vector<float> & val ){
+    if( !isFederated() ){ PhysicsData::SetElement( elem_id, val ); return; }
+    SCI::INT64 row;
+    DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return;
+    for(int d = 0; d < dimN && d < (int)val.size(); d++){
+        shard->values[ d*shard->rowN + row ] = val[d];
+    }
+}
+
+void FederatedData::SetElement( int elem_id, int dim, float val ){
+    if( !isFederated() ){ PhysicsData::SetElement( elem_id, dim, val ); return; }
+    SCI::INT64 row;
+    DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return;
+    shard->values[ dim*shard->rowN + row ] = val;
+}
+
+void FederatedData::SetElement( int elem_id, const float  * val ){
+    if( !isFederated() ){ PhysicsData::SetElement( elem_id, val ); return; }
+    SCI::INT64 row;
+    DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return;
+    for(int d = 0; d < dimN; d++){
+        shard->values[ d*shard->rowN + row ] = val[d];
+    }
+}
+
+void FederatedData::SetElement( int elem_id, const double * val ){
+    if( !isFederated() ){ PhysicsData::SetElement( elem_id, val ); return; }
+    SCI::INT64 row;
+    DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return;
+    for(int d = 0; d < dimN; d++){
+        shard->values[ d*shard->rowN + row ] = (float)val[d];
+    }
+}
+
+// Various functions for getting values
+SCI::VexN FederatedData::GetElement( int elem_id ) const {
+    if( !isFederated() ) return PhysicsData::GetElement( elem_id );
+    SCI::VexN ret( dimN );
+    SCI::INT64 row;
+    const DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return ret;
+    for(int d = 0; d < dimN; d++){
+        ret[d] = shard->values[ d*shard->rowN + row ];
+    }
+    return ret;
+}
+
+float FederatedData::GetElement( int elem_id, int dim ) const {
+    if( !isFederated() ) return PhysicsData::GetElement( elem_id, dim );
+    SCI::INT64 row;
+    const DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return FLT_MAX;
+    return shard->values[ dim*shard->rowN + row ];
+}
+
+void FederatedData::GetElement( int elem_id, float  * space ) const {
+    if( !isFederated() ){ PhysicsData::GetElement( elem_id, space ); return; }
+    SCI::INT64 row;
+    const DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return;
+    for(int d = 0; d < dimN; d++){
+        space[d] = shard->values[ d*shard->rowN + row ];
+    }
+}
+
+void FederatedData::GetElement( int elem_id, double * space ) const {
+    if( !isFederated() ){ PhysicsData::GetElement( elem_id, space ); return; }
+    SCI::INT64 row;
+    const DataShard * shard = Locate( elem_id, row );
+    if( shard == 0 ) return;
+    for(int d = 0; d < dimN; d++){
+        space[d] = shard->values[ d*shard->rowN + row ];
+    }
+}
+
+float FederatedData::GetMaximumValue( int dim ) {
+    if( !isFederated() ) return PhysicsData::GetMaximumValue( dim );
+    return MultiDimensionalData::GetMaximumValue( dim );
+}
+
+float FederatedData::GetMinimumValue( int dim ) {
+    if( !isFederated() ) return PhysicsData::GetMinimumValue( dim );
+    return MultiDimensionalData::GetMinimumValue( dim );
+}
+
+std::vector<float> FederatedData::ExtractDimension( int dim ) const {
+    if( !isFederated() ) return PhysicsData::ExtractDimension( dim );
+    std::vector<float> ret;
+    ret.reserve( elemN );
+    for(int k = 0; k < (int)active.size(); k++){
+        const DataShard & shard = shards[ active[k] ];
+        const float * col = &shard.values[ dim*shard.rowN ];
+        ret.insert( ret.end(), col, col + shard.rowN );
+    }
+    return ret;
+}
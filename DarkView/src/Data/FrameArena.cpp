@@ -0,0 +1,125 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/FrameArena.h>
+
+#include <stdlib.h>
+#include <new>
+
+using namespace Data;
+
+namespace {
+    const size_t ARENA_ALIGN = 16;
+    const size_t ARENA_BLOCK = 64*1024;
+
+    // Arenas live as long as their thread's pool, they are not freed
+    FrameArena * local_arena = 0;
+    #pragma omp threadprivate(local_arena)
+}
+
+FrameArena::Scope::Scope( ) : arena( FrameArena::Local() ){
+    arena.Enter();
+    block = arena.cur;
+    top   = arena.top;
+}
+
+FrameArena::Scope::~Scope( ){
+    arena.Leave( block, top );
+}
+
+FrameArena & FrameArena::Local( ){
+    if( local_arena == 0 ){
+        local_arena = new FrameArena();
+    }
+    return *local_arena;
+}
+
+FrameArena::FrameArena( ){
+    cur   = 0;
+    top   = 0;
+    depth = 0;
+}
+
+FrameArena::~FrameArena( ){
+    for(int i = 0; i < (int)blocks.size(); i++){
+        free( blocks[i].mem );
+    }
+}
+
+void * FrameArena::Allocate( size_t n ){
+    n = ( n + ARENA_ALIGN - 1 ) & ~( ARENA_ALIGN - 1 );
+    if( n == 0 ) n = ARENA_ALIGN;
+
+    // the rest of the block, else the next one kept from an earlier
+    // frame, else a new one at least twice the size of the last
+    while( blocks.empty() || top + n > blocks[cur].size ){
+        if( !blocks.empty() && cur+1 < (int)blocks.size() ){
+            cur++;
+            top = 0;
+            continue;
+        }
+        size_t size = blocks.empty() ? ARENA_BLOCK : blocks.back().size * 2;
+        while( size < n ) size *= 2;
+
+        Block block;
+        block.mem  = (char*)malloc( size );
+        block.size = size;
+        if( block.mem == 0 ){
+            throw std::bad_alloc();
+        }
+        blocks.push_back( block );
+
+        cur = (int)blocks.size()-1;
+        top = 0;
+    }
+
+    void * ptr = blocks[cur].mem + top;
+    top += n;
+    return ptr;
+}
+
+void FrameArena::Enter( ){
+    depth++;
+}
+
+void FrameArena::Leave( int block, size_t _top ){
+    cur = block;
+    top = _top;
+    if( --depth > 0 ) return;
+
+    // the frame took more than one block, one of their total size serves
+    // the next frames by itself; without the memory for it the blocks
+    // are kept as they are
+    if( blocks.size() > 1 ){
+        size_t size = 0;
+        for(int i = 0; i < (int)blocks.size(); i++){
+            size += blocks[i].size;
+        }
+        char * mem  = (char*)malloc( size );
+        if( mem != 0 ){
+            for(int i = 0; i < (int)blocks.size(); i++){
+                free( blocks[i].mem );
+            }
+            blocks.resize( 1 );
+            blocks[0].mem  = mem;
+            blocks[0].size = size;
+        }
+    }
+    cur = 0;
+    top = 0;
+}
@@ -0,0 +1,159 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/KNearest2D.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace Data;
+
+// Ranges this small are scanned instead of split
+static const int leaf_size = 8;
+
+namespace {
+    struct AxisLess {
+        const float * key;
+        AxisLess( const float * _key ) : key(_key) { }
+        bool operator()( int a, int b ) const { return key[a] < key[b] || ( key[a] == key[b] && a < b ); }
+    };
+}
+
+KNearest2D::KNearest2D( ) { }
+
+void KNearest2D::Clear( ){
+    px.clear();
+    py.clear();
+    pid.clear();
+}
+
+int KNearest2D::GetCount( ) const { return (int)pid.size(); }
+
+void KNearest2D::Build( const std::vector<float> & x, const std::vector<float> & y ){
+    int n = (int)std::min( x.size(), y.size() );
+
+    // Sort indices first, then gather the coordinates in tree order
+    px = x;
+    py = y;
+    pid.resize( n );
+    for(int i = 0; i < n; i++){ pid[i] = i; }
+
+    BuildRange( 0, n, 0 );
+
+    for(int i = 0; i < n; i++){
+        px[i] = x[ pid[i] ];
+        py[i] = y[ pid[i] ];
+    }
+}
+
+void KNearest2D::BuildRange( int lo, int hi, int axis ){
+    if( hi - lo <= leaf_size ) return;
+
+    int mid = (lo+hi)/2;
+    std::nth_element( pid.begin()+lo, pid.begin()+mid, pid.begin()+hi, AxisLess( axis == 0 ? &px[0] : &py[0] ) );
+
+    BuildRange( lo,    mid, axis^1 );
+    BuildRange( mid+1, hi,  axis^1 );
+}
+
+void KNearest2D::Search( int lo, int hi, int axis, float qx, float qy, int k, float rd, float * off, std::vector<Candidate> & heap ) const {
+    if( hi - lo <= leaf_size ){
+        for(int i = lo; i < hi; i++){
+            Candidate c;
+            c.d2 = (px[i]-qx)*(px[i]-qx) + (py[i]-qy)*(py[i]-qy);
+            c.id = pid[i];
+            if( (int)heap.size() < k ){
+                heap.push_back( c );
+                std::push_heap( heap.begin(), heap.end() );
+            }
+            else if( c < heap.front() ){
+                std::pop_heap( heap.begin(), heap.end() );
+                heap.back() = c;
+                std::push_heap( heap.begin(), heap.end() );
+            }
+        }
+        return;
+    }
+
+    int   mid  = (lo+hi)/2;
+    float diff = ( axis == 0 ) ? qx - px[mid] : qy - py[mid];
+
+    // The splitting point itself
+    Search( mid, mid+1, axis, qx, qy, k, rd, off, heap );
+
+    // Nearer half first. rd is the squared distance from the query to the
+    // cell of the farther half, which is only searched if that can still
+    // hold a candidate.
+    int near_lo = ( diff < 0 ) ? lo  : mid+1;
+    int near_hi = ( diff < 0 ) ? mid : hi;
+    int far_lo  = ( diff < 0 ) ? mid+1 : lo;
+    int far_hi  = ( diff < 0 ) ? hi    : mid;
+
+    Search( near_lo, near_hi, axis^1, qx, qy, k, rd, off, heap );
+
+    float old = off[axis];
+    float frd = rd - old*old + diff*diff;
+    if( (int)heap.size() < k || frd <= heap.front().d2 ){
+        off[axis] = diff;
+        Search( far_lo, far_hi, axis^1, qx, qy, k, frd, off, heap );
+        off[axis] = old;
+    }
+}
+
+int KNearest2D::Query( float qx, float qy, int k, int * index, float * dist ) const {
+    std::vector<Candidate> heap;
+    return Query( qx, qy, k, index, dist, heap );
+}
+
+int KNearest2D::Query( float qx, float qy, int k, int * index, float * dist, std::vector<Candidate> & heap ) const {
+    k = std::min( k, GetCount() );
+    if( k <= 0 ) return 0;
+
+    float off[2] = { 0, 0 };
+    heap.clear();
+    Search( 0, GetCount(), 0, qx, qy, k, 0, off, heap );
+
+    std::sort_heap( heap.begin(), heap.end() );
+    for(int i = 0; i < (int)heap.size(); i++){
+        if( index ) index[i] = heap[i].id;
+        if( dist  ) dist[i]  = sqrtf( heap[i].d2 );
+    }
+    return (int)heap.size();
+}
+
+int KNearest2D::QueryAll( int k, std::vector<int> & index, std::vector<float> & dist ) const {
+    int n = GetCount();
+    k = std::min( k, n );
+    index.assign( (size_t)n*std::max(k,0), 0 );
+    dist.assign(  (size_t)n*std::max(k,0), 0.0f );
+    if( k <= 0 ) return 0;
+
+    #pragma omp parallel
+    {
+        std::vector<Candidate> heap;
+        heap.reserve( k );
+
+        #pragma omp for schedule(dynamic,256)
+        for(int t = 0; t < n; t++){
+            // Rows are stored by original index, so results do not depend on tree order
+            int i = pid[t];
+            Query( px[t], py[t], k, &index[(size_t)i*k], &dist[(size_t)i*k], heap );
+        }
+    }
+    return k;
+}
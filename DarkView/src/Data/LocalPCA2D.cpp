@@ -0,0 +1,199 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/LocalPCA2D.h>
+
+#include <math.h>
+#include <algorithm>
+
+using namespace Data;
+
+LocalPCA2D::LocalPCA2D( ) { }
+
+void LocalPCA2D::Clear( ){
+    meanX.clear();      meanY.clear();
+    majorX.clear();     majorY.clear();
+    minorX.clear();     minorY.clear();
+    majorValue.clear(); minorValue.clear();
+    originX.clear();    originY.clear();
+    prefixSizes.clear();
+    for(int m = 0; m < 5; m++){ prefix[m].clear(); }
+}
+
+int LocalPCA2D::GetGroupCount( ) const { return (int)meanX.size(); }
+
+void LocalPCA2D::Compute( const std::vector<float> & x, const std::vector<float> & y, const std::vector<int> & members, int groupSize ){
+    int groupN = (int)x.size();
+    if( groupSize < 0 || (size_t)groupN*groupSize > members.size() ) groupN = 0;
+
+    meanX.resize( groupN );     meanY.resize( groupN );
+    majorX.resize( groupN );    majorY.resize( groupN );
+    minorX.resize( groupN );    minorY.resize( groupN );
+    majorValue.resize( groupN );minorValue.resize( groupN );
+
+    // The covariance sums go to the eigenvalue arrays and the minor vector
+    // until Finish, so this pass only gathers.
+    std::vector<float> & sxx = majorValue;
+    std::vector<float> & syy = minorValue;
+    std::vector<float> & sxy = minorX;
+
+    // Moments of every group, taken about the group's own point
+    // so that float sums keep their precision
+    #pragma omp parallel for schedule(static)
+    for(int g = 0; g < groupN; g++){
+        float ox = x[g], oy = y[g];
+        float mx = 0, my = 0, xx = 0, yy = 0, xy = 0;
+        const int * row = groupSize > 0 ? &members[(size_t)g*groupSize] : 0;
+        for(int t = 0; t < groupSize; t++){
+            float dx = x[ row[t] ] - ox;
+            float dy = y[ row[t] ] - oy;
+            mx += dx;    my += dy;
+            xx += dx*dx; yy += dy*dy; xy += dx*dy;
+        }
+        meanX[g] = mx;
+        meanY[g] = my;
+        sxx[g] = xx;
+        syy[g] = yy;
+        sxy[g] = xy;
+    }
+
+    if( groupN > 0 ) Finish( &x[0], &y[0], groupSize );
+}
+
+// The sums of the group moments are in meanX, meanY, majorValue (xx),
+// minorValue (yy) and minorX (xy). Turns them into the results.
+void LocalPCA2D::Finish( const float * x, const float * y, int groupSize ){
+    int groupN = (int)meanX.size();
+    std::vector<float> & sxx = majorValue;
+    std::vector<float> & syy = minorValue;
+    std::vector<float> & sxy = minorX;
+
+    // Closed form eigen solution, branch free over plain arrays
+    float n   = (float)( groupSize + 1 );
+    float inv = 1.0f / n;
+    float den = ( groupSize > 0 ) ? 1.0f / (float)groupSize : 0.0f;
+
+    #pragma omp parallel for schedule(static)
+    for(int g = 0; g < groupN; g++){
+        float mx = meanX[g] * inv;
+        float my = meanY[g] * inv;
+        float a  = ( sxx[g] - n*mx*mx ) * den;
+        float c  = ( syy[g] - n*my*my ) * den;
+        float b  = ( sxy[g] - n*mx*my ) * den;
+
+        float half = 0.5f * ( a - c );
+        float disc = sqrtf( half*half + b*b );
+        float l1   = 0.5f * ( a + c ) + disc;
+        float l2   = 0.5f * ( a + c ) - disc;
+
+        // (l1-c, b) and (b, l1-a) both solve the major vector, the longer
+        // one is the better conditioned. A diagonal matrix picks its axis.
+        float u0 = l1 - c, u1 = b;
+        float v0 = b,      v1 = l1 - a;
+        float nu = u0*u0 + u1*u1;
+        float nv = v0*v0 + v1*v1;
+        float ex = ( nu >= nv ) ? u0 : v0;
+        float ey = ( nu >= nv ) ? u1 : v1;
+        float nn = ( nu >= nv ) ? nu : nv;
+        float rn = ( nn > 0 ) ? 1.0f / sqrtf( nn ) : 0.0f;
+        ex = ( nn > 0 ) ? ex * rn : 1.0f;
+        ey = ( nn > 0 ) ? ey * rn : 0.0f;
+
+        meanX[g]      = x[g] + mx;
+        meanY[g]      = y[g] + my;
+        majorX[g]     = ex;
+        majorY[g]     = ey;
+        minorX[g]     = -ey;
+        minorY[g]     = ex;
+        majorValue[g] = l1;
+        minorValue[g] = ( l2 > 0 ) ? l2 : 0.0f;
+    }
+}
+
+void LocalPCA2D::Accumulate( const std::vector<float> & x, const std::vector<float> & y, const std::vector<int> & members, int groupSize, const std::vector<int> & sizes ){
+    int groupN = (int)x.size();
+    if( groupSize < 0 || (size_t)groupN*groupSize > members.size() ) groupN = 0;
+
+    prefixSizes.clear();
+    for(int s = 0; s < (int)sizes.size(); s++){
+        if( sizes[s] > 0 && sizes[s] <= groupSize ) prefixSizes.push_back( sizes[s] );
+    }
+    std::sort( prefixSizes.begin(), prefixSizes.end() );
+    prefixSizes.erase( std::unique( prefixSizes.begin(), prefixSizes.end() ), prefixSizes.end() );
+
+    int sizeN = (int)prefixSizes.size();
+    int last  = ( sizeN > 0 ) ? prefixSizes.back() : 0;
+
+    originX.assign( x.begin(), x.begin()+groupN );
+    originY.assign( y.begin(), y.begin()+groupN );
+    for(int m = 0; m < 5; m++){ prefix[m].resize( (size_t)groupN*sizeN ); }
+
+    // Running moments along each neighbour row, about the group's own point,
+    // stored as the row passes each of the sizes
+    #pragma omp parallel for schedule(static)
+    for(int g = 0; g < groupN; g++){
+        float ox = x[g], oy = y[g];
+        float mx = 0, my = 0, xx = 0, yy = 0, xy = 0;
+        const int * row = groupSize > 0 ? &members[(size_t)g*groupSize] : 0;
+        int s = 0;
+        for(int t = 0; t < last; t++){
+            float dx = x[ row[t] ] - ox;
+            float dy = y[ row[t] ] - oy;
+            mx += dx;    my += dy;
+            xx += dx*dx; yy += dy*dy; xy += dx*dy;
+            if( prefixSizes[s] == t+1 ){
+                size_t at = (size_t)s*groupN + g;
+                prefix[0][at] = mx;
+                prefix[1][at] = my;
+                prefix[2][at] = xx;
+                prefix[3][at] = yy;
+                prefix[4][at] = xy;
+                s++;
+            }
+        }
+    }
+}
+
+int LocalPCA2D::GetMaxGroupSize( ) const { return prefixSizes.empty() ? 0 : prefixSizes.back(); }
+
+void LocalPCA2D::Solve( int groupSize ){
+    int groupN = (int)originX.size();
+
+    int s = -1;
+    for(int i = 0; i < (int)prefixSizes.size() && prefixSizes[i] <= groupSize; i++){ s = i; }
+    groupSize = ( s < 0 ) ? 0 : prefixSizes[s];
+
+    meanX.resize( groupN );     meanY.resize( groupN );
+    majorX.resize( groupN );    majorY.resize( groupN );
+    minorX.resize( groupN );    minorY.resize( groupN );
+    majorValue.resize( groupN );minorValue.resize( groupN );
+
+    // The moments of the first groupSize members are one lookup per group
+    #pragma omp parallel for schedule(static)
+    for(int g = 0; g < groupN; g++){
+        size_t at = (size_t)( s < 0 ? 0 : s )*groupN + g;
+        bool   any = groupSize > 0;
+        meanX[g]      = any ? prefix[0][at] : 0.0f;
+        meanY[g]      = any ? prefix[1][at] : 0.0f;
+        majorValue[g] = any ? prefix[2][at] : 0.0f;
+        minorValue[g] = any ? prefix[3][at] : 0.0f;
+        minorX[g]     = any ? prefix[4][at] : 0.0f;
+    }
+
+    if( groupN > 0 ) Finish( &originX[0], &originY[0], groupSize );
+}
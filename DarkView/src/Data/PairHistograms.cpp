@@ -0,0 +1,103 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/PairHistograms.h>
+#include <Data/PhysicsData.h>
+
+#include <set>
+
+using namespace Data;
+
+PairHistograms::PairHistograms( ) { }
+
+void PairHistograms::Clear( ){
+    columns.Clear();
+    source.clear();
+    joints.clear();
+}
+
+void PairHistograms::Update( PhysicsData & data, int bins ){
+    int n = data.GetElementCount();
+    bool same = ( source == data.GetFilename() && columns.GetBins() == bins &&
+                  columns.GetDimension() == data.GetDim() && columns.GetElementCount() <= n );
+
+    if( !same ){
+        Clear();
+        columns.Build( data, bins, BinnedColumns::UNIFORM );
+        source = data.GetFilename();
+        return;
+    }
+
+    // rows appended since the last call
+    std::vector<float> elem( columns.GetDimension() );
+    for(int i = columns.GetElementCount(); i < n; i++){
+        data.GetElement( i, &elem[0] );
+        columns.Append( &elem[0] );
+
+        std::map< std::pair<int,int>, std::vector<SCI::UINT32> >::iterator it;
+        for(it = joints.begin(); it != joints.end(); it++){
+            SCI::UINT8 cx = columns.GetCodes( it->first.first  )[i];
+            SCI::UINT8 cy = columns.GetCodes( it->first.second )[i];
+            it->second[ cx*bins + cy ]++;
+        }
+    }
+}
+
+int PairHistograms::GetBins( ) const { return columns.GetBins(); }
+
+int PairHistograms::GetElementCount( ) const { return columns.GetElementCount(); }
+
+float PairHistograms::GetMinimumValue( int dim ) const { return columns.GetMinimumValue( dim ); }
+
+float PairHistograms::GetMaximumValue( int dim ) const { return columns.GetMaximumValue( dim ); }
+
+void PairHistograms::Compute( const std::vector< std::pair<int,int> > & pairs ){
+    // the map is only changed here, each thread fills its own histogram
+    std::vector< std::pair<int,int> >         todo;
+    std::vector< std::vector<SCI::UINT32> * > out;
+    for(int p = 0; p < (int)pairs.size(); p++){
+        int dx = pairs[p].first;
+        int dy = pairs[p].second;
+        if( dx < 0 || dy < 0 || dx >= columns.GetDimension() || dy >= columns.GetDimension() ) continue;
+        if( joints.find( pairs[p] ) != joints.end() ) continue;
+        todo.push_back( pairs[p] );
+        out.push_back( &joints[ pairs[p] ] );
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int p = 0; p < (int)todo.size(); p++){
+        columns.GetJoint( todo[p].first, todo[p].second, *out[p] );
+    }
+}
+
+const std::vector<SCI::UINT32> * PairHistograms::GetJoint( int dim_x, int dim_y ) const {
+    std::map< std::pair<int,int>, std::vector<SCI::UINT32> >::const_iterator it = joints.find( std::make_pair( dim_x, dim_y ) );
+    if( it == joints.end() ) return 0;
+    return &it->second;
+}
+
+void PairHistograms::Retain( const std::vector< std::pair<int,int> > & pairs ){
+    std::set< std::pair<int,int> > keep( pairs.begin(), pairs.end() );
+    std::map< std::pair<int,int>, std::vector<SCI::UINT32> >::iterator it = joints.begin();
+    while( it != joints.end() ){
+        if( !keep.count( it->first ) )
+            joints.erase( it++ );
+        else
+            ++it;
+    }
+}
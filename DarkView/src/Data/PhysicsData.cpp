@@ -21,11 +21,21 @@
 
 #include <iostream>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include <SCI/VexN.h>
 
 using namespace Data;
 
+// Layout of the payload of a shared dataset segment. The column-major
+// values follow, then per dimension minimum and maximum, then the
+// dimN x dimN correlation matrix.
+struct SharedPhysicsLayout {
+    SCI::INT64 elemN;
+    SCI::INT64 dimN;
+    char       filename[1024];
+};
+
 PhysicsData::PhysicsData( ) : DenseMultiDimensionalData( 0, 0 ) { }
 
 PhysicsData::PhysicsData( const char * fname ) : DenseMultiDimensionalData( 0, 0 ) {
@@ -36,27 +46,23 @@ PhysicsData::~PhysicsData(){}
 
 bool PhysicsData::Load(const char * fname, int b)
 {
+        external = 0;
+        shared.Release();
+        ClearDerived();
         data.clear();
         labels.clear();
+        labels_parsed.clear();
         dim_enabled.clear();
 
         filename = std::string(fname);
 
         int dim = 0;
         std::vector<float> dtmp;
-        char buf[4096];
-        FILE * infile = fopen(fname, "r");
 
         std::cout << "Loading file: " << filename.c_str() << std::endl << std::flush;
 
 
-        if(infile){
-            while( fgets( buf, 4096, infile ) != 0 ){
-                ParseString( buf, dtmp );
-                if( dim == 0 ){ dim = (int)dtmp.size(); }
-            }
-            fclose(infile);
-
+        if( ReadValues( fname, dtmp, dim ) ){
             Resize( (int)dtmp.size()/dim, dim );
 
             for(int i = 0; i < (int)dtmp.size(); i++)
@@ -77,16 +83,201 @@ bool PhysicsData::Load(const char * fname, int b)
 
 
 float PhysicsData::GetCorrelation( int dim_x, int dim_y ){
-    return correlation[ std::make_pair(dim_x,dim_y) ];
+    // a lookup only, the axis ordering thread reads it too
+    std::map< std::pair<int,int>, float >::const_iterator it = correlation.find( std::make_pair(dim_x,dim_y) );
+    return ( it == correlation.end() ) ? 0.0f : it->second;
+}
+
+float PhysicsData::GetMutualInformation( int dim_x, int dim_y ){
+    float ret;
+    #pragma omp critical (physics_dependency)
+    {
+        if( dependency.GetDimension() != dimN ){
+            dependency.Build( *this );
+        }
+        ret = dependency.GetMutualInformation( dim_x, dim_y );
+    }
+    return ret;
+}
+
+float PhysicsData::GetInformationCoefficient( int dim_x, int dim_y ){
+    float ret;
+    #pragma omp critical (physics_dependency)
+    {
+        if( dependency.GetDimension() != dimN ){
+            dependency.Build( *this );
+        }
+        ret = dependency.GetInformationCoefficient( dim_x, dim_y );
+    }
+    return ret;
+}
+
+// Drop everything computed from the values
+void PhysicsData::ClearDerived( bool keep_histogram ){
+    if( !keep_histogram ) histogram.Clear();
+    dependency.Clear();
+    scagnostics.Clear();
+}
+
+// Reached from the ordering thread inside the sections above as well as
+// from the views, the sections are only ever taken in that order
+const ColumnHistogram & PhysicsData::GetHistogram( ){
+    #pragma omp critical (physics_histogram)
+    {
+        if( histogram.GetDimension() != dimN || histogram.GetCount() != elemN ){
+            histogram.Build( *this );
+        }
+    }
+    return histogram;
+}
+
+const Scagnostics & PhysicsData::GetScagnostics( ){
+    #pragma omp critical (physics_scagnostics)
+    {
+        if( scagnostics.GetDimension() != dimN ){
+            scagnostics.Build( *this );
+        }
+    }
+    return scagnostics;
 }
 
 std::string PhysicsData::GetFilename(){
     return filename;
 }
 
+SCI::UINT64 PhysicsData::FileStamp( const char * fname ){
+    struct stat st;
+    if( stat( fname, &st ) != 0 ) return 0;
+    return ( (SCI::UINT64)st.st_mtime * 1000003ULL ) ^ (SCI::UINT64)st.st_size;
+}
+
+std::string PhysicsData::SharedName( const char * fname ){
+    // djb2 hash of the path keeps the name short and free of '/'
+    SCI::UINT64 hash = 5381;
+    for(int i = 0; fname[i] != 0; i++){
+        hash = hash * 33 + (unsigned char)fname[i];
+    }
+    char buf[64];
+    sprintf( buf, "/darkview_%016llx", (unsigned long long)hash );
+    return std::string( buf );
+}
+
+bool PhysicsData::isShared( ) const {
+    return shared.isValid();
+}
+
+void PhysicsData::ReleaseShared( ){
+    if( !shared.isValid() ) return;
+
+    // Keep a private copy if this instance was reading from the segment
+    if( external ){
+        data.assign( external, external + (size_t)elemN * dimN );
+        external = 0;
+    }
+    shared.Release();
+}
+
+bool PhysicsData::PublishShared( const char * segname ){
+    if( shared.isValid() || dimN == 0 || Values() == 0 ) return false;
+
+    size_t valueN = (size_t)elemN * dimN;
+    size_t bytes  = sizeof(SharedPhysicsLayout) + sizeof(float) * ( valueN + 2*dimN + dimN*dimN );
+
+    if( !shared.Create( segname, bytes, FileStamp( filename.c_str() ) ) ){
+        std::cout << "Unable to create shared segment: " << segname << std::endl << std::flush;
+        return false;
+    }
+
+    SharedPhysicsLayout * layout = (SharedPhysicsLayout*)shared.GetWritablePayload();
+    layout->elemN = elemN;
+    layout->dimN  = dimN;
+    strncpy( layout->filename, filename.c_str(), sizeof(layout->filename)-1 );
+    layout->filename[sizeof(layout->filename)-1] = 0;
+
+    float * values = (float*)(layout+1);
+    float * minv   = values + valueN;
+    float * maxv   = minv + dimN;
+    float * corr   = maxv + dimN;
+
+    memcpy( values, Values(), sizeof(float) * valueN );
+    for(int d = 0; d < dimN; d++){
+        minv[d] = GetMinimumValue( d );
+        maxv[d] = GetMaximumValue( d );
+    }
+    for(int i = 0; i < dimN; i++){
+        for(int j = 0; j < dimN; j++){
+            corr[i*dimN+j] = GetCorrelation( i, j );
+        }
+    }
+
+    shared.Publish();
+
+    // Read from the segment from now on so the private copy can go away
+    external = values;
+    std::vector<float>().swap( data );
+
+    std::cout << "Published shared segment: " << segname << std::endl << std::flush;
+    return true;
+}
+
+bool PhysicsData::AttachShared( const char * segname, const char * fname ){
+    ReleaseShared();
+
+    if( !shared.Attach( segname, FileStamp( fname ) ) ) return false;
+
+    const SharedPhysicsLayout * layout = (const SharedPhysicsLayout*)shared.GetPayload();
+    if( strncmp( layout->filename, fname, sizeof(layout->filename) ) != 0 ){
+        shared.Release();
+        return false;
+    }
+
+    std::cout << "Attached shared segment: " << segname << std::endl << std::flush;
+
+    data.clear();
+    labels.clear();
+    labels_parsed.clear();
+    dim_enabled.clear();
+    correlation.clear();
+    ClearDerived();
+
+    filename = std::string( fname );
+
+    size_t valueN = (size_t)layout->elemN * layout->dimN;
+    const float * values = (const float*)(layout+1);
+    const float * minv   = values + valueN;
+    const float * maxv   = minv + layout->dimN;
+    const float * corr   = maxv + layout->dimN;
+
+    // Only the bookkeeping is resized, the values stay in the segment
+    MultiDimensionalData::Resize( (int)layout->elemN, (int)layout->dimN );
+    external = values;
+
+    min_val =  FLT_MAX;
+    max_val = -FLT_MAX;
+    for(int d = 0; d < dimN; d++){
+        min_dval[d] = minv[d];
+        max_dval[d] = maxv[d];
+        min_val = SCI::Min( min_val, minv[d] );
+        max_val = SCI::Max( max_val, maxv[d] );
+    }
+    for(int i = 0; i < dimN; i++){
+        for(int j = 0; j < dimN; j++){
+            correlation[std::make_pair(i,j)] = corr[i*dimN+j];
+        }
+    }
+
+    dim_enabled.resize(dimN,true);
+    LoadMeta();
+
+    return true;
+}
+
+std::string PhysicsData::MetaFilename( ) const {
+    return filename + std::string(".meta");
+}
+
 void PhysicsData::LoadMeta( ){
-    std::string meta_fname = filename;
-    meta_fname.append(std::string(".meta"));
+    std::string meta_fname = MetaFilename();
     FILE * infile = fopen(meta_fname.c_str(), "r");
     char buf[1024];
 
@@ -114,8 +305,7 @@ void PhysicsData::CopyMeta( const PhysicsData & from ){
 
 
 void PhysicsData::SaveMeta( ){
-    std::string meta_fname = filename;
-    meta_fname.append(std::string(".meta"));
+    std::string meta_fname = MetaFilename();
     FILE * outfile = fopen(meta_fname.c_str(), "w");
 
     std::cout << "Saving meta: " << meta_fname.c_str() << std::endl << std::flush;
@@ -130,14 +320,17 @@ void PhysicsData::SaveMeta( ){
 
 
 void PhysicsData::CalculateCorrelation( ){
+    ColumnStatistics stats( GetDim() );
+    stats.AddColumns( Values(), GetElementCount() );
+    SetCorrelation( stats );
+}
+
+void PhysicsData::SetCorrelation( const ColumnStatistics & stats ){
+    correlation.clear();
     for(int i = 0; i < GetDim(); i++){
-        SCI::VexN vi = ExtractDimension( i );
-        correlation[std::make_pair(i,i)] = 1.0f;
         for(int j = 0; j < GetDim(); j++){
-            SCI::VexN vj = ExtractDimension( j );
-            float c = (float)SCI::PearsonCorrelation( vi, vj );
-            correlation[std::make_pair(i,j)] = c;
-            correlation[std::make_pair(j,i)] = c;
+            // constant columns have no correlation, but one with themselves
+            correlation[std::make_pair(i,j)] = ( i == j ) ? 1.0f : (float)stats.GetCorrelation( i, j );
         }
     }
 }
@@ -145,6 +338,10 @@ void PhysicsData::CalculateCorrelation( ){
 void PhysicsData::SetLabel( int _dim, std::string  lbl ){
     if((int)labels.size()<=_dim) labels.resize(_dim+1,std::string("default label"));
     labels[_dim] = lbl;
+
+    // labels are drawn every frame, parse them once here
+    if((int)labels_parsed.size()<=_dim) labels_parsed.resize(_dim+1,std::string("default label"));
+    labels_parsed[_dim] = ParseLabel( lbl );
 }
 
 std::string PhysicsData::GetLabel( int _dim ) const {
@@ -154,7 +351,11 @@ std::string PhysicsData::GetLabel( int _dim ) const {
 
 
 std::string PhysicsData::GetLabelParsed( int _dim ) const {
-    std::string lbl = GetLabel( _dim );
+    if(_dim<(int)labels_parsed.size()) return labels_parsed[_dim];
+    return ParseLabel( GetLabel( _dim ) );
+}
+
+std::string PhysicsData::ParseLabel( std::string lbl ){
     char gamma = (char)(227);
     char sigma = (char)(243);
     char nu    = (char)(237);
@@ -218,6 +419,22 @@ void PhysicsData::ParseString( char * str, std::vector<float> & vals ){
     } while(str);
 }
 
+// Read a whitespace separated file, one row per line, into row-major vals
+bool PhysicsData::ReadValues( const char * fname, std::vector<float> & vals, int & dim ){
+    char buf[4096];
+    FILE * infile = fopen(fname, "r");
+    if( !infile ) return false;
+
+    dim = 0;
+    while( fgets( buf, 4096, infile ) != 0 ){
+        ParseString( buf, vals );
+        if( dim == 0 ){ dim = (int)vals.size(); }
+    }
+    fclose(infile);
+
+    return dim > 0;
+}
+
 // Dimension of each data point
 int PhysicsData::GetDim() const {
     return dimN;
@@ -225,18 +442,18 @@ int PhysicsData::GetDim() const {
 
 // Get the size
 int PhysicsData::GetElementCount() const {
-    return (int)data.size()/dimN;
+    return elemN;
 }
 
 // Get a rough estimate of the size of the data contained in the class
 int PhysicsData::GetDataSize() const {
-    return sizeof(float)*(int)data.size();
+    return sizeof(float)*elemN*dimN;
 }
 
 std::vector<float> PhysicsData::ExtractDimension( int dim ) const {
-    std::vector<float> ret;
-    for(int i = 0; i < GetElementCount(); i++){
-        ret.push_back( GetElement(i, dim) );
-    }
-    return ret;
+    // the values are column-major, a column is one copy
+    const float * col = Values();
+    if( col == 0 || dim < 0 || dim >= GetDim() ) return std::vector<float>();
+    col += (size_t)dim * GetElementCount();
+    return std::vector<float>( col, col + GetElementCount() );
 }
@@ -0,0 +1,220 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/Scagnostics.h>
+#include <Data/BinnedColumns.h>
+#include <Data/PhysicsData.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace Data;
+
+// 8 neighbours of a cell, the opposite of neighbour k is 7-k
+static const int nbr_x[8] = { -1, -1, -1,  0, 0,  1, 1, 1 };
+static const int nbr_y[8] = { -1,  0,  1, -1, 1, -1, 0, 1 };
+
+Scagnostics::Scagnostics( ) : dimN(0) { }
+
+void Scagnostics::Clear( ){
+    dimN = 0;
+    values.clear();
+}
+
+const char * Scagnostics::GetMeasureName( int measure ){
+    switch( measure ){
+        case OUTLYING:  return "Outlying";
+        case SKEWED:    return "Skewed";
+        case CLUMPY:    return "Clumpy";
+        case SPARSE:    return "Sparse";
+        case STRIATED:  return "Striated";
+        case STRINGY:   return "Stringy";
+        case SKINNY:    return "Skinny";
+        case MONOTONIC: return "Monotonic";
+    }
+    return "";
+}
+
+void Scagnostics::Build( PhysicsData & data, int bins ){
+    Clear();
+
+    BinnedColumns binned;
+    binned.Build( data, bins, BinnedColumns::UNIFORM );
+    bins = binned.GetBins();
+
+    dimN = binned.GetDimension();
+    values.assign( MEASURE_COUNT*dimN*dimN, 0.0f );
+
+    std::vector< std::pair<int,int> > pairs;
+    for(int i = 0; i < dimN; i++){
+        for(int j = i+1; j < dimN; j++){
+            pairs.push_back( std::make_pair(i,j) );
+        }
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int p = 0; p < (int)pairs.size(); p++){
+        int i = pairs[p].first;
+        int j = pairs[p].second;
+
+        std::vector<SCI::UINT32> joint;
+        binned.GetJoint( i, j, joint );
+
+        float m[MEASURE_COUNT];
+        MeasurePair( joint, bins, m );
+        for(int k = 0; k < MEASURE_COUNT; k++){
+            values[ (k*dimN+i)*dimN+j ] = values[ (k*dimN+j)*dimN+i ] = m[k];
+        }
+    }
+}
+
+void Scagnostics::MeasurePair( const std::vector<SCI::UINT32> & joint, int bins, float * out ) const {
+    for(int k = 0; k < MEASURE_COUNT; k++){ out[k] = 0; }
+
+    int BB = bins*bins;
+
+    // Occupied neighbours of every occupied cell
+    std::vector<SCI::UINT8> nbrs( BB, 0 );
+    std::vector<int>        occupied;
+    double total = 0;
+    for(int c = 0; c < BB; c++){
+        if( joint[c] == 0 ) continue;
+        occupied.push_back( c );
+        total += joint[c];
+
+        int x = c / bins, y = c % bins;
+        for(int k = 0; k < 8; k++){
+            int nx = x + nbr_x[k], ny = y + nbr_y[k];
+            if( nx < 0 || ny < 0 || nx >= bins || ny >= bins ) continue;
+            if( joint[nx*bins+ny] > 0 ) nbrs[c] |= (SCI::UINT8)(1<<k);
+        }
+    }
+
+    int occN = (int)occupied.size();
+    if( occN == 0 ) return;
+
+    out[SPARSE] = 1.0f - (float)occN / (float)BB;
+
+    // Skew of the densities of the occupied cells
+    std::vector<SCI::UINT32> dens( occN );
+    for(int c = 0; c < occN; c++){ dens[c] = joint[ occupied[c] ]; }
+    std::sort( dens.begin(), dens.end() );
+    double q10 = dens[ (occN-1)*10/100 ];
+    double q50 = dens[ (occN-1)*50/100 ];
+    double q90 = dens[ (occN-1)*90/100 ];
+    if( q90 > q10 ) out[SKEWED] = (float)( (q90-q50) / (q90-q10) );
+
+    // Isolated cells are the outliers, the remaining measures ignore them
+    int    isolated = 0;
+    int    stringy  = 0;
+    int    striated = 0;
+    double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    for(int c = 0; c < occN; c++){
+        int cell = occupied[c];
+        SCI::UINT8 nb = nbrs[cell];
+        int deg = 0;
+        for(int k = 0; k < 8; k++){ if( nb & (1<<k) ) deg++; }
+
+        if( deg == 0 ){ isolated++; continue; }
+        if( deg <= 2 ) stringy++;
+        if( deg == 2 ){
+            for(int k = 0; k < 4; k++){
+                if( (nb & (1<<k)) && (nb & (1<<(7-k))) ) striated++;
+            }
+        }
+
+        double x = cell / bins, y = cell % bins;
+        sx += x; sy += y; sxx += x*x; syy += y*y; sxy += x*y;
+    }
+    out[OUTLYING] = (float)isolated / (float)occN;
+
+    int coreN = occN - isolated;
+    if( coreN > 0 ){
+        out[STRINGY]  = (float)stringy  / (float)coreN;
+        out[STRIATED] = (float)striated / (float)coreN;
+
+        // Elongation from the covariance of the occupied cell positions
+        double cxx = sxx/coreN - (sx/coreN)*(sx/coreN);
+        double cyy = syy/coreN - (sy/coreN)*(sy/coreN);
+        double cxy = sxy/coreN - (sx/coreN)*(sy/coreN);
+        double tr  = cxx + cyy;
+        double dt  = sqrt( std::max( 0.0, (cxx-cyy)*(cxx-cyy)/4.0 + cxy*cxy ) );
+        double l1  = tr/2.0 + dt;
+        double l2  = std::max( 0.0, tr/2.0 - dt );
+        if( l1 > 0 ) out[SKINNY] = (float)( 1.0 - sqrt( l2 / l1 ) );
+
+        // Mass outside the heaviest 8-connected group of cells
+        std::vector<char> seen( BB, 0 );
+        std::vector<int>  stack;
+        double core = 0, largest = 0;
+        for(int c = 0; c < occN; c++){
+            int cell = occupied[c];
+            if( seen[cell] || nbrs[cell] == 0 ) continue;
+
+            double mass = 0;
+            seen[cell] = 1;
+            stack.push_back( cell );
+            while( !stack.empty() ){
+                int cur = stack.back();
+                stack.pop_back();
+                mass += joint[cur];
+                int x = cur / bins, y = cur % bins;
+                for(int k = 0; k < 8; k++){
+                    if( !( nbrs[cur] & (1<<k) ) ) continue;
+                    int nxt = (x+nbr_x[k])*bins + (y+nbr_y[k]);
+                    if( !seen[nxt] ){ seen[nxt] = 1; stack.push_back( nxt ); }
+                }
+            }
+            core   += mass;
+            largest = std::max( largest, mass );
+        }
+        if( core > 0 ) out[CLUMPY] = (float)( 1.0 - largest / core );
+    }
+
+    // Spearman correlation with ties at the mid rank of each bin
+    std::vector<double> px( bins, 0.0 ), py( bins, 0.0 );
+    for(int c = 0; c < occN; c++){
+        px[ occupied[c] / bins ] += joint[ occupied[c] ];
+        py[ occupied[c] % bins ] += joint[ occupied[c] ];
+    }
+    std::vector<double> rx( bins ), ry( bins );
+    double cx = 0, cy = 0;
+    for(int b = 0; b < bins; b++){
+        rx[b] = cx + px[b]/2.0; cx += px[b];
+        ry[b] = cy + py[b]/2.0; cy += py[b];
+    }
+    double mean = total / 2.0;
+    double vx = 0, vy = 0, cv = 0;
+    for(int b = 0; b < bins; b++){
+        vx += px[b] * (rx[b]-mean) * (rx[b]-mean);
+        vy += py[b] * (ry[b]-mean) * (ry[b]-mean);
+    }
+    for(int c = 0; c < occN; c++){
+        int cell = occupied[c];
+        cv += joint[cell] * (rx[cell/bins]-mean) * (ry[cell%bins]-mean);
+    }
+    if( vx > 0 && vy > 0 ) out[MONOTONIC] = (float)( cv*cv / (vx*vy) );
+}
+
+int Scagnostics::GetDimension( ) const { return dimN; }
+
+float Scagnostics::GetMeasure( int dim_x, int dim_y, int measure ) const {
+    if( dim_x < 0 || dim_x >= dimN || dim_y < 0 || dim_y >= dimN ) return 0;
+    if( measure < 0 || measure >= MEASURE_COUNT ) return 0;
+    return values[ (measure*dimN+dim_x)*dimN+dim_y ];
+}
@@ -0,0 +1,292 @@
+/*
+**  Common Data Library
+**  Copyright (C) 2016  Hoa Nguyen, Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <Data/SharedMemory.h>
+
+#include <iostream>
+
+#ifndef WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/file.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <errno.h>
+    #include <time.h>
+#endif
+
+using namespace Data;
+
+static const char   SHARED_MAGIC[8] = { 'D','V','S','H','A','R','E','D' };
+static const int    SHARED_VERSION  = 3;
+
+// A creator has the lock a moment after the name exists; an unlocked
+// segment without a header and older than this was left by a crash
+static const int    SHARED_GRACE    = 10;
+
+SharedSegment::SharedSegment( ) : fd(-1), header(0), mapped_size(0), writable(false) { }
+
+SharedSegment::~SharedSegment( ){
+    Release();
+}
+
+bool SharedSegment::isFileBacked( const char * name ){
+    return name == 0 || name[0] != '/' || strchr( name+1, '/' ) != 0;
+}
+
+bool SharedSegment::isValid( ) const { return header != 0; }
+
+bool SharedSegment::isWritable( ) const { return writable; }
+
+const std::string & SharedSegment::GetName( ) const { return name; }
+
+int SharedSegment::GetReferenceCount( ) const {
+    if( header == 0 ) return 0;
+    return header->refcount;
+}
+
+#ifndef WIN32
+
+// The header gets its own page so the payload can be protected read-only
+static size_t HeaderSize( ){
+    long page = sysconf( _SC_PAGESIZE );
+    if( page < (long)sizeof(SharedHeader) ) page = 4096;
+    return (size_t)page;
+}
+
+static int OpenSegment( const char * name, int flags ){
+    if( SharedSegment::isFileBacked( name ) ){
+        return open( name, flags, 0644 );
+    }
+    return shm_open( name, flags, 0644 );
+}
+
+static void UnlinkSegment( const char * name ){
+    if( SharedSegment::isFileBacked( name ) ){
+        unlink( name );
+    }
+    else{
+        shm_unlink( name );
+    }
+}
+
+// True if name still refers to the segment open as fd
+static bool isSameSegment( const char * name, int fd ){
+    struct stat a, b;
+    int other = OpenSegment( name, O_RDONLY );
+    if( other < 0 ) return false;
+    bool same = fstat( fd, &a ) == 0 && fstat( other, &b ) == 0 && a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+    close( other );
+    return same;
+}
+
+// Processes still mapping a retired segment keep their view of it, and
+// one that opened the name just before sees ready < 0 and lets it go
+static void Retire( SharedHeader * hdr, const char * name ){
+    if( hdr != 0 ){
+        hdr->ready = -1;
+        __sync_synchronize();
+    }
+    UnlinkSegment( name );
+}
+
+// Unlinks the segment name if no process has it mapped and it is not a
+// complete copy of stamp, true if the name is free now. The exclusive
+// lock keeps creators and attachers out while the segment is judged.
+static bool RetireIfStale( const char * name, SCI::UINT64 stamp ){
+    int fd = OpenSegment( name, O_RDWR );
+    if( fd < 0 ){ return errno == ENOENT; }
+
+    struct stat st;
+    if( flock( fd, LOCK_EX | LOCK_NB ) != 0 || fstat( fd, &st ) != 0 ){
+        close( fd );
+        return false;
+    }
+
+    bool stale = false;
+    SharedHeader * hdr = 0;
+    if( (size_t)st.st_size < sizeof(SharedHeader) ){
+        // Only a creator that died before sizing it, or one that has not
+        // taken its lock yet; the second is given time
+        stale = time(0) - st.st_ctime > SHARED_GRACE;
+    }
+    else{
+        void * ptr = mmap( 0, sizeof(SharedHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        if( ptr != MAP_FAILED ){
+            hdr   = (SharedHeader*)ptr;
+            stale = memcmp( hdr->magic, SHARED_MAGIC, sizeof(SHARED_MAGIC) ) != 0
+                    || hdr->version != SHARED_VERSION
+                    || hdr->ready != 1
+                    || hdr->stamp != stamp;
+        }
+    }
+
+    if( stale && isSameSegment( name, fd ) ){
+        std::cout << "Unlinking stale shared segment: " << name << std::endl << std::flush;
+        Retire( hdr, name );
+    }
+    else{
+        stale = false;
+    }
+    if( hdr != 0 ){
+        munmap( hdr, sizeof(SharedHeader) );
+    }
+    close( fd );
+    return stale;
+}
+
+bool SharedSegment::Create( const char * _name, size_t payload, SCI::UINT64 stamp ){
+    Release();
+
+    int _fd = OpenSegment( _name, O_RDWR | O_CREAT | O_EXCL );
+    if( _fd < 0 && errno == EEXIST && RetireIfStale( _name, stamp ) ){
+        _fd = OpenSegment( _name, O_RDWR | O_CREAT | O_EXCL );
+    }
+    if( _fd < 0 ){ return false; }
+
+    // Held from the start, the segment is never judged while being filled
+    if( flock( _fd, LOCK_SH ) != 0 ){
+        UnlinkSegment( _name );
+        close( _fd );
+        return false;
+    }
+
+    size_t total = HeaderSize() + payload;
+    void * ptr   = MAP_FAILED;
+    if( ftruncate( _fd, (off_t)total ) == 0 ){
+        ptr = mmap( 0, total, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0 );
+    }
+    if( ptr == MAP_FAILED ){
+        UnlinkSegment( _name );
+        close( _fd );
+        return false;
+    }
+
+    name        = std::string( _name );
+    fd          = _fd;
+    header      = (SharedHeader*)ptr;
+    mapped_size = total;
+    writable    = true;
+
+    memcpy( header->magic, SHARED_MAGIC, sizeof(SHARED_MAGIC) );
+    header->version  = SHARED_VERSION;
+    header->refcount = 1;
+    header->ready    = 0;
+    header->owner    = (SCI::INT32)getpid();
+    header->payload  = (SCI::UINT64)payload;
+    header->stamp    = stamp;
+
+    return true;
+}
+
+bool SharedSegment::Attach( const char * _name, SCI::UINT64 stamp ){
+    Release();
+
+    int _fd = OpenSegment( _name, O_RDWR );
+    if( _fd < 0 ){ return false; }
+
+    // Waits for a process judging or unlinking the segment, not for others
+    // that have it mapped
+    struct stat st;
+    bool   ok  = flock( _fd, LOCK_SH ) == 0 && fstat( _fd, &st ) == 0 && (size_t)st.st_size >= HeaderSize();
+    size_t total = ok ? (size_t)st.st_size : 0;
+    void * ptr   = ok ? mmap( 0, total, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0 ) : MAP_FAILED;
+
+    SharedHeader * hdr = ( ptr != MAP_FAILED ) ? (SharedHeader*)ptr : 0;
+    ok = hdr != 0
+         && memcmp( hdr->magic, SHARED_MAGIC, sizeof(SHARED_MAGIC) ) == 0
+         && hdr->version == SHARED_VERSION
+         && hdr->ready == 1
+         && hdr->stamp == stamp
+         && HeaderSize() + hdr->payload <= total;
+
+    if( !ok ){
+        // Let go of the lock first, the segment may only be held by us
+        if( hdr != 0 ) munmap( ptr, total );
+        close( _fd );
+        RetireIfStale( _name, stamp );
+        return false;
+    }
+
+    __sync_add_and_fetch( &hdr->refcount, 1 );
+
+    // Only the header stays writable, attached data is read-only
+    mprotect( (char*)ptr + HeaderSize(), total - HeaderSize(), PROT_READ );
+
+    name        = std::string( _name );
+    fd          = _fd;
+    header      = hdr;
+    mapped_size = total;
+    writable    = false;
+
+    return true;
+}
+
+void SharedSegment::Publish( ){
+    if( header == 0 || !writable ) return;
+    __sync_synchronize();
+    header->ready = 1;
+}
+
+void SharedSegment::Release( ){
+    if( header == 0 ) return;
+
+    __sync_sub_and_fetch( &header->refcount, 1 );
+
+    // Last when no other process holds a lock; a failed upgrade may drop
+    // ours, which is let go of anyway
+    if( flock( fd, LOCK_EX | LOCK_NB ) == 0 && header->ready >= 0 && isSameSegment( name.c_str(), fd ) ){
+        std::cout << "Unlinking shared segment: " << name.c_str() << std::endl << std::flush;
+        Retire( header, name.c_str() );
+    }
+    munmap( header, mapped_size );
+    close( fd );
+
+    fd          = -1;
+    header      = 0;
+    mapped_size = 0;
+    writable    = false;
+    name.clear();
+}
+
+void * SharedSegment::GetWritablePayload( ){
+    if( header == 0 || !writable ) return 0;
+    return (char*)header + HeaderSize();
+}
+
+const void * SharedSegment::GetPayload( ) const {
+    if( header == 0 ) return 0;
+    return (const char*)header + HeaderSize();
+}
+
+size_t SharedSegment::GetPayloadSize( ) const {
+    if( header == 0 ) return 0;
+    return (size_t)header->payload;
+}
+
+#else
+
+bool SharedSegment::Create( const char *, size_t, SCI::UINT64 ){ return false; }
+bool SharedSegment::Attach( const char *, SCI::UINT64 ){ return false; }
+void SharedSegment::Publish( ){ }
+void SharedSegment::Release( ){ }
+void * SharedSegment::GetWritablePayload( ){ return 0; }
+const void * SharedSegment::GetPayload( ) const { return 0; }
+size_t SharedSegment::GetPayloadSize( ) const { return 0; }
+
+#endif
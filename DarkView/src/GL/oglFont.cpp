@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <math.h>
 #include <iostream>
 
 #include <QString>
@@ -29,17 +30,21 @@
 
 using namespace oglWidgets;
 
+// Formatted numbers would fill the cache without end, start over past this
+#define OGLFONT_MAX_LAYOUTS 4096
+
 oglFont::oglFont( ) {
     for(int i = 0; i < 256; i++){
         vertN[i] = 0;
         chrW[i]  = 0;
         verts[i] = 0;
     }
+    batching = false;
 }
 
 oglFont::~oglFont( ){
     for(int i = 0; i < 256; i++){
-        if(verts[i]) delete verts[i];
+        if(verts[i]) delete [] verts[i];
     }
 }
 
@@ -54,11 +59,12 @@ bool oglFont::Load( const char * fname ){
     }
 
     for(int i = 0; i < 256; i++){
-        if(verts[i]) delete verts[i];
+        if(verts[i]) delete [] verts[i];
         vertN[i] = 0;
         chrW[i]  = 0;
         verts[i] = 0;
     }
+    layouts.clear();
 
     for(int i = 0; i < 256; i++){
         file.read( (char*)&vertN[i], sizeof(int) *  1 );
@@ -102,20 +108,98 @@ bool oglFont::Load( const char * fname ){
 
 
 void oglFont::Print( char chr ){
-    int idx = chr;
-    if(idx < 0){ idx += 256; }
-
-    glEnableClientState( GL_VERTEX_ARRAY );
-    glVertexPointer( 3, GL_FLOAT, 0, verts[idx] );
-    glDrawArrays( GL_TRIANGLES, 0, vertN[idx] );
-    glTranslatef( chrW[idx], 0, 0 );
-    glDisableClientState( GL_VERTEX_ARRAY );
+    char str[2] = { chr, 0 };
+    Print( str );
 }
 
 void oglFont::Print( const char * chr ){
+    const Layout & layout = GetLayout( chr );
+    int n = (int)layout.verts.size() / 3;
+
+    if( n > 0 ){
+        glEnableClientState( GL_VERTEX_ARRAY );
+        glVertexPointer( 3, GL_FLOAT, 0, &layout.verts[0] );
+        glDrawArrays( GL_TRIANGLES, 0, n );
+        glDisableClientState( GL_VERTEX_ARRAY );
+    }
+    glTranslatef( layout.width, 0, 0 );
+}
+
+void oglFont::Print( const char * chr, float x, float y, float scale_x, float scale_y, float rotation, const float * rgba ){
+    if( !batching ){
+        glPushMatrix();
+            glTranslatef( x, y, 0 );
+            glColor4fv( rgba );
+            glScalef( scale_x, scale_y, 1 );
+            glRotatef( rotation, 0, 0, -1 );
+            Print( chr );
+        glPopMatrix();
+        return;
+    }
+
+    const Layout & layout = GetLayout( chr );
+    int n = (int)layout.verts.size() / 3;
+
+    // the glyphs are flat, only their outline is kept at z = 0
+    float rad = rotation * 3.14159265f / 180.0f;
+    float cs  = cosf( rad );
+    float sn  = sinf( rad );
+    const float * v = n ? &layout.verts[0] : 0;
+    for(int i = 0; i < n; i++, v += 3){
+        batchVerts.push_back( x + scale_x * (  v[0]*cs + v[1]*sn ) );
+        batchVerts.push_back( y + scale_y * ( -v[0]*sn + v[1]*cs ) );
+        batchVerts.push_back( 0 );
+        batchColors.insert( batchColors.end(), rgba, rgba+4 );
+    }
+}
+
+const oglFont::Layout & oglFont::GetLayout( const char * chr ){
+    std::string key( chr );
+    std::map<std::string,Layout>::iterator it = layouts.find( key );
+    if( it != layouts.end() ) return it->second;
+
+    if( layouts.size() >= OGLFONT_MAX_LAYOUTS ) layouts.clear();
+
+    Layout & layout = layouts[key];
+    layout.width = 0;
     for(int i = 0; chr[i] != 0; i++){
-        Print(chr[i]);
+        int idx = chr[i];
+        if(idx < 0){ idx += 256; }
+        for(int j = 0; j < vertN[idx]; j++){
+            layout.verts.push_back( verts[idx][3*j+0] + layout.width );
+            layout.verts.push_back( verts[idx][3*j+1] );
+            layout.verts.push_back( verts[idx][3*j+2] );
+        }
+        layout.width += chrW[idx];
     }
+    return layout;
+}
+
+void oglFont::BeginBatch( ){
+    batching = true;
+}
+
+void oglFont::EndBatch( ){
+    if( !batching ) return;
+    batching = false;
+
+    int n = (int)batchVerts.size() / 3;
+    if( n == 0 ) return;
+
+    glPushAttrib( GL_CURRENT_BIT );
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glEnableClientState( GL_COLOR_ARRAY );
+    glVertexPointer( 3, GL_FLOAT, 0, &batchVerts[0] );
+    glColorPointer( 4, GL_FLOAT, 0, &batchColors[0] );
+    glDrawArrays( GL_TRIANGLES, 0, n );
+    glDisableClientState( GL_COLOR_ARRAY );
+    glDisableClientState( GL_VERTEX_ARRAY );
+
+    glPopAttrib();
+
+    // the arrays keep their capacity for the next frame
+    batchVerts.clear();
+    batchColors.clear();
 }
 
 void oglFont::Printf(const char *fmt, ...)
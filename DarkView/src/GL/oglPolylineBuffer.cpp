@@ -0,0 +1,259 @@
+/*
+**  Common OpenGL Support Library
+**  Copyright (C) 2013  Paul Rosen
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <GL/oglPolylineBuffer.h>
+
+#if !defined(WIN32) && !defined(__APPLE__) && !defined(__ANDROID__)
+    #include <GL/glx.h>
+#endif
+
+#ifndef APIENTRY
+    #define APIENTRY
+#endif
+
+using namespace oglWidgets;
+
+namespace {
+
+    // Buffer object entry points, which Windows and Linux only hand out
+    // at run time. They are looked up once a context is current.
+    struct BufferEntries {
+        typedef void (APIENTRY * GenBuffers)(GLsizei n, GLuint * buffers);
+        typedef void (APIENTRY * DeleteBuffers)(GLsizei n, const GLuint * buffers);
+        typedef void (APIENTRY * BindBuffer)(GLenum target, GLuint buffer);
+        typedef void (APIENTRY * BufferData)(GLenum target, GLsizeiptr size, const void * data, GLenum usage);
+        typedef void (APIENTRY * MultiDrawArrays)(GLenum mode, const GLint * first, const GLsizei * count, GLsizei n);
+
+        bool loaded;
+        GenBuffers      genBuffers;
+        DeleteBuffers   deleteBuffers;
+        BindBuffer      bindBuffer;
+        BufferData      bufferData;
+        MultiDrawArrays multiDrawArrays;
+
+        BufferEntries() : loaded(false), genBuffers(0), deleteBuffers(0), bindBuffer(0), bufferData(0), multiDrawArrays(0) { }
+
+        template <class T> static void Get(T & fn, const char * name){
+            #if defined(WIN32)
+                fn = (T)wglGetProcAddress(name);
+            #elif defined(__APPLE__) || defined(__ANDROID__)
+                (void)name;
+            #else
+                fn = (T)glXGetProcAddressARB((const GLubyte*)name);
+            #endif
+        }
+
+        void Load(){
+            if(loaded) return;
+            loaded = true;
+            #if defined(__APPLE__)
+                genBuffers      = glGenBuffers;
+                deleteBuffers   = glDeleteBuffers;
+                bindBuffer      = glBindBuffer;
+                bufferData      = glBufferData;
+                multiDrawArrays = glMultiDrawArrays;
+            #else
+                Get(genBuffers,      "glGenBuffers");
+                Get(deleteBuffers,   "glDeleteBuffers");
+                Get(bindBuffer,      "glBindBuffer");
+                Get(bufferData,      "glBufferData");
+                Get(multiDrawArrays, "glMultiDrawArrays");
+            #endif
+        }
+
+        bool HasBuffers() const {
+            return genBuffers && deleteBuffers && bindBuffer && bufferData;
+        }
+    };
+
+    BufferEntries gl;
+}
+
+oglPolylineBuffer::oglPolylineBuffer(void){
+    version = 0;
+    vbo[0]  = vbo[1] = 0;
+    Begin();
+}
+
+oglPolylineBuffer::oglPolylineBuffer(const oglPolylineBuffer &){
+    version = 0;
+    vbo[0]  = vbo[1] = 0;
+    Begin();
+}
+
+oglPolylineBuffer & oglPolylineBuffer::operator=(const oglPolylineBuffer &){
+    Release();
+    return *this;
+}
+
+oglPolylineBuffer::~oglPolylineBuffer(void){
+    if(vbo[0] != 0 && gl.HasBuffers()){
+        gl.deleteBuffers(2,vbo);
+    }
+}
+
+void oglPolylineBuffer::Begin(int _components, GLenum _usage){
+    components = (_components == 2) ? 2 : 3;
+    usage      = _usage;
+    uploaded   = false;
+    has_color  = false;
+    vertex.clear();
+    color.clear();
+    first.clear();
+    count.clear();
+    cur_color[0] = cur_color[1] = cur_color[2] = cur_color[3] = 1.0f;
+}
+
+void oglPolylineBuffer::Color(float r, float g, float b, float a){
+    cur_color[0] = r;
+    cur_color[1] = g;
+    cur_color[2] = b;
+    cur_color[3] = a;
+    if(!has_color){
+        // vertices given before the first colour are white
+        has_color = true;
+        color.assign( vertex.size()/components*4, 1.0f );
+    }
+}
+
+void oglPolylineBuffer::Vertex(float x, float y, float z){
+    int total = (int)vertex.size()/components;
+    if(first.size() == count.size()){
+        first.push_back( total );
+    }
+    vertex.push_back(x);
+    vertex.push_back(y);
+    if(components == 3) vertex.push_back(z);
+    if(has_color){
+        color.insert( color.end(), cur_color, cur_color+4 );
+    }
+}
+
+void oglPolylineBuffer::EndLine(){
+    if(first.size() == count.size()) return;
+    count.push_back( (int)vertex.size()/components - first.back() );
+}
+
+void oglPolylineBuffer::End(unsigned int _version){
+    EndLine();
+    version  = _version;
+    uploaded = false;
+}
+
+bool oglPolylineBuffer::IsCurrent(unsigned int _version) const {
+    return version == _version && !first.empty();
+}
+
+bool oglPolylineBuffer::IsEmpty() const {
+    return first.empty();
+}
+
+int oglPolylineBuffer::GetLineCount() const {
+    return (int)count.size();
+}
+
+void oglPolylineBuffer::Upload(){
+    gl.Load();
+    if(!gl.HasBuffers()) return;
+
+    if(!uploaded){
+        if(vbo[0] == 0){
+            gl.genBuffers(2,vbo);
+        }
+        gl.bindBuffer( GL_ARRAY_BUFFER, vbo[0] );
+        gl.bufferData( GL_ARRAY_BUFFER, vertex.size()*sizeof(float), vertex.empty() ? 0 : &vertex[0], usage );
+        gl.bindBuffer( GL_ARRAY_BUFFER, vbo[1] );
+        gl.bufferData( GL_ARRAY_BUFFER, color.size()*sizeof(float), color.empty() ? 0 : &color[0], usage );
+        gl.bindBuffer( GL_ARRAY_BUFFER, 0 );
+        uploaded = true;
+
+        // the GPU copy is all that is drawn from now on
+        if(usage == GL_STATIC_DRAW){
+            std::vector<float>().swap( vertex );
+            std::vector<float>().swap( color );
+        }
+    }
+}
+
+void oglPolylineBuffer::Bind() const {
+    glEnableClientState( GL_VERTEX_ARRAY );
+    if(uploaded){
+        gl.bindBuffer( GL_ARRAY_BUFFER, vbo[0] );
+        glVertexPointer( components, GL_FLOAT, 0, 0 );
+        gl.bindBuffer( GL_ARRAY_BUFFER, 0 );
+    }
+    else{
+        glVertexPointer( components, GL_FLOAT, 0, &vertex[0] );
+    }
+}
+
+void oglPolylineBuffer::Unbind() const {
+    glDisableClientState( GL_COLOR_ARRAY );
+    glDisableClientState( GL_VERTEX_ARRAY );
+}
+
+void oglPolylineBuffer::MultiDraw(GLenum mode, const GLint * f, const GLsizei * c, int n) const {
+    if(n <= 0) return;
+    if(gl.multiDrawArrays){
+        gl.multiDrawArrays( mode, f, c, n );
+        return;
+    }
+    for(int i = 0; i < n; i++){
+        glDrawArrays( mode, f[i], c[i] );
+    }
+}
+
+void oglPolylineBuffer::Draw(GLenum mode, bool use_color){
+    if(first.empty()) return;
+    Upload();
+    Bind();
+    if(use_color && has_color){
+        glEnableClientState( GL_COLOR_ARRAY );
+        if(uploaded){
+            gl.bindBuffer( GL_ARRAY_BUFFER, vbo[1] );
+            glColorPointer( 4, GL_FLOAT, 0, 0 );
+            gl.bindBuffer( GL_ARRAY_BUFFER, 0 );
+        }
+        else{
+            glColorPointer( 4, GL_FLOAT, 0, &color[0] );
+        }
+    }
+    MultiDraw( mode, &first[0], &count[0], (int)count.size() );
+    Unbind();
+}
+
+void oglPolylineBuffer::DrawRange(GLenum mode, int f, int c){
+    if(first.empty()) return;
+    int total = first.back() + count.back();
+    if(f < 0) f = 0;
+    if(c > total - f) c = total - f;
+    if(c <= 0) return;
+    Upload();
+    Bind();
+    glDrawArrays( mode, f, c );
+    Unbind();
+}
+
+void oglPolylineBuffer::Release(){
+    if(vbo[0] != 0 && gl.HasBuffers()){
+        gl.deleteBuffers(2,vbo);
+    }
+    vbo[0] = vbo[1] = 0;
+    Begin( components, usage );
+    version = 0;
+}
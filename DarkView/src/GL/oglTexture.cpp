@@ -34,6 +34,26 @@ oglTexture::~oglTexture(void){
     }
 }
 
+oglTexture::oglTexture(const oglTexture & other){
+    tid = 0xffffffff;
+    target = other.target;
+    minfilter = other.minfilter;
+    magfilter = other.magfilter;
+}
+
+oglTexture & oglTexture::operator=(const oglTexture & other){
+    if(this != &other){
+        if(isTextureValid()){
+            glDeleteTextures(1,&tid);
+        }
+        tid = 0xffffffff;
+        target = other.target;
+        minfilter = other.minfilter;
+        magfilter = other.magfilter;
+    }
+    return *this;
+}
+
 void oglTexture::SetParameter(GLenum param, GLint val){
     if(isTextureValid()){
         Enable();